@@ -57,6 +57,8 @@ namespace app
             BUTTON_PRESSED = 0x10,
 
             BUTTON_DFU_PRESSED = 0x11,
+
+            BUTTON_SWEEP_PRESSED = 0x12,
         };
 
         static void SendEvent(Event_e eventID, uint32_t optDataAddress)
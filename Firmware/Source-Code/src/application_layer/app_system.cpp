@@ -14,8 +14,10 @@
 #include "eda_active_object_priorities.h"
 #include "eda_manager.h"
 #include "svc_ble_subsystem.h"
+#include "svc_pmc_fuel_gauge.h"
 #include "svc_pmc_manager.h"
 #include "svc_wpt_manager.h"
+#include "svc_wpt_session.h"
 #include "svc_pmc_subsystem.h"
 #include "svc_wpt_subsystem.h"
 
@@ -74,7 +76,20 @@ namespace app
         LOG_INFO("WPT Charger NTC Temperature %d C\n", wptManager.mWptNtcTemperature);
 
         svc::PmcManager &pmcManager = svc::PmcManager::Instance();
-        pmcManager.GetBatteryVoltage();
-        LOG_INFO("Battery voltage level %d mV\n", pmcManager.mBatteryVoltage);
+        pmcManager.UpdateFuelGauge();
+        LOG_INFO("Battery voltage level %d mV, SoC %d permille, %d sessions left\n",
+                 pmcManager.mBatteryVoltage,
+                 svc::FuelGauge::Instance().GetSocPermille(),
+                 svc::FuelGauge::Instance().GetRemainingSessions());
+
+        svc::WptSession &wptSession = svc::WptSession::Instance();
+        if (wptSession.IsRunning())
+        {
+            svc::WptSessionReport_t report;
+            wptSession.GetReport(report);
+            LOG_INFO("WPT session %u s, %u mW avg, delivered %u mJ, efficiency %u permille, time to full %u s\n",
+                     report.durationS, report.averagePowerMw, report.deliveredEnergyMj,
+                     report.efficiencyPermille, report.timeToFullS);
+        }
     }
 }
@@ -11,11 +11,16 @@
 
 #include "app_system.h"
 #include "hal_button.h"
+#include "hal_buzzer.h"
 #include "hal_led.h"
 #include "svc_ble_subsystem.h"
 #include "svc_wpt_subsystem.h"
 #include "svc_ble_port.h"
 #include "svc_wpt_port.h"
+#include "svc_wpt_alignment.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
 
 #include <cstdint>
 
@@ -30,12 +35,15 @@ namespace app
         SetBleServiceCallbacks();
         SetWptServiceCallbacks();
         hal::Button::Init();
-        static hal::Button onOffButton(PIN_BUTTON1, &OnOffButtonCallback, nullptr);
-        static hal::Button DfuButton(PIN_BUTTON3, &DfuButtonCallback, nullptr);
+        static hal::Button onOffButton(PIN_BUTTON1, &OnOffButtonCallback, ON_OFF_BUTTON_TIMINGS);
+        static hal::Button DfuButton(PIN_BUTTON3, &DfuButtonCallback, DFU_BUTTON_TIMINGS);
+        static hal::Button sweepButton(PIN_BUTTON2, &SweepButtonCallback, SWEEP_BUTTON_TIMINGS);
 
         hal::Leds::Initialize();
         hal::Leds& leds = hal::Leds::GetInstance();
         leds.TurnLedOff(&leds.rgb_led);
+
+        hal::Buzzer::init();
    }
 
     StatePointers *SystemStateMachine::GetStates()
@@ -49,6 +57,42 @@ namespace app
         return &states;
     }
 
+    uint8_t SystemStateMachine::UpdateAlignmentGuidance(void)
+    {
+        svc::WptManager &wptManager = svc::WptManager::Instance();
+        const svc::AdvertisementData_t advData = svc::BleManager::GetAdvertisementData();
+
+        svc::WptAlignmentSample_t sample = {
+            .rssi = advData.rssi,
+            .vrectDetected = (advData.chargingStatusParameters.GET_VRECT_DET != 0),
+            .pgood = (advData.chargingStatusParameters.GET_VCHG_RAIL_SUPPLY_CIRCUIT_POWER_GOOD != 0),
+            .powerLevel = wptManager.GetPowerLevel(),
+            .maxPowerLevel = wptManager.GetMaxPowerLevel()};
+
+        uint8_t score = svc::WptAlignment::ComputeScore(sample);
+
+        LOG_DEBUG("StateMachine: alignment score %d (RSSI %d dBm, power level %d)", score, sample.rssi, sample.powerLevel);
+        hal::Leds::GetInstance().LedAlignment(true, score);
+
+        return score;
+    }
+
+    bool SystemStateMachine::IsAlignmentGuidanceDone(uint8_t score, uint32_t guidanceStartTicks)
+    {
+        if (score >= ALIGNMENT_ACCEPTED_SCORE)
+        {
+            return true;
+        }
+
+        if ((static_cast<uint32_t>(xTaskGetTickCount()) - guidanceStartTicks) >= pdMS_TO_TICKS(ALIGNMENT_GUIDANCE_TIMEOUT_MS))
+        {
+            LOG_WARNING("StateMachine: alignment score %d after %d ms of guidance, charging anyway", score, ALIGNMENT_GUIDANCE_TIMEOUT_MS);
+            return true;
+        }
+
+        return false;
+    }
+
     void SystemStateMachine::ProcessNewBleData(uint32_t optDataAddress)
     {
         System *pSystem = &System::GetInstance();
@@ -162,18 +206,40 @@ namespace app
 
     // On/Off Button Callback
 
-    void SystemStateMachine::OnOffButtonCallback()
+    void SystemStateMachine::OnOffButtonCallback(hal::ButtonGesture_e gesture)
     {
         System *pSystem = &System::GetInstance();
-        pSystem->mSystemPort.SendEventFromISR(SystemPort::Event_e::BUTTON_PRESSED, NULL);
+
+        switch (gesture)
+        {
+        case hal::ButtonGesture_e::PRESS:
+            pSystem->mSystemPort.SendEvent(SystemPort::Event_e::BUTTON_PRESSED, NULL);
+            break;
+        default:
+            break;
+        }
     }
 
     // Dfu Button Callback
 
-    void SystemStateMachine::DfuButtonCallback()
+    void SystemStateMachine::DfuButtonCallback(hal::ButtonGesture_e gesture)
     {
-        System *pSystem = &System::GetInstance();
-        pSystem->mSystemPort.SendEventFromISR(SystemPort::Event_e::BUTTON_DFU_PRESSED, NULL);
+        if (gesture == hal::ButtonGesture_e::PRESS)
+        {
+            System *pSystem = &System::GetInstance();
+            pSystem->mSystemPort.SendEvent(SystemPort::Event_e::BUTTON_DFU_PRESSED, NULL);
+        }
+    }
+
+    // Sweep Button Callback
+
+    void SystemStateMachine::SweepButtonCallback(hal::ButtonGesture_e gesture)
+    {
+        if (gesture == hal::ButtonGesture_e::PRESS)
+        {
+            System *pSystem = &System::GetInstance();
+            pSystem->mSystemPort.SendEvent(SystemPort::Event_e::BUTTON_SWEEP_PRESSED, NULL);
+        }
     }
 
 }
\ No newline at end of file
@@ -43,7 +43,32 @@ namespace app
         /// Get the pointers to the state machine states.
         StatePointers *GetStates();
 
+        /// Updates the coil alignment guidance from the last IPG advertisement.
+        ///
+        /// Called on each advertisement, from the scanning states while the charger is placed and
+        /// from the charge state.
+        ///
+        /// @return Alignment score of the advertisement
+        static uint8_t UpdateAlignmentGuidance(void);
+
+        /// Checks if the placement guidance at the probe power can end and the charge start.
+        ///
+        /// @param score Alignment score of the last advertisement
+        /// @param guidanceStartTicks Tick count when the guidance started
+        /// @return true once the alignment is accepted, or when the guidance has run for ALIGNMENT_GUIDANCE_TIMEOUT_MS
+        static bool IsAlignmentGuidanceDone(uint8_t score, uint32_t guidanceStartTicks);
+
     private:
+        // The on/off button fires on release whatever the hold time, it has no long or double press
+        static constexpr hal::ButtonTimings_t ON_OFF_BUTTON_TIMINGS = {30, 0, 0};
+        static constexpr hal::ButtonTimings_t DFU_BUTTON_TIMINGS = {30, 0, 0};
+        static constexpr hal::ButtonTimings_t SWEEP_BUTTON_TIMINGS = {30, 0, 0};
+
+        // VRECT_DET and PGOOD at the probe level give 60, the rest needs an RSSI above about -79 dBm
+        static constexpr uint8_t ALIGNMENT_ACCEPTED_SCORE = 70;
+        // The charge starts anyway after this, the link monitor stops it if the coupling is too weak
+        static constexpr uint32_t ALIGNMENT_GUIDANCE_TIMEOUT_MS = 30000;
+
         StateInitialization mInitialState;
         StateCharge mStateCharge;
         StateScan mStateScan;
@@ -86,11 +111,20 @@ namespace app
         /// @param optDataAddress The optional data address
         static void WptScanTimeoutCallback(uint32_t optDataAddress);
 
-        /// Callback for the Button Press event
-        static void OnOffButtonCallback();
+        /// Callback for the on/off button gestures: a press toggles the charge
+        ///
+        /// @param gesture The recognized gesture
+        static void OnOffButtonCallback(hal::ButtonGesture_e gesture);
 
-        /// Callback for the DFU Button Press event
-        static void DfuButtonCallback();
+        /// Callback for the DFU button gestures
+        ///
+        /// @param gesture The recognized gesture
+        static void DfuButtonCallback(hal::ButtonGesture_e gesture);
+
+        /// Callback for the sweep button gestures
+        ///
+        /// @param gesture The recognized gesture
+        static void SweepButtonCallback(hal::ButtonGesture_e gesture);
     };
 }
 
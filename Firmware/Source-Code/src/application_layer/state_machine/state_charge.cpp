@@ -12,6 +12,7 @@
 #include "app_port.h"
 #include "app_state_machine.h"
 #include "eda_manager_log_config.h"
+#include "hal_buzzer.h"
 #include "hal_dfu.h"
 #include "hal_led.h"
 #include "svc_ble_port.h"
@@ -29,6 +30,11 @@ namespace app
     {
         svc::PmcSubSystem& mPmcSubSystem = svc::PmcSubSystem::Instance();
         mPmcSubSystem.mPmcPort.SendEvent(svc::PmcPort::Event_e::PMC_POWER_ON, NULL);
+
+        // The power control still needs frequent IPG data until PGOOD is stable
+        svc::BleSubsystem &mBleSubsystem = svc::BleSubsystem::Instance();
+        mBleSubsystem.mBlePort.SendEvent(svc::BlePort::Event_e::SET_SCAN_PROFILE, static_cast<uint32_t>(svc::ScanProfile_e::MODERATE));
+
         // Call WPT IC Service methods to start charge
         LOG_INFO("Charge State: PMC power on\n");
         hal::Leds::GetInstance().LedCharging(true);
@@ -42,11 +48,15 @@ namespace app
 
         switch (static_cast<SystemPort::Event_e>(eventId))
         {
+        case SystemPort::Event_e::BLE_DEVICE_FOUND:
+            SystemStateMachine::UpdateAlignmentGuidance();
+            break;
         case SystemPort::Event_e::BUTTON_PRESSED:
             stateMachine->ChangeState(states->pStateWait);
             break;
         case SystemPort::Event_e::BATTERY_CHARGED:
             hal::Leds::GetInstance().LedCharged(true);
+            hal::Buzzer::playMelody(hal::MELODY_CHARGED);
             stateMachine->ChangeState(states->pStateWait);
             break;
         case SystemPort::Event_e::TURN_OFF:
@@ -75,5 +85,6 @@ namespace app
         svc::WptSubsystem &mWptSubsystem = svc::WptSubsystem::Instance();
         mWptSubsystem.mWptPort.SendEvent(svc::WptPort::Event_e::WPT_POWER_OFF, NULL);
         hal::Leds::GetInstance().LedCharging(false);
+        hal::Leds::GetInstance().LedAlignment(false, 0);
     }
 } // namespace app
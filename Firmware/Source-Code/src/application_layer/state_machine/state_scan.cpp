@@ -16,6 +16,9 @@
 #include "svc_ble_subsystem.h"
 #include "svc_wpt_subsystem.h"
 
+#include "FreeRTOS.h"
+#include "task.h"
+
 namespace app
 {
     struct StatePointers;
@@ -23,9 +26,11 @@ namespace app
     void StateScan::Entry()
     {
         svc::BleSubsystem &mBleSubsystem = svc::BleSubsystem::Instance();
+        mBleSubsystem.mBlePort.SendEvent(svc::BlePort::Event_e::SET_SCAN_PROFILE, static_cast<uint32_t>(svc::ScanProfile_e::DISCOVERY));
         mBleSubsystem.mBlePort.SendEvent(svc::BlePort::Event_e::START_SCANNING, NULL);
         hal::Leds::GetInstance().LedScanOn(true);
 
+        mIsGuiding = false;
     }
 
     void StateScan::DispatchEvent(uint32_t eventId, uint32_t optDataAddress)
@@ -42,10 +47,32 @@ namespace app
             stateMachine->ChangeState(states->pStateSlowChargeAndScan);
             break;
         case SystemPort::Event_e::BLE_DEVICE_FOUND:
-            mWptManager.StartIpgTemperaturePgoodMonitoringTimer();
+        {
+            if (!mIsGuiding)
+            {
+                // Stay with this implant for the whole session
+                svc::BleSubsystem &mBleSubsystem = svc::BleSubsystem::Instance();
+                mBleSubsystem.mBlePort.SendEvent(svc::BlePort::Event_e::BIND_IMPLANT, NULL);
+
+                // Guidance needs the IPG response to the field, the transmitter runs at its minimum level
+                // without the PGOOD ramp while the charger is placed
+                svc::WptSubsystem &mWptSubsystem = svc::WptSubsystem::Instance();
+                mWptSubsystem.mWptPort.SendEvent(svc::WptPort::Event_e::WPT_SLOW_CHARGE, NULL);
+
+                mIsGuiding = true;
+                mGuidanceStartTicks = static_cast<uint32_t>(xTaskGetTickCount());
+            }
 
-            stateMachine->ChangeState(states->pStateCharge);
+            uint8_t score = SystemStateMachine::UpdateAlignmentGuidance();
+
+            if (SystemStateMachine::IsAlignmentGuidanceDone(score, mGuidanceStartTicks))
+            {
+                mWptManager.StartIpgTemperaturePgoodMonitoringTimer();
+
+                stateMachine->ChangeState(states->pStateCharge);
+            }
             break;
+        }
         case SystemPort::Event_e::BUTTON_DFU_PRESSED:
             if (!hal::Dfu::Instance().is_dfu_active())
             {
@@ -60,5 +87,6 @@ namespace app
         svc::WptSubsystem &mWptSubsystem = svc::WptSubsystem::Instance();
         mWptSubsystem.mWptPort.SendEvent(svc::WptPort::Event_e::WPT_POWER_ON, NULL);
         hal::Leds::GetInstance().LedScanOn(false);
+        hal::Leds::GetInstance().LedAlignment(false, 0);
     }
 }
\ No newline at end of file
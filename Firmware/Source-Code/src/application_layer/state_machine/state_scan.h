@@ -25,6 +25,9 @@ namespace app
 
     private:
         svc::WptManager &mWptManager = svc::WptManager::Instance();
+
+        bool mIsGuiding = false;          // Implant found, the placement is guided at the probe power
+        uint32_t mGuidanceStartTicks = 0;
     };
 
 }
@@ -16,6 +16,9 @@
 #include "svc_ble_subsystem.h"
 #include "svc_wpt_subsystem.h"
 
+#include "FreeRTOS.h"
+#include "task.h"
+
 namespace app
 {
     struct StatePointers;
@@ -23,12 +26,15 @@ namespace app
     void StateSlowChargeAndScan::Entry()
     {
         svc::BleSubsystem &mBleSubsystem = svc::BleSubsystem::Instance();
+        mBleSubsystem.mBlePort.SendEvent(svc::BlePort::Event_e::SET_SCAN_PROFILE, static_cast<uint32_t>(svc::ScanProfile_e::MODERATE));
         mBleSubsystem.mBlePort.SendEvent(svc::BlePort::Event_e::START_SCANNING, NULL);
 
         svc::WptSubsystem &mWptSubsystem = svc::WptSubsystem::Instance();
         mWptSubsystem.mWptPort.SendEvent(svc::WptPort::Event_e::WPT_SLOW_CHARGE, NULL);
 
         hal::Leds::GetInstance().LedChargingSlow(true);
+
+        mIsGuiding = false;
     }
 
     void StateSlowChargeAndScan::DispatchEvent(uint32_t eventId, uint32_t optDataAddress)
@@ -50,8 +56,22 @@ namespace app
         break;
         case SystemPort::Event_e::BLE_DEVICE_FOUND:
         {
-            mWptManager.StartIpgTemperaturePgoodMonitoringTimer();
-            stateMachine->ChangeState(states->pStateCharge);
+            if (!mIsGuiding)
+            {
+                svc::BleSubsystem &mBleSubsystem = svc::BleSubsystem::Instance();
+                mBleSubsystem.mBlePort.SendEvent(svc::BlePort::Event_e::BIND_IMPLANT, NULL);
+
+                mIsGuiding = true;
+                mGuidanceStartTicks = static_cast<uint32_t>(xTaskGetTickCount());
+            }
+
+            uint8_t score = SystemStateMachine::UpdateAlignmentGuidance();
+
+            if (SystemStateMachine::IsAlignmentGuidanceDone(score, mGuidanceStartTicks))
+            {
+                mWptManager.StartIpgTemperaturePgoodMonitoringTimer();
+                stateMachine->ChangeState(states->pStateCharge);
+            }
         }
         break;
         case SystemPort::Event_e::WPT_SCAN_TIMEOUT:
@@ -76,6 +96,7 @@ namespace app
         svc::WptSubsystem &mWptSubsystem = svc::WptSubsystem::Instance();
         mWptSubsystem.mWptPort.SendEvent(svc::WptPort::Event_e::WPT_POWER_OFF, NULL);
         hal::Leds::GetInstance().LedChargingSlow(false);
+        hal::Leds::GetInstance().LedAlignment(false, 0);
 
         // Call WPT IC Service methods to stop slow charge
         // Call BLE methods to stop scanning
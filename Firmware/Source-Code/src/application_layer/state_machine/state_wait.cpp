@@ -13,7 +13,8 @@
 #include "app_state_machine.h"
 #include "hal_dfu.h"
 #include "hal_led.h"
-
+#include "svc_ble_subsystem.h"
+#include "svc_wpt_subsystem.h"
 
 namespace app
 {
@@ -21,7 +22,9 @@ namespace app
 
     void StateWait::Entry()
     {   
-        //Do nothing
+        // Session over, the next scan may pick up any implant
+        svc::BleSubsystem &mBleSubsystem = svc::BleSubsystem::Instance();
+        mBleSubsystem.mBlePort.SendEvent(svc::BlePort::Event_e::UNBIND_IMPLANT, NULL);
     }   
 
     void StateWait::DispatchEvent(uint32_t eventId, uint32_t optDataAddress)
@@ -41,6 +44,13 @@ namespace app
                 hal::Dfu::Instance().start_dfu_mode();
             }
             break;
+        case SystemPort::Event_e::BUTTON_SWEEP_PRESSED:
+        {
+            // Characterization only: the WPT service ignores it unless it is idle
+            svc::WptSubsystem &mWptSubsystem = svc::WptSubsystem::Instance();
+            mWptSubsystem.mWptPort.SendEvent(svc::WptPort::Event_e::WPT_START_SWEEP, 0);
+            break;
+        }
         }
     }
 
@@ -10,7 +10,7 @@
 #ifndef EDA_PORT_H
 #define EDA_PORT_H
 
-#define MAX_EVENT_ENUM_LENGTH 20
+#define MAX_EVENT_ENUM_LENGTH 24
 
 namespace eda
 {
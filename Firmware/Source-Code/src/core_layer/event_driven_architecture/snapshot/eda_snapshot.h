@@ -0,0 +1,129 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file eda_snapshot.h
+ * @brief Snapshot class declaration
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef EDA_SNAPSHOT_H
+#define EDA_SNAPSHOT_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace eda
+{
+    /**
+     * @brief Sequence lock protected value for single writer / multiple reader telemetry
+     *
+     * The writer never waits, readers copy the value and retry if a write happened meanwhile,
+     * so no critical section is needed on either side. The writer may run in an interrupt;
+     * readers must run at a lower priority than the writer, otherwise a reader preempting a
+     * write would spin forever.
+     *
+     * @tparam T Trivially copyable value type
+     */
+    template <typename T>
+    class Snapshot
+    {
+    public:
+        /**
+         * @brief Snapshot constructor, the snapshot is empty until the first Write
+         */
+        Snapshot() : mSequence(0), mValue(), mTimestamp(0)
+        {
+        }
+
+        /**
+         * @brief Function to publish a new value, only one writer is allowed
+         *
+         * @param value Value to publish
+         * @param timestamp Time of the value (tick count)
+         */
+        void Write(const T &value, uint32_t timestamp)
+        {
+            uint32_t sequence = mSequence.load(std::memory_order_relaxed);
+
+            // Odd sequence: write in progress
+            mSequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            mValue = value;
+            mTimestamp = timestamp;
+
+            std::atomic_thread_fence(std::memory_order_release);
+            mSequence.store(sequence + 2, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Function to get a consistent copy of the last value
+         *
+         * @param value Copy of the value
+         * @param timestamp Time of the value given to Write
+         * @param sequence Number of values published so far, the copy is the sequence-th value
+         * @return false if nothing was published yet
+         */
+        bool Read(T &value, uint32_t &timestamp, uint32_t &sequence) const
+        {
+            uint32_t before;
+            uint32_t after;
+
+            do
+            {
+                before = mSequence.load(std::memory_order_acquire);
+
+                value = mValue;
+                timestamp = mTimestamp;
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                after = mSequence.load(std::memory_order_relaxed);
+            } while ((before != after) || ((before & 1U) != 0U));
+
+            sequence = before / 2U;
+
+            return (sequence != 0U);
+        }
+
+        /**
+         * @brief Function to get a consistent copy of the last value
+         *
+         * @param value Copy of the value
+         * @return false if nothing was published yet
+         */
+        bool Read(T &value) const
+        {
+            uint32_t timestamp;
+            uint32_t sequence;
+
+            return Read(value, timestamp, sequence);
+        }
+
+        /**
+         * @brief Function to get the number of values published so far
+         */
+        uint32_t GetSequence(void) const
+        {
+            return mSequence.load(std::memory_order_acquire) / 2U;
+        }
+
+    private:
+        /**
+         * @brief Twice the number of writes, odd while a write is in progress
+         */
+        std::atomic<uint32_t> mSequence;
+
+        /**
+         * @brief Last published value
+         */
+        T mValue;
+
+        /**
+         * @brief Timestamp of the last published value
+         */
+        uint32_t mTimestamp;
+    };
+}
+
+#endif // EDA_SNAPSHOT_H
@@ -38,7 +38,7 @@ namespace eda
     {
         if (mTimerHandle != NULL)
         {
-            xTimerChangePeriod(mTimerHandle, period, 0U);
+            xTimerChangePeriod(mTimerHandle, pdMS_TO_TICKS(period), 0U);
             xTimerStart(mTimerHandle, 0U);
             return TimerErrorCode::SUCCESS;
         }
@@ -73,7 +73,7 @@ namespace eda
     {
         if (mTimerHandle != NULL)
         {
-            xTimerChangePeriodFromISR(mTimerHandle, period, 0U);
+            xTimerChangePeriodFromISR(mTimerHandle, pdMS_TO_TICKS(period), 0U);
             xTimerStartFromISR(mTimerHandle, 0U);
             return TimerErrorCode::SUCCESS;
         }
@@ -90,4 +90,14 @@ namespace eda
             xTimerStopFromISR(mTimerHandle, 0U);
         }
     }
+
+    bool Timer::IsRunning(void)
+    {
+        if (mTimerHandle == NULL)
+        {
+            return false;
+        }
+
+        return (xTimerIsTimerActive(mTimerHandle) != pdFALSE);
+    }
 }
\ No newline at end of file
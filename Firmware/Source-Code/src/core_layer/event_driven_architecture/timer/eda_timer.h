@@ -54,6 +54,8 @@ namespace eda
 
         /**
          * @brief Function to start the timer with a different period
+         *
+         * @param period Timer period in milliseconds
          */
         TimerErrorCode Start(const uint32_t period);
 
@@ -69,6 +71,8 @@ namespace eda
 
         /**
          * @brief Function to start the timer from an ISR with a different period
+         *
+         * @param period Timer period in milliseconds
          */
         TimerErrorCode StartFromISR(const uint32_t period);
 
@@ -77,6 +81,11 @@ namespace eda
          */
         void StopFromISR(void);
 
+        /**
+         * @brief Function to check if the timer is running
+         */
+        bool IsRunning(void);
+
     private:
         /**
          * @brief Timer handle
@@ -14,6 +14,9 @@
 
 #include "nrfx_saadc.h"
 
+#include "FreeRTOS.h"
+#include "task.h"
+
 #include <array>
 #include <numeric>  
 #include <algorithm> 
@@ -25,10 +28,35 @@ namespace hal
     // TODO: We need to discuss how to handle this callback
 }
 
+const Adc::AdcLimitChannel* Adc::s_limit_channels = nullptr;
+uint8_t Adc::s_limit_count = 0;
+Adc::LimitCallback_t Adc::s_limit_callback = nullptr;
+bool Adc::s_limit_monitor_running = false;
+nrf_ppi_channel_t Adc::s_sample_ppi_channel;
+nrf_ppi_channel_t Adc::s_trip_ppi_channels[MAX_LIMIT_CHANNELS * 2];
+nrf_saadc_value_t Adc::s_limit_buffers[2][MAX_LIMIT_CHANNELS * LIMIT_SAMPLES_PER_CHANNEL];
+uint8_t Adc::s_scan_positions[MAX_LIMIT_CHANNELS];
+volatile int16_t Adc::s_scan_averages[MAX_LIMIT_CHANNELS];
+volatile uint32_t Adc::s_scan_buffer_count = 0;
+
 Adc::ErrorCode Adc::take_measurement(AdcChannel* channel, int16_t* value)
 {
     static nrf_saadc_value_t sample = 0;
 
+    // The limit monitor owns the SAADC, its scan buffers already hold the channel
+    const bool is_limit_monitor_running = s_limit_monitor_running;
+    if (is_limit_monitor_running)
+    {
+        const ErrorCode err_code = read_scan_average(channel->pin, value);
+        if (err_code != ErrorCode::INVALID_CONFIG)
+        {
+            return err_code;
+        }
+
+        // Not scanned, the limits are disarmed for the duration of the measurement
+        suspend_limit_monitor();
+    }
+
     static constexpr nrfx_saadc_config_t config = NRFX_SAADC_DEFAULT_CONFIG;
 
     static nrf_saadc_channel_config_t channel_config;
@@ -53,10 +81,237 @@ Adc::ErrorCode Adc::take_measurement(AdcChannel* channel, int16_t* value)
     int16_t average = std::accumulate(samples.begin(), samples.end(), 0) / NUMBER_OF_SAMPLES;
 
     // Convert the ADC count value to millivolts
-    *value = static_cast<int16_t>(static_cast<uint32_t>(average) * 225 >> 6);
+    *value = counts_to_millivolts(average);
 
     nrfx_saadc_uninit();
 
+    if (is_limit_monitor_running)
+    {
+        resume_limit_monitor();
+    }
+
     return ErrorCode::SUCCESS;
 };
+
+Adc::ErrorCode Adc::start_limit_monitor(const AdcLimitChannel* channels,
+                                        uint8_t count,
+                                        uint32_t sample_event_address,
+                                        LimitCallback_t callback)
+{
+    if ((channels == nullptr) || (count == 0) || (count > MAX_LIMIT_CHANNELS) || s_limit_monitor_running)
+    {
+        return ErrorCode::INVALID_CONFIG;
+    }
+
+    ret_code_t err_code = nrf_drv_ppi_init();
+    if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_MODULE_ALREADY_INITIALIZED))
+    {
+        return ErrorCode::FAIL;
+    }
+
+    s_limit_channels = channels;
+    s_limit_count = count;
+    s_limit_callback = callback;
+
+    // Periodic event -> SAADC sample task
+    APP_ERROR_CHECK(nrf_drv_ppi_channel_alloc(&s_sample_ppi_channel));
+    APP_ERROR_CHECK(nrf_drv_ppi_channel_assign(s_sample_ppi_channel,
+                                               sample_event_address,
+                                               nrf_saadc_task_address_get(NRF_SAADC_TASK_SAMPLE)));
+
+    // Limit event -> trip task, so the reaction does not depend on the interrupt latency
+    uint8_t trip_index = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (channels[i].trip_task_address == 0)
+        {
+            continue;
+        }
+
+        const uint8_t saadc_channel = channels[i].pin - 1;
+
+        if (channels[i].low_limit_mV != INT16_MIN)
+        {
+            APP_ERROR_CHECK(nrf_drv_ppi_channel_alloc(&s_trip_ppi_channels[trip_index]));
+            APP_ERROR_CHECK(nrf_drv_ppi_channel_assign(s_trip_ppi_channels[trip_index],
+                                                       nrf_saadc_event_address_get(nrf_saadc_limit_event_get(saadc_channel, NRF_SAADC_LIMIT_LOW)),
+                                                       channels[i].trip_task_address));
+            APP_ERROR_CHECK(nrf_drv_ppi_channel_enable(s_trip_ppi_channels[trip_index]));
+            trip_index++;
+        }
+
+        if (channels[i].high_limit_mV != INT16_MAX)
+        {
+            APP_ERROR_CHECK(nrf_drv_ppi_channel_alloc(&s_trip_ppi_channels[trip_index]));
+            APP_ERROR_CHECK(nrf_drv_ppi_channel_assign(s_trip_ppi_channels[trip_index],
+                                                       nrf_saadc_event_address_get(nrf_saadc_limit_event_get(saadc_channel, NRF_SAADC_LIMIT_HIGH)),
+                                                       channels[i].trip_task_address));
+            APP_ERROR_CHECK(nrf_drv_ppi_channel_enable(s_trip_ppi_channels[trip_index]));
+            trip_index++;
+        }
+    }
+
+    // Mark the unused trip channels so that stop_limit_monitor only frees the allocated ones
+    for (; trip_index < (MAX_LIMIT_CHANNELS * 2); trip_index++)
+    {
+        s_trip_ppi_channels[trip_index] = NRF_PPI_CHANNEL31;
+    }
+
+    return resume_limit_monitor();
+}
+
+void Adc::stop_limit_monitor()
+{
+    if (!s_limit_monitor_running)
+    {
+        return;
+    }
+
+    suspend_limit_monitor();
+
+    nrf_drv_ppi_channel_free(s_sample_ppi_channel);
+
+    for (uint8_t i = 0; i < (MAX_LIMIT_CHANNELS * 2); i++)
+    {
+        if (s_trip_ppi_channels[i] != NRF_PPI_CHANNEL31)
+        {
+            nrf_drv_ppi_channel_disable(s_trip_ppi_channels[i]);
+            nrf_drv_ppi_channel_free(s_trip_ppi_channels[i]);
+        }
+    }
+
+    s_limit_channels = nullptr;
+    s_limit_count = 0;
+}
+
+Adc::ErrorCode Adc::resume_limit_monitor()
+{
+    static constexpr nrfx_saadc_config_t config = NRFX_SAADC_DEFAULT_CONFIG;
+
+    if (nrfx_saadc_init(&config, limit_monitor_handler) != NRFX_SUCCESS)
+    {
+        return ErrorCode::FAIL;
+    }
+
+    for (uint8_t i = 0; i < s_limit_count; i++)
+    {
+        const uint8_t saadc_channel = s_limit_channels[i].pin - 1;
+        nrf_saadc_channel_config_t channel_config = NRF_DRV_SAADC_DEFAULT_CHANNEL_CONFIG_SE(s_limit_channels[i].pin);
+
+        APP_ERROR_CHECK(nrfx_saadc_channel_init(saadc_channel, &channel_config));
+        nrfx_saadc_limits_set(saadc_channel,
+                              millivolts_to_limit(s_limit_channels[i].low_limit_mV, NRFX_SAADC_LIMITL_DISABLED),
+                              millivolts_to_limit(s_limit_channels[i].high_limit_mV, NRFX_SAADC_LIMITH_DISABLED));
+
+        // A scan converts the enabled channels in ascending SAADC channel order
+        s_scan_positions[i] = 0;
+        for (uint8_t j = 0; j < s_limit_count; j++)
+        {
+            if (s_limit_channels[j].pin < s_limit_channels[i].pin)
+            {
+                s_scan_positions[i]++;
+            }
+        }
+    }
+
+    s_scan_buffer_count = 0;
+
+    // Double buffering keeps the SAADC armed while the previous buffer is handed back
+    const uint16_t buffer_size = s_limit_count * LIMIT_SAMPLES_PER_CHANNEL;
+    APP_ERROR_CHECK(nrfx_saadc_buffer_convert(s_limit_buffers[0], buffer_size));
+    APP_ERROR_CHECK(nrfx_saadc_buffer_convert(s_limit_buffers[1], buffer_size));
+
+    s_limit_monitor_running = true;
+    APP_ERROR_CHECK(nrf_drv_ppi_channel_enable(s_sample_ppi_channel));
+
+    return ErrorCode::SUCCESS;
+}
+
+void Adc::suspend_limit_monitor()
+{
+    // Cleared first so that the DONE event raised by the abort does not re-arm the buffers
+    s_limit_monitor_running = false;
+    nrf_drv_ppi_channel_disable(s_sample_ppi_channel);
+    nrfx_saadc_abort();
+    nrfx_saadc_uninit();
+}
+
+void Adc::limit_monitor_handler(nrfx_saadc_evt_t const* p_event)
+{
+    if (p_event->type == NRFX_SAADC_EVT_DONE)
+    {
+        if (s_limit_monitor_running)
+        {
+            const nrf_saadc_value_t* p_buffer = p_event->data.done.p_buffer;
+
+            for (uint8_t i = 0; i < s_limit_count; i++)
+            {
+                int32_t sum = 0;
+                for (uint8_t k = 0; k < LIMIT_SAMPLES_PER_CHANNEL; k++)
+                {
+                    sum += p_buffer[(k * s_limit_count) + s_scan_positions[i]];
+                }
+                s_scan_averages[i] = static_cast<int16_t>(sum / LIMIT_SAMPLES_PER_CHANNEL);
+            }
+            s_scan_buffer_count++;
+
+            nrfx_saadc_buffer_convert(p_event->data.done.p_buffer, p_event->data.done.size);
+        }
+    }
+    else if (p_event->type == NRFX_SAADC_EVT_LIMIT)
+    {
+        const uint8_t saadc_channel = p_event->data.limit.channel;
+
+        // The trip task already ran through PPI, disarm the limits so that a sustained fault
+        // does not flood the CPU with interrupts
+        nrfx_saadc_limits_set(saadc_channel, NRFX_SAADC_LIMITL_DISABLED, NRFX_SAADC_LIMITH_DISABLED);
+
+        if (s_limit_callback)
+        {
+            s_limit_callback(static_cast<nrf_saadc_input_t>(saadc_channel + 1), p_event->data.limit.limit_type);
+        }
+    }
+}
+
+Adc::ErrorCode Adc::read_scan_average(nrf_saadc_input_t pin, int16_t* value)
+{
+    for (uint8_t i = 0; i < s_limit_count; i++)
+    {
+        if (s_limit_channels[i].pin != pin)
+        {
+            continue;
+        }
+
+        // Right after the monitor starts, the first buffer is still being filled
+        for (uint32_t waited_ms = 0; s_scan_buffer_count == 0; waited_ms++)
+        {
+            if (waited_ms >= SCAN_BUFFER_TIMEOUT_MS)
+            {
+                return ErrorCode::FAIL;
+            }
+            vTaskDelay(pdMS_TO_TICKS(1));
+        }
+
+        *value = counts_to_millivolts(s_scan_averages[i]);
+        return ErrorCode::SUCCESS;
+    }
+
+    return ErrorCode::INVALID_CONFIG;
+}
+
+int16_t Adc::counts_to_millivolts(int32_t counts)
+{
+    return static_cast<int16_t>(static_cast<uint32_t>(counts) * 225 >> 6);
+}
+
+int16_t Adc::millivolts_to_limit(int16_t value_mV, int16_t disabled_value)
+{
+    if ((value_mV == INT16_MIN) || (value_mV == INT16_MAX))
+    {
+        return disabled_value;
+    }
+
+    // Inverse of counts_to_millivolts
+    return static_cast<int16_t>((static_cast<int32_t>(value_mV) << 6) / 225);
+}
 }
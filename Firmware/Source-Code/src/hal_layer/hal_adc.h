@@ -11,6 +11,7 @@
 
 #include "hal_timer.h"
 
+#include "nrf_drv_ppi.h"
 #include "nrf_drv_saadc.h"
 #include "nrf_ppi.h"
 #include "nrf_drv_timer.h"
@@ -45,6 +46,18 @@ public:
         nrf_saadc_input_t pin;
     } AdcChannel;
 
+    /// Struct for a channel supervised by the SAADC hardware limits.
+    typedef struct
+    {
+        nrf_saadc_input_t pin;
+        int16_t low_limit_mV;     ///< Conversions below this value trip the channel, INT16_MIN to disable
+        int16_t high_limit_mV;    ///< Conversions above this value trip the channel, INT16_MAX to disable
+        uint32_t trip_task_address; ///< Task triggered through PPI when a limit trips, 0 for none
+    } AdcLimitChannel;
+
+    /// Callback function type for limit events. Called from the SAADC interrupt.
+    using LimitCallback_t = void (*)(nrf_saadc_input_t pin, nrf_saadc_limit_t limit);
+
     /// Get the singleton instance of the ADC class.
     ///
     /// @return Reference to the ADC instance.
@@ -62,7 +75,68 @@ public:
     /// @return An error code indicating the success or failure of the operation.
     static ErrorCode take_measurement(AdcChannel* channel, int16_t* value);
 
+    /// Start supervising a set of channels with the SAADC limit comparators.
+    ///
+    /// The channels are sampled in scan mode each time the sample event fires. Tripping a
+    /// limit triggers the channel task through PPI, without CPU, and then calls the callback.
+    /// While the monitor runs, take_measurement reads the scanned channels from the scan buffers,
+    /// so the limits stay armed. A channel with both limits disabled is only measured.
+    ///
+    /// @param channels Channels to supervise, must remain valid while the monitor runs.
+    /// @param count Number of channels, up to MAX_LIMIT_CHANNELS.
+    /// @param sample_event_address Periodic event that triggers the SAADC sample task.
+    /// @param callback Function called when a limit trips.
+    ///
+    /// @return An error code indicating the success or failure of the operation.
+    static ErrorCode start_limit_monitor(const AdcLimitChannel* channels,
+                                         uint8_t count,
+                                         uint32_t sample_event_address,
+                                         LimitCallback_t callback);
+
+    /// Stop supervising the channels and release the SAADC.
+    static void stop_limit_monitor();
+
+    /// Maximum number of channels scanned by the monitor, supervised or only measured.
+    static constexpr uint8_t MAX_LIMIT_CHANNELS = 3;
+
 private:
+    /// Configure the SAADC in scan mode for the supervised channels.
+    static ErrorCode resume_limit_monitor();
+
+    /// Release the SAADC so that a blocking measurement can be taken.
+    static void suspend_limit_monitor();
+
+    /// SAADC driver handler used while the limit monitor is running.
+    static void limit_monitor_handler(nrfx_saadc_evt_t const* p_event);
+
+    /// Read the average of a scanned channel over the last scan buffer.
+    ///
+    /// @param pin The analog input to read.
+    /// @param value Pointer to the value in millivolts.
+    ///
+    /// @return An error code, INVALID_CONFIG if the channel is not scanned, FAIL if no buffer completes.
+    static ErrorCode read_scan_average(nrf_saadc_input_t pin, int16_t* value);
+
+    /// Convert a SAADC count to millivolts.
+    static int16_t counts_to_millivolts(int32_t counts);
+
+    /// Convert millivolts to a SAADC limit value.
+    static int16_t millivolts_to_limit(int16_t value_mV, int16_t disabled_value);
+
+    static constexpr uint8_t LIMIT_SAMPLES_PER_CHANNEL = 16;
+    static constexpr uint32_t SCAN_BUFFER_TIMEOUT_MS = 100; // Wait for the first buffer after the monitor starts
+
+    static const AdcLimitChannel* s_limit_channels;
+    static uint8_t s_limit_count;
+    static LimitCallback_t s_limit_callback;
+    static bool s_limit_monitor_running;
+    static nrf_ppi_channel_t s_sample_ppi_channel;
+    static nrf_ppi_channel_t s_trip_ppi_channels[MAX_LIMIT_CHANNELS * 2];
+    static nrf_saadc_value_t s_limit_buffers[2][MAX_LIMIT_CHANNELS * LIMIT_SAMPLES_PER_CHANNEL];
+    static uint8_t s_scan_positions[MAX_LIMIT_CHANNELS];   ///< Position of each channel in a scan, in SAADC channel order
+    static volatile int16_t s_scan_averages[MAX_LIMIT_CHANNELS]; ///< Average count of each channel over the last buffer
+    static volatile uint32_t s_scan_buffer_count;           ///< Buffers completed since the monitor was resumed
+
     // Private constructor to enforce singleton pattern
     Adc()
     {}
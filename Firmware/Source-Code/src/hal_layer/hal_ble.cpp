@@ -9,8 +9,13 @@
 
 #include "hal_ble.h"
 #include "hal_ble_parameters.h"
+#include "ble_advdata.h"
+#include "ble_hci.h"
+#include "app_util.h"
 #include "nrf_ble_scan.h"
 
+#include "eda_active_object_priorities.h"
+
 NRF_BLE_SCAN_DEF(mScan);
 
 namespace hal
@@ -19,10 +24,60 @@ namespace hal
 
     ble_gap_scan_params_t Ble::mScanParams;
 
+    uint16_t Ble::mScanWindow = 0;
+
+    bool Ble::mIsScanning = false;
+
+    bool Ble::mIsManufacturerFilterEnabled = false;
+
+    uint16_t Ble::mManufacturerCompanyId = 0;
+
     BleScanEvent_t Ble::mScanEvent;
 
     uint8_t Ble::mNotFoundDataBuffer[BLE_ADV_REPORT_MAX_SIZE] = {0}; // Initialize buffer
 
+    LinkEventHandler_t Ble::mLinkEventHandler = nullptr;
+
+    ble_gap_conn_params_t Ble::mConnParams;
+
+    ble_uuid_t Ble::mLinkServiceUuid;
+
+    ble_uuid_t Ble::mLinkCharacteristicUuid;
+
+    ble_gap_addr_t Ble::mLinkPeerAddress;
+
+    uint16_t Ble::mLinkConnHandle = BLE_CONN_HANDLE_INVALID;
+
+    uint16_t Ble::mLinkServiceEndHandle = BLE_GATT_HANDLE_INVALID;
+
+    uint16_t Ble::mLinkValueHandle = BLE_GATT_HANDLE_INVALID;
+
+    uint16_t Ble::mLinkCccdHandle = BLE_GATT_HANDLE_INVALID;
+
+    bool Ble::mIsConnecting = false;
+
+    PeripheralEventHandler_t Ble::mPeripheralEventHandler = nullptr;
+
+    uint16_t Ble::mPeripheralConnHandle = BLE_CONN_HANDLE_INVALID;
+
+    uint16_t Ble::mPeripheralMtu = BLE_GATT_ATT_MTU_DEFAULT;
+
+    uint8_t Ble::mAdvHandle = BLE_GAP_ADV_SET_HANDLE_NOT_SET;
+
+    uint8_t Ble::mAdvDataBuffer[BLE_GAP_ADV_SET_DATA_SIZE_MAX];
+
+    uint8_t Ble::mScanResponseBuffer[BLE_GAP_ADV_SET_DATA_SIZE_MAX];
+
+    TaskHandle_t Ble::mDispatchTaskHandle = NULL;
+
+    StaticTask_t Ble::mDispatchTaskBuffer;
+
+    StackType_t Ble::mDispatchTaskStack[DISPATCH_TASK_STACK_SIZE];
+
+    volatile uint32_t Ble::mIrqTimestamp = 0;
+
+    BleDispatchStats_t Ble::mDispatchStats = {0};
+
     Ble::Ble()
     {
     }
@@ -31,6 +86,10 @@ namespace hal
     {
         mScanEventHandler = ScanEventHandler;
 
+        // The cycle counter times the event dispatch
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
         BleStackInit();
         GapParametersInit();
         ScanningInit();
@@ -44,11 +103,374 @@ namespace hal
 
         err_code = nrf_ble_scan_start(&mScan);
         APP_ERROR_CHECK(err_code);
+
+        mIsScanning = true;
     }
 
     void Ble::StopScanning(void)
     {
         nrf_ble_scan_stop();
+        mIsScanning = false;
+    }
+
+    void Ble::SetScanTiming(uint16_t interval_ms, uint16_t window_ms)
+    {
+        // The SoftDevice rejects a window longer than the interval
+        if (window_ms > interval_ms)
+        {
+            window_ms = interval_ms;
+        }
+
+        // GAP scan timing is expressed in 0.625 ms units
+        mScanParams.interval = MSEC_TO_UNITS(interval_ms, UNIT_0_625_MS);
+        mScanWindow = MSEC_TO_UNITS(window_ms, UNIT_0_625_MS);
+
+        LOG_INFO("Scan timing: interval %d ms, window %d ms.", interval_ms, window_ms);
+
+        ApplyScanParams();
+    }
+
+    void Ble::SetScanPhys(bool extended, uint8_t phys)
+    {
+        // Legacy scanning only listens on 1M PHY
+        if ((phys & BLE_GAP_PHY_CODED) != 0)
+        {
+            extended = true;
+        }
+
+        mScanParams.extended = extended ? 1 : 0;
+        mScanParams.scan_phys = extended ? phys : BLE_GAP_PHY_1MBPS;
+
+        LOG_INFO("Scan PHYs:%s%s, %s advertisements.",
+                 ((mScanParams.scan_phys & BLE_GAP_PHY_1MBPS) != 0) ? " 1M" : "",
+                 ((mScanParams.scan_phys & BLE_GAP_PHY_CODED) != 0) ? " Coded" : "",
+                 extended ? "extended" : "legacy");
+
+        ApplyScanParams();
+    }
+
+    void Ble::ApplyScanParams(void)
+    {
+        ret_code_t err_code;
+        bool was_scanning = mIsScanning;
+
+        mScanParams.window = mScanWindow;
+
+        // Each primary PHY gets its own window, both have to fit in the interval
+        if (((mScanParams.scan_phys & BLE_GAP_PHY_1MBPS) != 0) && ((mScanParams.scan_phys & BLE_GAP_PHY_CODED) != 0) &&
+            (mScanParams.window > (mScanParams.interval / 2)))
+        {
+            mScanParams.window = mScanParams.interval / 2;
+        }
+
+        err_code = nrf_ble_scan_params_set(&mScan, &mScanParams);
+        APP_ERROR_CHECK(err_code);
+
+        if (was_scanning)
+        {
+            err_code = nrf_ble_scan_start(&mScan);
+            APP_ERROR_CHECK(err_code);
+        }
+    }
+
+    void Ble::SetManufacturerFilter(uint16_t company_id)
+    {
+        // nrf_ble_scan has no manufacturer data filter, the check is done before the report is forwarded
+        mManufacturerCompanyId = company_id;
+        mIsManufacturerFilterEnabled = true;
+    }
+
+    void Ble::SetAcceptList(ble_gap_addr_t const *p_address)
+    {
+        ret_code_t err_code;
+        bool was_scanning = mIsScanning;
+
+        // The accept list cannot be changed while a scan is using it
+        nrf_ble_scan_stop();
+
+        if (p_address != nullptr)
+        {
+            ble_gap_addr_t const *addresses[] = {p_address};
+
+            err_code = sd_ble_gap_whitelist_set(addresses, 1);
+            APP_ERROR_CHECK(err_code);
+
+            mScanParams.filter_policy = BLE_GAP_SCAN_FP_WHITELIST;
+            LOG_INFO("Accept list set to %02x:%02x:%02x:%02x:%02x:%02x.",
+                     p_address->addr[5], p_address->addr[4], p_address->addr[3],
+                     p_address->addr[2], p_address->addr[1], p_address->addr[0]);
+        }
+        else
+        {
+            err_code = sd_ble_gap_whitelist_set(NULL, 0);
+            APP_ERROR_CHECK(err_code);
+
+            mScanParams.filter_policy = BLE_GAP_SCAN_FP_ACCEPT_ALL;
+            LOG_INFO("Accept list cleared.");
+        }
+
+        err_code = nrf_ble_scan_params_set(&mScan, &mScanParams);
+        APP_ERROR_CHECK(err_code);
+
+        if (was_scanning)
+        {
+            err_code = nrf_ble_scan_start(&mScan);
+            APP_ERROR_CHECK(err_code);
+        }
+    }
+
+    void Ble::SetLinkCharacteristic(ble_uuid128_t const *p_uuid_base, uint16_t service_uuid, uint16_t characteristic_uuid,
+                                    LinkEventHandler_t handler)
+    {
+        ret_code_t err_code;
+        uint8_t uuid_type;
+
+        err_code = sd_ble_uuid_vs_add(p_uuid_base, &uuid_type);
+        APP_ERROR_CHECK(err_code);
+
+        mLinkServiceUuid.type = uuid_type;
+        mLinkServiceUuid.uuid = service_uuid;
+
+        mLinkCharacteristicUuid.type = uuid_type;
+        mLinkCharacteristicUuid.uuid = characteristic_uuid;
+
+        mLinkEventHandler = handler;
+    }
+
+    bool Ble::Connect(ble_gap_addr_t const *p_address)
+    {
+        ret_code_t err_code;
+        bool was_scanning = mIsScanning;
+
+        if (IsConnected() || (mLinkEventHandler == nullptr))
+        {
+            return false;
+        }
+
+        // The connection is initiated by scanning for the peer only, and given up after a while
+        ble_gap_scan_params_t conn_scan_params = mScanParams;
+        conn_scan_params.filter_policy = BLE_GAP_SCAN_FP_ACCEPT_ALL;
+        conn_scan_params.timeout = MSEC_TO_UNITS(CONN_ESTABLISH_TIMEOUT_MS, UNIT_10_MS);
+
+        StopScanning();
+
+        mLinkPeerAddress = *p_address;
+
+        err_code = sd_ble_gap_connect(&mLinkPeerAddress, &conn_scan_params, &mConnParams, APP_BLE_CONN_CFG_TAG);
+        if (err_code != NRF_SUCCESS)
+        {
+            LOG_WARNING("Connection not initiated, error %d.", err_code);
+
+            if (was_scanning)
+            {
+                StartScanning();
+            }
+            return false;
+        }
+
+        LOG_INFO("Connecting to %02x:%02x:%02x:%02x:%02x:%02x.",
+                 p_address->addr[5], p_address->addr[4], p_address->addr[3],
+                 p_address->addr[2], p_address->addr[1], p_address->addr[0]);
+
+        mIsConnecting = true;
+
+        return true;
+    }
+
+    void Ble::Disconnect(void)
+    {
+        if (mLinkConnHandle != BLE_CONN_HANDLE_INVALID)
+        {
+            // BLE_GAP_EVT_DISCONNECTED follows
+            (void)sd_ble_gap_disconnect(mLinkConnHandle, BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
+        }
+        else if (mIsConnecting)
+        {
+            (void)sd_ble_gap_connect_cancel();
+            ResetLink();
+            SendLinkEvent(BLE_LINK_EVENT_DISCONNECTED, nullptr, 0);
+        }
+    }
+
+    bool Ble::IsConnected(void)
+    {
+        return mIsConnecting || (mLinkConnHandle != BLE_CONN_HANDLE_INVALID);
+    }
+
+    uint16_t Ble::AddService(ble_uuid128_t const *p_uuid_base, uint16_t service_uuid, uint8_t *p_uuid_type)
+    {
+        ret_code_t err_code;
+        uint16_t service_handle;
+
+        err_code = sd_ble_uuid_vs_add(p_uuid_base, p_uuid_type);
+        APP_ERROR_CHECK(err_code);
+
+        ble_uuid_t const uuid = {
+            .uuid = service_uuid,
+            .type = *p_uuid_type,
+        };
+
+        err_code = sd_ble_gatts_service_add(BLE_GATTS_SRVC_TYPE_PRIMARY, &uuid, &service_handle);
+        APP_ERROR_CHECK(err_code);
+
+        return service_handle;
+    }
+
+    void Ble::AddCharacteristic(uint16_t service_handle, ble_uuid_t const &uuid, BleCharacteristicProperties_t properties,
+                                uint16_t max_len, uint16_t *p_value_handle, uint16_t *p_cccd_handle)
+    {
+        ret_code_t err_code;
+        ble_gatts_char_md_t char_md;
+        ble_gatts_attr_md_t cccd_md;
+        ble_gatts_attr_md_t attr_md;
+        ble_gatts_attr_t attr_char_value;
+        ble_gatts_char_handles_t handles;
+
+        memset(&char_md, 0, sizeof(char_md));
+        memset(&cccd_md, 0, sizeof(cccd_md));
+        memset(&attr_md, 0, sizeof(attr_md));
+        memset(&attr_char_value, 0, sizeof(attr_char_value));
+
+        // The charger data is not sensitive, no pairing is required
+        BLE_GAP_CONN_SEC_MODE_SET_OPEN(&cccd_md.read_perm);
+        BLE_GAP_CONN_SEC_MODE_SET_OPEN(&cccd_md.write_perm);
+        cccd_md.vloc = BLE_GATTS_VLOC_STACK;
+
+        char_md.char_props.read = properties.read;
+        char_md.char_props.write = properties.write;
+        char_md.char_props.notify = properties.notify;
+        char_md.p_cccd_md = properties.notify ? &cccd_md : nullptr;
+
+        if (properties.read)
+        {
+            BLE_GAP_CONN_SEC_MODE_SET_OPEN(&attr_md.read_perm);
+        }
+        else
+        {
+            BLE_GAP_CONN_SEC_MODE_SET_NO_ACCESS(&attr_md.read_perm);
+        }
+
+        if (properties.write)
+        {
+            BLE_GAP_CONN_SEC_MODE_SET_OPEN(&attr_md.write_perm);
+        }
+        else
+        {
+            BLE_GAP_CONN_SEC_MODE_SET_NO_ACCESS(&attr_md.write_perm);
+        }
+
+        attr_md.vloc = BLE_GATTS_VLOC_STACK;
+        attr_md.vlen = 1;
+
+        attr_char_value.p_uuid = &uuid;
+        attr_char_value.p_attr_md = &attr_md;
+        attr_char_value.init_len = 0;
+        attr_char_value.max_len = max_len;
+
+        err_code = sd_ble_gatts_characteristic_add(service_handle, &char_md, &attr_char_value, &handles);
+        APP_ERROR_CHECK(err_code);
+
+        *p_value_handle = handles.value_handle;
+
+        if (p_cccd_handle != nullptr)
+        {
+            *p_cccd_handle = properties.notify ? handles.cccd_handle : BLE_GATT_HANDLE_INVALID;
+        }
+    }
+
+    void Ble::SetValue(uint16_t value_handle, uint8_t const *p_data, uint16_t len)
+    {
+        ble_gatts_value_t value = {
+            .len = len,
+            .offset = 0,
+            .p_value = const_cast<uint8_t *>(p_data),
+        };
+
+        (void)sd_ble_gatts_value_set(BLE_CONN_HANDLE_INVALID, value_handle, &value);
+    }
+
+    bool Ble::Notify(uint16_t value_handle, uint8_t const *p_data, uint16_t len)
+    {
+        if (mPeripheralConnHandle == BLE_CONN_HANDLE_INVALID)
+        {
+            return false;
+        }
+
+        uint16_t hvx_len = len;
+        ble_gatts_hvx_params_t const hvx_params = {
+            .handle = value_handle,
+            .type = BLE_GATT_HVX_NOTIFICATION,
+            .offset = 0,
+            .p_len = &hvx_len,
+            .p_data = p_data,
+        };
+
+        // NRF_ERROR_RESOURCES: the queue is full until the next BLE_GATTS_EVT_HVN_TX_COMPLETE
+        return (sd_ble_gatts_hvx(mPeripheralConnHandle, &hvx_params) == NRF_SUCCESS) && (hvx_len == len);
+    }
+
+    void Ble::StartAdvertising(char const *p_name, ble_uuid_t const &service_uuid, PeripheralEventHandler_t handler)
+    {
+        ret_code_t err_code;
+        ble_gap_conn_sec_mode_t sec_mode;
+
+        mPeripheralEventHandler = handler;
+
+        BLE_GAP_CONN_SEC_MODE_SET_NO_ACCESS(&sec_mode);
+        err_code = sd_ble_gap_device_name_set(&sec_mode, reinterpret_cast<uint8_t const *>(p_name), strlen(p_name));
+        APP_ERROR_CHECK(err_code);
+
+        // The 128-bit UUID and the name do not fit together, the name goes in the scan response
+        ble_uuid_t uuids[] = {service_uuid};
+        ble_advdata_t advdata;
+        ble_advdata_t srdata;
+
+        memset(&advdata, 0, sizeof(advdata));
+        memset(&srdata, 0, sizeof(srdata));
+
+        advdata.flags = BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE;
+        advdata.uuids_complete.uuid_cnt = 1;
+        advdata.uuids_complete.p_uuids = uuids;
+
+        srdata.name_type = BLE_ADVDATA_FULL_NAME;
+
+        ble_gap_adv_data_t adv_data = {
+            .adv_data = {.p_data = mAdvDataBuffer, .len = sizeof(mAdvDataBuffer)},
+            .scan_rsp_data = {.p_data = mScanResponseBuffer, .len = sizeof(mScanResponseBuffer)},
+        };
+
+        err_code = ble_advdata_encode(&advdata, adv_data.adv_data.p_data, &adv_data.adv_data.len);
+        APP_ERROR_CHECK(err_code);
+
+        err_code = ble_advdata_encode(&srdata, adv_data.scan_rsp_data.p_data, &adv_data.scan_rsp_data.len);
+        APP_ERROR_CHECK(err_code);
+
+        ble_gap_adv_params_t adv_params;
+        memset(&adv_params, 0, sizeof(adv_params));
+
+        adv_params.properties.type = BLE_GAP_ADV_TYPE_CONNECTABLE_SCANNABLE_UNDIRECTED;
+        adv_params.filter_policy = BLE_GAP_ADV_FP_ANY;
+        adv_params.interval = MSEC_TO_UNITS(ADV_INTERVAL_MS, UNIT_0_625_MS);
+        adv_params.duration = BLE_GAP_ADV_TIMEOUT_GENERAL_UNLIMITED;
+        adv_params.primary_phy = BLE_GAP_PHY_1MBPS;
+
+        err_code = sd_ble_gap_adv_set_configure(&mAdvHandle, &adv_data, &adv_params);
+        APP_ERROR_CHECK(err_code);
+
+        err_code = sd_ble_gap_adv_start(mAdvHandle, APP_BLE_CONN_CFG_TAG);
+        APP_ERROR_CHECK(err_code);
+
+        LOG_INFO("Advertising as %s.", p_name);
+    }
+
+    uint16_t Ble::GetPeripheralMtu(void)
+    {
+        return mPeripheralMtu;
+    }
+
+    bool Ble::IsPeripheralConnected(void)
+    {
+        return (mPeripheralConnHandle != BLE_CONN_HANDLE_INVALID);
     }
 
     void Ble::BleStackInit()
@@ -67,15 +489,96 @@ namespace hal
 
         // The current implementation does not require a BLE event handler
         NRF_SDH_BLE_OBSERVER(m_ble_observer, APP_BLE_OBSERVER_PRIO, mBleEventHandler, NULL);
+
+        // NRF_SDH_DISPATCH_MODEL_POLLING: the events are pulled by the dispatch task, not in the interrupt
+        mDispatchTaskHandle = xTaskCreateStatic(DispatchTask, "BleEvt", DISPATCH_TASK_STACK_SIZE, NULL,
+                                                static_cast<UBaseType_t>(eda::ActiveObjectPriorities_e::sd_ble_task),
+                                                mDispatchTaskStack, &mDispatchTaskBuffer);
+    }
+
+    void Ble::GetDispatchStats(BleDispatchStats_t &stats)
+    {
+        taskENTER_CRITICAL();
+        stats = mDispatchStats;
+        taskEXIT_CRITICAL();
+    }
+
+    void Ble::ResetDispatchStats(void)
+    {
+        taskENTER_CRITICAL();
+        mDispatchStats = {0};
+        taskEXIT_CRITICAL();
+    }
+
+    void Ble::SoftDeviceEventIrq(void)
+    {
+        uint32_t entry = DWT->CYCCNT;
+        BaseType_t yieldReq = pdFALSE;
+
+        mIrqTimestamp = entry;
+        mDispatchStats.irq_count++;
+
+        // Events raised before the task exists are pulled when it starts
+        if (mDispatchTaskHandle != NULL)
+        {
+            vTaskNotifyGiveFromISR(mDispatchTaskHandle, &yieldReq);
+        }
+
+        uint32_t cycles = DWT->CYCCNT - entry;
+
+        if (cycles > mDispatchStats.isr_cycles_max)
+        {
+            mDispatchStats.isr_cycles_max = cycles;
+        }
+
+        portYIELD_FROM_ISR(yieldReq);
+    }
+
+    void Ble::DispatchTask(void *pvParameter)
+    {
+        for (;;)
+        {
+            uint32_t start = DWT->CYCCNT;
+
+            // Runs every observer: the scan module, this HAL and the handlers of the service layer
+            nrf_sdh_evts_poll();
+
+            uint32_t cycles = DWT->CYCCNT - start;
+
+            if (cycles > mDispatchStats.dispatch_cycles_max)
+            {
+                mDispatchStats.dispatch_cycles_max = cycles;
+            }
+
+            (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+            // Several interrupts before the wake-up count as one, timed from the last
+            uint32_t latency = DWT->CYCCNT - mIrqTimestamp;
+
+            mDispatchStats.latency_cycles_last = latency;
+
+            if (latency > mDispatchStats.latency_cycles_max)
+            {
+                mDispatchStats.latency_cycles_max = latency;
+            }
+        }
     }
 
     void Ble::GapParametersInit(void)
     {
-        mScanParams.interval = SCAN_INTERVAL_MS;
-        mScanParams.window = SCAN_WINDOW_MS;
+        mScanParams.interval = MSEC_TO_UNITS(SCAN_INTERVAL_MS, UNIT_0_625_MS);
+        mScanParams.window = MSEC_TO_UNITS(SCAN_WINDOW_MS, UNIT_0_625_MS);
         mScanParams.timeout = 0;
         mScanParams.active = 0;
         mScanParams.filter_policy = BLE_GAP_SCAN_FP_ACCEPT_ALL;
+        mScanParams.extended = 0;
+        mScanParams.scan_phys = BLE_GAP_PHY_1MBPS;
+        mScanWindow = mScanParams.window;
+
+        mConnParams.min_conn_interval = MSEC_TO_UNITS(CONN_MIN_INTERVAL_MS, UNIT_1_25_MS);
+        mConnParams.max_conn_interval = MSEC_TO_UNITS(CONN_MAX_INTERVAL_MS, UNIT_1_25_MS);
+        mConnParams.slave_latency = CONN_SLAVE_LATENCY;
+        mConnParams.conn_sup_timeout = MSEC_TO_UNITS(CONN_SUPERVISION_TIMEOUT_MS, UNIT_10_MS);
     }
 
     void Ble::ScanningInit()
@@ -94,6 +597,24 @@ namespace hal
 
     void Ble::ScanEventCallback(scan_evt_t const *p_scan_evt)
     {
+        // Drop unrelated advertisers here, in the SoftDevice event context, before any copy or parsing
+        if ((p_scan_evt->scan_evt_id == NRF_BLE_SCAN_EVT_NOT_FOUND) ||
+            (p_scan_evt->scan_evt_id == NRF_BLE_SCAN_EVT_WHITELIST_ADV_REPORT))
+        {
+            // Fragment of an extended advertisement, or one that did not fit the scan buffer. Checked first,
+            // the data of an incomplete report must not be searched for the manufacturer field.
+            if ((p_scan_evt->params.p_not_found != nullptr) &&
+                (p_scan_evt->params.p_not_found->type.status != BLE_GAP_ADV_DATA_STATUS_COMPLETE))
+            {
+                return;
+            }
+
+            if (!IsManufacturerDataMatch(p_scan_evt->params.p_not_found))
+            {
+                return;
+            }
+        }
+
         // Initialize the event structure
         mScanEvent.scan_evt_id = static_cast<BleScanEventType_e>(p_scan_evt->scan_evt_id);
 
@@ -106,20 +627,413 @@ namespace hal
         {
             mScanEvent.p_not_found->data.p_data = p_scan_evt->params.p_not_found->data.p_data;
             mScanEvent.p_not_found->data.len = p_scan_evt->params.p_not_found->data.len;
+            mScanEvent.p_not_found->rssi = p_scan_evt->params.p_not_found->rssi;
+            mScanEvent.p_not_found->peer_addr = p_scan_evt->params.p_not_found->peer_addr;
+            mScanEvent.p_not_found->primary_phy = p_scan_evt->params.p_not_found->primary_phy;
         }
         else
         {
             // Handle the case where no data was found (initialize to safe values)
             mScanEvent.p_not_found->data.p_data = nullptr;
             mScanEvent.p_not_found->data.len = 0;
+            mScanEvent.p_not_found->rssi = 0;
+            memset(&mScanEvent.p_not_found->peer_addr, 0, sizeof(ble_gap_addr_t));
+            mScanEvent.p_not_found->primary_phy = BLE_GAP_PHY_NOT_SET;
         }
 
         mScanEventHandler(&mScanEvent);
     }
 
+    bool Ble::IsManufacturerDataMatch(ble_gap_evt_adv_report_t const *p_adv_report)
+    {
+        if (!mIsManufacturerFilterEnabled)
+        {
+            return true;
+        }
+
+        if (p_adv_report == nullptr)
+        {
+            return false;
+        }
+
+        uint16_t offset = 0;
+        uint16_t length = ble_advdata_search(p_adv_report->data.p_data,
+                                             p_adv_report->data.len,
+                                             &offset,
+                                             BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA);
+
+        // The manufacturer data starts with the little endian company identifier
+        if (length < sizeof(uint16_t))
+        {
+            return false;
+        }
+
+        uint16_t company_id = p_adv_report->data.p_data[offset] | (p_adv_report->data.p_data[offset + 1] << 8);
+
+        return (company_id == mManufacturerCompanyId);
+    }
+
     void Ble::mBleEventHandler(ble_evt_t const *event, void *context)
     {
-        // No implementation required for now
+        CentralEventHandler(event);
+        PeripheralEventHandler(event);
     }
 
-}
\ No newline at end of file
+    void Ble::PeripheralEventHandler(ble_evt_t const *p_ble_evt)
+    {
+        // The connection handle is the first field of the GAP and GATT server events alike
+        uint16_t conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+
+        if (p_ble_evt->header.evt_id == BLE_GAP_EVT_CONNECTED)
+        {
+            if (p_ble_evt->evt.gap_evt.params.connected.role == BLE_GAP_ROLE_PERIPH)
+            {
+                mPeripheralConnHandle = conn_handle;
+                mPeripheralMtu = BLE_GATT_ATT_MTU_DEFAULT;
+                LOG_INFO("Client connected, handle %d.", conn_handle);
+                SendPeripheralEvent(BLE_PERIPHERAL_EVENT_CONNECTED, BLE_GATT_HANDLE_INVALID, nullptr, 0);
+            }
+            return;
+        }
+
+        if ((mPeripheralConnHandle == BLE_CONN_HANDLE_INVALID) || (conn_handle != mPeripheralConnHandle))
+        {
+            return;
+        }
+
+        switch (p_ble_evt->header.evt_id)
+        {
+        case BLE_GAP_EVT_DISCONNECTED:
+            LOG_INFO("Client disconnected, reason 0x%02x.", p_ble_evt->evt.gap_evt.params.disconnected.reason);
+            mPeripheralConnHandle = BLE_CONN_HANDLE_INVALID;
+            mPeripheralMtu = BLE_GATT_ATT_MTU_DEFAULT;
+
+            // The advertising set stops on connection, bring it back for the next client
+            (void)sd_ble_gap_adv_start(mAdvHandle, APP_BLE_CONN_CFG_TAG);
+
+            SendPeripheralEvent(BLE_PERIPHERAL_EVENT_DISCONNECTED, BLE_GATT_HANDLE_INVALID, nullptr, 0);
+            break;
+
+        case BLE_GAP_EVT_SEC_PARAMS_REQUEST:
+            (void)sd_ble_gap_sec_params_reply(conn_handle, BLE_GAP_SEC_STATUS_PAIRING_NOT_SUPP, NULL, NULL);
+            break;
+
+        case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
+        case BLE_GAP_EVT_DATA_LENGTH_UPDATE_REQUEST:
+            LinkUpdateRequestHandler(p_ble_evt);
+            break;
+
+        case BLE_GATTS_EVT_EXCHANGE_MTU_REQUEST:
+        {
+            uint16_t client_mtu = p_ble_evt->evt.gatts_evt.params.exchange_mtu_request.client_rx_mtu;
+
+            (void)sd_ble_gatts_exchange_mtu_reply(conn_handle, NRF_SDH_BLE_GATT_MAX_MTU_SIZE);
+
+            // Both sides use the smaller of the two
+            mPeripheralMtu = (client_mtu < NRF_SDH_BLE_GATT_MAX_MTU_SIZE) ? client_mtu : NRF_SDH_BLE_GATT_MAX_MTU_SIZE;
+            if (mPeripheralMtu < BLE_GATT_ATT_MTU_DEFAULT)
+            {
+                mPeripheralMtu = BLE_GATT_ATT_MTU_DEFAULT;
+            }
+            break;
+        }
+
+        case BLE_GATTS_EVT_SYS_ATTR_MISSING:
+            // No bonding, the CCCDs start cleared on every connection
+            (void)sd_ble_gatts_sys_attr_set(conn_handle, NULL, 0, 0);
+            break;
+
+        case BLE_GATTS_EVT_WRITE:
+            SendPeripheralEvent(BLE_PERIPHERAL_EVENT_WRITE,
+                                p_ble_evt->evt.gatts_evt.params.write.handle,
+                                p_ble_evt->evt.gatts_evt.params.write.data,
+                                p_ble_evt->evt.gatts_evt.params.write.len);
+            break;
+
+        case BLE_GATTS_EVT_HVN_TX_COMPLETE:
+            SendPeripheralEvent(BLE_PERIPHERAL_EVENT_TX_COMPLETE, BLE_GATT_HANDLE_INVALID, nullptr, 0);
+            break;
+
+        case BLE_GATTS_EVT_TIMEOUT:
+            (void)sd_ble_gap_disconnect(conn_handle, BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    void Ble::LinkUpdateRequestHandler(ble_evt_t const *p_ble_evt)
+    {
+        uint16_t conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+
+        if (p_ble_evt->header.evt_id == BLE_GAP_EVT_PHY_UPDATE_REQUEST)
+        {
+            ble_gap_phys_t const phys = {
+                .tx_phys = BLE_GAP_PHY_AUTO,
+                .rx_phys = BLE_GAP_PHY_AUTO,
+            };
+            (void)sd_ble_gap_phy_update(conn_handle, &phys);
+        }
+        else if (p_ble_evt->header.evt_id == BLE_GAP_EVT_DATA_LENGTH_UPDATE_REQUEST)
+        {
+            (void)sd_ble_gap_data_length_update(conn_handle, NULL, NULL);
+        }
+    }
+
+    void Ble::SendPeripheralEvent(BlePeripheralEventType_e event_id, uint16_t handle, uint8_t const *p_data, uint16_t len)
+    {
+        static BlePeripheralEvent_t peripheral_event;
+
+        if (mPeripheralEventHandler == nullptr)
+        {
+            return;
+        }
+
+        peripheral_event.peripheral_evt_id = event_id;
+        peripheral_event.handle = handle;
+        peripheral_event.data.p_data = const_cast<uint8_t *>(p_data);
+        peripheral_event.data.len = len;
+
+        mPeripheralEventHandler(&peripheral_event);
+    }
+
+    void Ble::CentralEventHandler(ble_evt_t const *p_ble_evt)
+    {
+        ret_code_t err_code;
+
+        // The connection handle is the first field of the GAP and GATT client events alike
+        uint16_t conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+
+        // Connection events of other roles are not for the central link
+        if ((p_ble_evt->header.evt_id == BLE_GAP_EVT_CONNECTED) &&
+            (p_ble_evt->evt.gap_evt.params.connected.role != BLE_GAP_ROLE_CENTRAL))
+        {
+            return;
+        }
+
+        if ((p_ble_evt->header.evt_id != BLE_GAP_EVT_CONNECTED) &&
+            (p_ble_evt->header.evt_id != BLE_GAP_EVT_TIMEOUT) &&
+            ((mLinkConnHandle == BLE_CONN_HANDLE_INVALID) || (conn_handle != mLinkConnHandle)))
+        {
+            return;
+        }
+
+        switch (p_ble_evt->header.evt_id)
+        {
+        case BLE_GAP_EVT_CONNECTED:
+            mLinkConnHandle = conn_handle;
+            mIsConnecting = false;
+            LOG_INFO("Connected, handle %d.", conn_handle);
+
+            (void)sd_ble_gap_rssi_start(conn_handle, CONN_RSSI_THRESHOLD_DBM, CONN_RSSI_SKIP_COUNT);
+
+            // The status does not fit the default 20 byte notification, the discovery starts once the MTU is agreed
+            err_code = sd_ble_gattc_exchange_mtu_request(conn_handle, NRF_SDH_BLE_GATT_MAX_MTU_SIZE);
+            if (err_code != NRF_SUCCESS)
+            {
+                (void)sd_ble_gattc_primary_services_discover(conn_handle, 1, &mLinkServiceUuid);
+            }
+
+            SendLinkEvent(BLE_LINK_EVENT_CONNECTED, nullptr, 0);
+            break;
+
+        case BLE_GAP_EVT_TIMEOUT:
+            if ((p_ble_evt->evt.gap_evt.params.timeout.src == BLE_GAP_TIMEOUT_SRC_CONN) && mIsConnecting)
+            {
+                LOG_WARNING("Connection attempt timed out.");
+                ResetLink();
+                SendLinkEvent(BLE_LINK_EVENT_DISCONNECTED, nullptr, 0);
+            }
+            break;
+
+        case BLE_GAP_EVT_DISCONNECTED:
+            LOG_INFO("Disconnected, reason 0x%02x.", p_ble_evt->evt.gap_evt.params.disconnected.reason);
+            ResetLink();
+            SendLinkEvent(BLE_LINK_EVENT_DISCONNECTED, nullptr, 0);
+            break;
+
+        case BLE_GAP_EVT_CONN_PARAM_UPDATE_REQUEST:
+            // Keep the requested parameters, the IPG knows its own power budget
+            (void)sd_ble_gap_conn_param_update(conn_handle, &p_ble_evt->evt.gap_evt.params.conn_param_update_request.conn_params);
+            break;
+
+        case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
+        case BLE_GAP_EVT_DATA_LENGTH_UPDATE_REQUEST:
+            LinkUpdateRequestHandler(p_ble_evt);
+            break;
+
+        case BLE_GATTC_EVT_EXCHANGE_MTU_RSP:
+            (void)sd_ble_gattc_primary_services_discover(conn_handle, 1, &mLinkServiceUuid);
+            break;
+
+        case BLE_GATTC_EVT_PRIM_SRVC_DISC_RSP:
+        {
+            ble_gattc_evt_prim_srvc_disc_rsp_t const *p_rsp = &p_ble_evt->evt.gattc_evt.params.prim_srvc_disc_rsp;
+
+            if ((p_ble_evt->evt.gattc_evt.gatt_status != BLE_GATT_STATUS_SUCCESS) || (p_rsp->count == 0))
+            {
+                LOG_WARNING("Telemetry service not found.");
+                Disconnect();
+                break;
+            }
+
+            mLinkServiceEndHandle = p_rsp->services[0].handle_range.end_handle;
+            (void)sd_ble_gattc_characteristics_discover(conn_handle, &p_rsp->services[0].handle_range);
+            break;
+        }
+
+        case BLE_GATTC_EVT_CHAR_DISC_RSP:
+        {
+            ble_gattc_evt_char_disc_rsp_t const *p_rsp = &p_ble_evt->evt.gattc_evt.params.char_disc_rsp;
+
+            if ((p_ble_evt->evt.gattc_evt.gatt_status != BLE_GATT_STATUS_SUCCESS) || (p_rsp->count == 0))
+            {
+                LOG_WARNING("Telemetry characteristic not found.");
+                Disconnect();
+                break;
+            }
+
+            for (uint16_t i = 0; i < p_rsp->count; i++)
+            {
+                if ((p_rsp->chars[i].uuid.type == mLinkCharacteristicUuid.type) &&
+                    (p_rsp->chars[i].uuid.uuid == mLinkCharacteristicUuid.uuid) &&
+                    p_rsp->chars[i].char_props.notify)
+                {
+                    mLinkValueHandle = p_rsp->chars[i].handle_value;
+                }
+            }
+
+            uint16_t last_handle = p_rsp->chars[p_rsp->count - 1].handle_value;
+
+            if (mLinkValueHandle != BLE_GATT_HANDLE_INVALID)
+            {
+                // The CCCD follows the value, within the service
+                ble_gattc_handle_range_t const range = {
+                    .start_handle = static_cast<uint16_t>(mLinkValueHandle + 1),
+                    .end_handle = mLinkServiceEndHandle,
+                };
+                (void)sd_ble_gattc_descriptors_discover(conn_handle, &range);
+            }
+            else if (last_handle < mLinkServiceEndHandle)
+            {
+                // The response holds a limited number of characteristics, continue after the last one
+                ble_gattc_handle_range_t const range = {
+                    .start_handle = static_cast<uint16_t>(last_handle + 1),
+                    .end_handle = mLinkServiceEndHandle,
+                };
+                (void)sd_ble_gattc_characteristics_discover(conn_handle, &range);
+            }
+            else
+            {
+                LOG_WARNING("Telemetry characteristic not found.");
+                Disconnect();
+            }
+            break;
+        }
+
+        case BLE_GATTC_EVT_DESC_DISC_RSP:
+        {
+            ble_gattc_evt_desc_disc_rsp_t const *p_rsp = &p_ble_evt->evt.gattc_evt.params.desc_disc_rsp;
+
+            for (uint16_t i = 0; (i < p_rsp->count) && (p_ble_evt->evt.gattc_evt.gatt_status == BLE_GATT_STATUS_SUCCESS); i++)
+            {
+                if (p_rsp->descs[i].uuid.uuid == BLE_UUID_DESCRIPTOR_CLIENT_CHAR_CONFIG)
+                {
+                    mLinkCccdHandle = p_rsp->descs[i].handle;
+                    break;
+                }
+            }
+
+            if (mLinkCccdHandle == BLE_GATT_HANDLE_INVALID)
+            {
+                LOG_WARNING("Telemetry characteristic cannot notify.");
+                Disconnect();
+                break;
+            }
+
+            uint8_t const cccd_value[] = {BLE_GATT_HVX_NOTIFICATION, 0};
+            ble_gattc_write_params_t const write_params = {
+                .write_op = BLE_GATT_OP_WRITE_REQ,
+                .flags = 0,
+                .handle = mLinkCccdHandle,
+                .offset = 0,
+                .len = sizeof(cccd_value),
+                .p_value = cccd_value,
+            };
+            (void)sd_ble_gattc_write(conn_handle, &write_params);
+            break;
+        }
+
+        case BLE_GATTC_EVT_WRITE_RSP:
+            if (p_ble_evt->evt.gattc_evt.params.write_rsp.handle == mLinkCccdHandle)
+            {
+                LOG_INFO("Subscribed to the telemetry characteristic.");
+                SendLinkEvent(BLE_LINK_EVENT_SUBSCRIBED, nullptr, 0);
+            }
+            break;
+
+        case BLE_GATTC_EVT_HVX:
+            if (p_ble_evt->evt.gattc_evt.params.hvx.handle == mLinkValueHandle)
+            {
+                SendLinkEvent(BLE_LINK_EVENT_NOTIFICATION,
+                              p_ble_evt->evt.gattc_evt.params.hvx.data,
+                              p_ble_evt->evt.gattc_evt.params.hvx.len);
+            }
+            break;
+
+        case BLE_GATTC_EVT_TIMEOUT:
+            // No GATT procedure is possible after a timeout, only a new connection recovers
+            LOG_WARNING("GATT client timeout.");
+            Disconnect();
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    void Ble::SendLinkEvent(BleLinkEventType_e event_id, uint8_t const *p_data, uint16_t len)
+    {
+        static BleLinkEvent_t link_event;
+
+        if (mLinkEventHandler == nullptr)
+        {
+            return;
+        }
+
+        link_event.link_evt_id = event_id;
+        link_event.data.p_data = const_cast<uint8_t *>(p_data);
+        link_event.data.len = len;
+        link_event.peer_addr = mLinkPeerAddress;
+        link_event.rssi = BLE_RSSI_NOT_AVAILABLE;
+
+        if (mLinkConnHandle != BLE_CONN_HANDLE_INVALID)
+        {
+            int8_t rssi;
+            uint8_t channel;
+
+            if (sd_ble_gap_rssi_get(mLinkConnHandle, &rssi, &channel) == NRF_SUCCESS)
+            {
+                link_event.rssi = rssi;
+            }
+        }
+
+        mLinkEventHandler(&link_event);
+    }
+
+    void Ble::ResetLink(void)
+    {
+        mLinkConnHandle = BLE_CONN_HANDLE_INVALID;
+        mLinkServiceEndHandle = BLE_GATT_HANDLE_INVALID;
+        mLinkValueHandle = BLE_GATT_HANDLE_INVALID;
+        mLinkCccdHandle = BLE_GATT_HANDLE_INVALID;
+        mIsConnecting = false;
+    }
+
+}
+
+extern "C" void SD_EVT_IRQHandler(void)
+{
+    hal::Ble::SoftDeviceEventIrq();
+}
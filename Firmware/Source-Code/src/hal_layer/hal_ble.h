@@ -17,8 +17,13 @@
 #include "nrf_sdh_ble.h"
 #include "app_error.h"
 
+#include "FreeRTOS.h"
+#include "task.h"
+
 #define BLE_ADV_REPORT_MAX_SIZE 32
 
+#define BLE_RSSI_NOT_AVAILABLE 127 // HCI value for an RSSI not measured yet
+
 namespace hal
 {
 
@@ -51,10 +56,13 @@ namespace hal
         uint16_t len;    // Length of the data.
     } BleGapData_t;
 
-    /// Wrapper for ble_gap_evt_adv_report_t (focusing only on the data field)
+    /// Wrapper for ble_gap_evt_adv_report_t (focusing only on the data, RSSI and address fields)
     typedef struct
     {
-        BleGapData_t data; // Received advertising or scan response data.
+        BleGapData_t data;         // Received advertising or scan response data.
+        int8_t rssi;               // Received Signal Strength Indication in dBm.
+        ble_gap_addr_t peer_addr;  // Bluetooth address of the advertiser.
+        uint8_t primary_phy;       // PHY of the primary advertising packet, BLE_GAP_PHY_1MBPS or BLE_GAP_PHY_CODED.
     } BleGapEventAdvReport_t;
 
     /// Wrapper for scan_evt_t
@@ -64,8 +72,63 @@ namespace hal
         BleGapEventAdvReport_t *p_not_found; ///< Advertising report event parameters.
     } BleScanEvent_t;
 
+    /// Enumeration of the events of the link to a GATT server
+    typedef enum
+    {
+        BLE_LINK_EVENT_CONNECTED,    ///< Connection established, discovery in progress.
+        BLE_LINK_EVENT_SUBSCRIBED,   ///< Notifications of the characteristic enabled.
+        BLE_LINK_EVENT_NOTIFICATION, ///< Characteristic value notified.
+        BLE_LINK_EVENT_DISCONNECTED  ///< Link lost, connection attempt failed or cancelled.
+    } BleLinkEventType_e;
+
+    /// Event of the link to a GATT server
+    typedef struct
+    {
+        BleLinkEventType_e link_evt_id;
+        BleGapData_t data;        // Notified value, valid during the handler call only.
+        int8_t rssi;              // Last RSSI of the connection in dBm, BLE_RSSI_NOT_AVAILABLE until measured.
+        ble_gap_addr_t peer_addr; // Bluetooth address of the GATT server.
+    } BleLinkEvent_t;
+
+    /// Enumeration of the events of the link from a GATT client
+    typedef enum
+    {
+        BLE_PERIPHERAL_EVENT_CONNECTED,    ///< A client connected.
+        BLE_PERIPHERAL_EVENT_DISCONNECTED, ///< The client disconnected, advertising restarted.
+        BLE_PERIPHERAL_EVENT_WRITE,        ///< An attribute was written by the client.
+        BLE_PERIPHERAL_EVENT_TX_COMPLETE   ///< Queued notifications were sent, there is room for more.
+    } BlePeripheralEventType_e;
+
+    /// Event of the link from a GATT client
+    typedef struct
+    {
+        BlePeripheralEventType_e peripheral_evt_id;
+        uint16_t handle;   // Handle of the written attribute.
+        BleGapData_t data; // Written value, valid during the handler call only.
+    } BlePeripheralEvent_t;
+
+    /// Properties of a characteristic of the charger GATT server
+    typedef struct
+    {
+        bool read;
+        bool write;
+        bool notify;
+    } BleCharacteristicProperties_t;
+
+    /// Timing of the SoftDevice event dispatch, in CPU cycles (64 per microsecond)
+    typedef struct
+    {
+        uint32_t irq_count;           // SoftDevice event interrupts taken.
+        uint32_t isr_cycles_max;      // Longest time spent in the interrupt.
+        uint32_t latency_cycles_last; // Interrupt to dispatch task start, last wake-up.
+        uint32_t latency_cycles_max;  // Interrupt to dispatch task start, worst wake-up.
+        uint32_t dispatch_cycles_max; // Longest event dispatch, the time the interrupt took before.
+    } BleDispatchStats_t;
+
     using EventHandler_t = void(ble_evt_t const *event, void *context);
     using ScanEventHandler_t = void (*)(BleScanEvent_t *event);
+    using LinkEventHandler_t = void (*)(BleLinkEvent_t *event);
+    using PeripheralEventHandler_t = void (*)(BlePeripheralEvent_t *event);
 
     class Ble
     {
@@ -82,7 +145,120 @@ namespace hal
         /// Stop scanning for BLE devices.
         static void StopScanning(void);
 
+        /// Set the scan interval and window, applied right away if a scan is running.
+        ///
+        /// @param interval_ms Time between the start of two scan windows, in milliseconds
+        /// @param window_ms Time the radio listens in each interval, in milliseconds (limited to the interval)
+        static void SetScanTiming(uint16_t interval_ms, uint16_t window_ms);
+
+        /// Select the advertising PHYs scanned, applied right away if a scan is running.
+        ///
+        /// Extended scanning also receives extended advertisements, up to the scan buffer size.
+        /// With both 1M and Coded PHY, the scan window is limited to half the interval.
+        ///
+        /// @param extended true to scan for extended advertisements, forced when Coded PHY is selected
+        /// @param phys Primary PHYs to scan on, BLE_GAP_PHY_1MBPS and/or BLE_GAP_PHY_CODED
+        static void SetScanPhys(bool extended, uint8_t phys);
+
+        /// Only forward advertisements carrying manufacturer specific data of a company.
+        ///
+        /// @param company_id Bluetooth company identifier to accept
+        static void SetManufacturerFilter(uint16_t company_id);
+
+        /// Restrict the scan to a single advertiser through the SoftDevice accept list.
+        ///
+        /// @param p_address Address to accept, nullptr to accept all advertisers again
+        static void SetAcceptList(ble_gap_addr_t const *p_address);
+
+        /// Select the characteristic subscribed to on each connection.
+        ///
+        /// @param p_uuid_base 128-bit base of the vendor specific UUIDs
+        /// @param service_uuid 16-bit UUID of the service, within the base
+        /// @param characteristic_uuid 16-bit UUID of the notifying characteristic, within the base
+        /// @param handler Callback for the link events, called from the SoftDevice event context
+        static void SetLinkCharacteristic(ble_uuid128_t const *p_uuid_base, uint16_t service_uuid, uint16_t characteristic_uuid,
+                                          LinkEventHandler_t handler);
+
+        /// Connect as a central to a GATT server and subscribe to the characteristic.
+        /// A running scan is stopped, the caller restarts it when the link is lost.
+        /// The scan goes on if the connection cannot be initiated.
+        ///
+        /// @param p_address Address of the GATT server
+        /// @return false if the connection could not be initiated
+        static bool Connect(ble_gap_addr_t const *p_address);
+
+        /// Close the link, or cancel a connection attempt.
+        static void Disconnect(void);
+
+        /// Check if a link is established or being established.
+        static bool IsConnected(void);
+
+        /// Add a primary service to the GATT server.
+        ///
+        /// @param p_uuid_base 128-bit base of the vendor specific UUIDs
+        /// @param service_uuid 16-bit UUID of the service, within the base
+        /// @param p_uuid_type Type of the registered base, for the characteristics of the service
+        /// @return Handle of the service
+        static uint16_t AddService(ble_uuid128_t const *p_uuid_base, uint16_t service_uuid, uint8_t *p_uuid_type);
+
+        /// Add a characteristic to a service of the GATT server, the value is kept by the SoftDevice.
+        ///
+        /// @param service_handle Handle of the service
+        /// @param uuid UUID of the characteristic
+        /// @param properties Operations allowed to the client
+        /// @param max_len Maximum length of the value, the value has a variable length
+        /// @param p_value_handle Handle of the value
+        /// @param p_cccd_handle Handle of the CCCD, BLE_GATT_HANDLE_INVALID without notify
+        static void AddCharacteristic(uint16_t service_handle, ble_uuid_t const &uuid, BleCharacteristicProperties_t properties,
+                                      uint16_t max_len, uint16_t *p_value_handle, uint16_t *p_cccd_handle);
+
+        /// Update the value of a characteristic, without notifying it.
+        ///
+        /// @param value_handle Handle of the value
+        /// @param p_data New value
+        /// @param len Length of the new value
+        static void SetValue(uint16_t value_handle, uint8_t const *p_data, uint16_t len);
+
+        /// Notify a value to the connected client.
+        ///
+        /// @param value_handle Handle of the value
+        /// @param p_data Value to notify, copied by the SoftDevice
+        /// @param len Length of the value, up to GetPeripheralMtu() - 3
+        /// @return false if no client subscribed, or the notification queue is full
+        static bool Notify(uint16_t value_handle, uint8_t const *p_data, uint16_t len);
+
+        /// Start connectable advertising of a service, restarted after each disconnection.
+        ///
+        /// @param p_name Device name, sent in the scan response
+        /// @param service_uuid UUID of the advertised service
+        /// @param handler Callback for the peripheral events, called from the SoftDevice event context
+        static void StartAdvertising(char const *p_name, ble_uuid_t const &service_uuid, PeripheralEventHandler_t handler);
+
+        /// Get the ATT MTU of the link from the client.
+        static uint16_t GetPeripheralMtu(void);
+
+        /// Check if a client is connected.
+        static bool IsPeripheralConnected(void);
+
+        /// Get the timing of the SoftDevice event dispatch since the last reset.
+        ///
+        /// @param stats Copy of the counters.
+        static void GetDispatchStats(BleDispatchStats_t &stats);
+
+        /// Clear the SoftDevice event dispatch timing.
+        static void ResetDispatchStats(void);
+
+        /// Called from SD_EVT_IRQHandler: wake the dispatch task, nothing else is done in the interrupt.
+        static void SoftDeviceEventIrq(void);
+
     private:
+        static constexpr uint16_t DISPATCH_TASK_STACK_SIZE = 512; // Words, the BLE handlers run on it
+
+        /// Pull the SoftDevice events and run the BLE handlers, at the sd_ble_task priority.
+        ///
+        /// @param pvParameter Unused.
+        static void DispatchTask(void *pvParameter);
+
         /// Initialize the BLE stack.
         static void BleStackInit(void);
 
@@ -92,22 +268,114 @@ namespace hal
         /// Initialize the BLE scanning parameters.
         static void ScanningInit(void);
 
+        /// Hand the scan parameters to the scanning module, restarting a running scan.
+        static void ApplyScanParams(void);
+
         /// Callback function for the BLE scanning events.
         ///
         /// @param p_scan_evt The scanning event.
         static void ScanEventCallback(scan_evt_t const *p_scan_evt);
 
+        /// Check that an advertisement carries the manufacturer data selected by SetManufacturerFilter.
+        ///
+        /// @param p_adv_report The advertising report.
+        /// @return true if the report should be forwarded.
+        static bool IsManufacturerDataMatch(ble_gap_evt_adv_report_t const *p_adv_report);
+
+        /// Handle the GAP and GATT client events of the central link.
+        ///
+        /// @param p_ble_evt The BLE event.
+        static void CentralEventHandler(ble_evt_t const *p_ble_evt);
+
+        /// Handle the GAP and GATT server events of the peripheral link.
+        ///
+        /// @param p_ble_evt The BLE event.
+        static void PeripheralEventHandler(ble_evt_t const *p_ble_evt);
+
+        /// Answer the PHY and data length requests of a link.
+        ///
+        /// @param p_ble_evt The BLE event.
+        static void LinkUpdateRequestHandler(ble_evt_t const *p_ble_evt);
+
+        /// Forward a peripheral event to the registered handler.
+        ///
+        /// @param event_id Type of peripheral event.
+        /// @param handle Handle of the written attribute.
+        /// @param p_data Written value, nullptr for the other events.
+        /// @param len Length of the written value.
+        static void SendPeripheralEvent(BlePeripheralEventType_e event_id, uint16_t handle, uint8_t const *p_data, uint16_t len);
+
+        /// Forward a link event to the registered handler.
+        ///
+        /// @param event_id Type of link event.
+        /// @param p_data Notified value, nullptr for the other events.
+        /// @param len Length of the notified value.
+        static void SendLinkEvent(BleLinkEventType_e event_id, uint8_t const *p_data, uint16_t len);
+
+        /// Reset the link state once the connection is closed.
+        static void ResetLink(void);
+
         static EventHandler_t mBleEventHandler;
 
+        static TaskHandle_t mDispatchTaskHandle;
+
+        static StaticTask_t mDispatchTaskBuffer;
+
+        static StackType_t mDispatchTaskStack[DISPATCH_TASK_STACK_SIZE];
+
+        static volatile uint32_t mIrqTimestamp; // Cycle counter at the last interrupt.
+
+        static BleDispatchStats_t mDispatchStats;
+
         static ScanEventHandler_t mScanEventHandler;
 
         static ble_gap_scan_params_t mScanParams;
 
+        static uint16_t mScanWindow; // Requested window in 0.625 ms units, before the dual PHY limit
+
+        static bool mIsScanning;
+
+        static bool mIsManufacturerFilterEnabled;
+
+        static uint16_t mManufacturerCompanyId;
+
         static BleScanEvent_t mScanEvent;
 
         static BleGapEventAdvReport_t mNotFoundData;
 
         static uint8_t mNotFoundDataBuffer[BLE_ADV_REPORT_MAX_SIZE]; // Adjust the size based on the max adv report size
+
+        static LinkEventHandler_t mLinkEventHandler;
+
+        static ble_gap_conn_params_t mConnParams;
+
+        static ble_uuid_t mLinkServiceUuid;
+
+        static ble_uuid_t mLinkCharacteristicUuid;
+
+        static ble_gap_addr_t mLinkPeerAddress;
+
+        static uint16_t mLinkConnHandle;
+
+        static uint16_t mLinkServiceEndHandle;
+
+        static uint16_t mLinkValueHandle;
+
+        static uint16_t mLinkCccdHandle;
+
+        static bool mIsConnecting;
+
+        static PeripheralEventHandler_t mPeripheralEventHandler;
+
+        static uint16_t mPeripheralConnHandle;
+
+        static uint16_t mPeripheralMtu;
+
+        static uint8_t mAdvHandle;
+
+        static uint8_t mAdvDataBuffer[BLE_GAP_ADV_SET_DATA_SIZE_MAX];
+
+        static uint8_t mScanResponseBuffer[BLE_GAP_ADV_SET_DATA_SIZE_MAX];
     };
 } // namespace hal
 
@@ -10,8 +10,23 @@
 #ifndef HAL_BLE_PARAMETERS_H
 #define HAL_BLE_PARAMETERS_H
 
-#define SCAN_INTERVAL_MS 500
-#define SCAN_WINDOW_MS 1000
+// Scan timing used until the service layer selects a profile, continuous scanning
+#define SCAN_INTERVAL_MS 100
+#define SCAN_WINDOW_MS 100
+
+// Connection to the IPG in connected mode, 20 to 100 ms gives 10 to 50 notifications per second
+#define CONN_MIN_INTERVAL_MS 20
+#define CONN_MAX_INTERVAL_MS 100
+#define CONN_SLAVE_LATENCY 0
+#define CONN_SUPERVISION_TIMEOUT_MS 4000
+#define CONN_ESTABLISH_TIMEOUT_MS 2000 // Connection attempt given up when the IPG is not heard for this long
+
+// Connectable advertising of the charger GATT service
+#define ADV_INTERVAL_MS 500
+
+// RSSI reported on a connection once it changes by this much, after this many samples
+#define CONN_RSSI_THRESHOLD_DBM 2
+#define CONN_RSSI_SKIP_COUNT 3
 
 #define APP_BLE_OBSERVER_PRIO 3
 #define APP_BLE_CONN_CFG_TAG 1
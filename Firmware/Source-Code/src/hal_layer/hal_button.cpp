@@ -14,16 +14,22 @@
 #include "nrf_gpio.h"
 #include "app_error.h"
 
+#include "FreeRTOS.h"
+#include "task.h"
+
 namespace hal
 {
     Button *Button::s_button_instances[MAX_BUTTONS] = {nullptr};
     uint8_t Button::s_button_count = 0;
 
-    Button::Button(uint32_t button_pin, ToggleCallbackFunction_t *callback_is_pressed,
-                   ToggleCallbackFunction_t *callback_is_released)
+    // FreeRTOS timers run from the RTC tick, the recognizer costs nothing while the buttons are idle
+    eda::Timer Button::s_timer("ButtonTimer", FILTER_PERIOD_MS, 0, TimerCallback);
+    volatile bool Button::s_is_timer_armed = false;
+
+    Button::Button(uint32_t button_pin, GestureCallbackFunction_t *callback_gesture,
+                   const ButtonTimings_t &timings)
         : m_button_pin(button_pin),
-          m_callback_is_pressed(callback_is_pressed),
-          m_callback_is_released(callback_is_released)
+          m_recognizer(button_pin, callback_gesture, timings, configTICK_RATE_HZ)
     {
         if (s_button_count < MAX_BUTTONS)
         {
@@ -31,12 +37,15 @@ namespace hal
             nrfx_gpiote_in_config_t pin_in_config = NRFX_GPIOTE_CONFIG_IN_SENSE_TOGGLE(true);
             pin_in_config.pull = NRF_GPIO_PIN_PULLUP;
 
-            nrf_gpiote_polarity_t polarity = NRF_GPIOTE_POLARITY_TOGGLE;
             err_code = nrf_drv_gpiote_in_init(button_pin, &pin_in_config, ButtonHandler);
             APP_ERROR_CHECK(err_code);
-            nrf_drv_gpiote_in_event_enable(button_pin, true);
+
+            // A button held at start up gives no gesture until it is released
+            m_recognizer.Reset(Read(button_pin));
 
             s_button_instances[s_button_count++] = this;
+
+            nrf_drv_gpiote_in_event_enable(button_pin, true);
         }
         else
         {
@@ -61,26 +70,54 @@ namespace hal
         {
             if (s_button_instances[i] && s_button_instances[i]->m_button_pin == pin_num)
             {
-                bool is_pressed = !nrf_drv_gpiote_in_is_set(pin_num);
+                s_button_instances[i]->m_recognizer.OnEdge(static_cast<uint32_t>(xTaskGetTickCountFromISR()));
 
-                if (is_pressed)
-                {
-                    if (s_button_instances[i]->m_callback_is_pressed)
-                    {
-                        s_button_instances[i]->m_callback_is_pressed();
-                    }
-                    LOG_INFO("Button %u pressed\n", pin_num);
-                }
-                else
+                if (!s_is_timer_armed)
                 {
-                    if (s_button_instances[i]->m_callback_is_released)
-                    {
-                        s_button_instances[i]->m_callback_is_released();
-                    }
-                    LOG_INFO("Button %u released\n", pin_num);
+                    s_is_timer_armed = true;
+                    s_timer.StartFromISR();
                 }
                 break;
             }
         }
     }
-}
\ No newline at end of file
+
+    void Button::TimerCallback(TimerHandle_t xTimer)
+    {
+        const uint32_t now_ticks = static_cast<uint32_t>(xTaskGetTickCount());
+        bool is_active = false;
+
+        for (uint8_t i = 0; i < s_button_count; i++)
+        {
+            is_active |= s_button_instances[i]->Process(now_ticks);
+        }
+
+        // Disarm only if no edge came in meanwhile, the next edge then starts the timer again
+        taskENTER_CRITICAL();
+        for (uint8_t i = 0; i < s_button_count; i++)
+        {
+            is_active |= s_button_instances[i]->m_recognizer.IsEdgePending();
+        }
+
+        if (!is_active)
+        {
+            s_is_timer_armed = false;
+        }
+        taskEXIT_CRITICAL();
+
+        if (is_active)
+        {
+            s_timer.Start();
+        }
+    }
+
+    bool Button::Process(uint32_t now_ticks)
+    {
+        // The pending edge is shared with the interrupt
+        taskENTER_CRITICAL();
+        const ButtonGestureRecognizer::Debounce_e debounce = m_recognizer.Debounce(now_ticks);
+        taskEXIT_CRITICAL();
+
+        return m_recognizer.Process(now_ticks, debounce, Read(m_button_pin));
+    }
+}
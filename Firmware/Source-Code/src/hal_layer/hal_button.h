@@ -10,8 +10,11 @@
 #ifndef HAL_BUTTON_H
 #define HAL_BUTTON_H
 
+#include "hal_button_gesture.h"
 #include "hal_gpio.h"
 
+#include "eda_timer.h"
+
 #include "nrf_drv_gpiote.h"
 #include "nrf_gpio.h"
 #include "nrf_gpiote.h"
@@ -20,17 +23,20 @@
 
 namespace hal
 {
-    using ToggleCallbackFunction_t = void();
     class Button
     {
     public:
-        /// Set a callback function for a button pin event
+        static constexpr uint32_t FILTER_PERIOD_MS = 10; // Evaluation period while a gesture is in progress
+
+        static constexpr ButtonTimings_t DEFAULT_TIMINGS = {30, 1500, 300};
+
+        /// Set a gesture callback function for a button pin
         ///
         ///@param button_pin The GPIO pin number of the button
-        ///@param callback_function The function to be called when the button pin event occurs
-        ///@param callback_function The function to be called when the button pin event occurs
-        Button(uint32_t button_pin, ToggleCallbackFunction_t *callback_is_pressed = nullptr,
-               ToggleCallbackFunction_t *callback_is_released = nullptr);
+        ///@param callback_gesture The function to be called when a gesture is recognized
+        ///@param timings Gesture timings of the button
+        Button(uint32_t button_pin, GestureCallbackFunction_t *callback_gesture,
+               const ButtonTimings_t &timings = DEFAULT_TIMINGS);
 
         /// Initialize the Button module
         static void Init(void);
@@ -43,18 +49,31 @@ namespace hal
 
     private:
         uint32_t m_button_pin;
-        ToggleCallbackFunction_t *m_callback_is_pressed;
-        ToggleCallbackFunction_t *m_callback_is_released;
+        ButtonGestureRecognizer m_recognizer;
 
         static Button *s_button_instances[MAX_BUTTONS];
         static uint8_t s_button_count;
 
+        static eda::Timer s_timer;
+        static volatile bool s_is_timer_armed;
+
         /// Helper function for configuring a pin
         ///@param pin_num Pin number
         ///@param polarity Polarity for the GPIOTE channel that triggers an interruption.
         static void ButtonHandler(nrfx_gpiote_pin_t pin_num,
                                   nrf_gpiote_polarity_t polarity);
+
+        /// Callback function for the gesture timer
+        ///
+        ///@param xTimer Handle to the timer
+        static void TimerCallback(TimerHandle_t xTimer);
+
+        /// Runs the gesture recognizer of a button, timer task context
+        ///
+        ///@param now_ticks Current tick count
+        ///@return true while the button needs more evaluations
+        bool Process(uint32_t now_ticks);
     };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,172 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file hal_button_gesture.cpp
+ * @brief Button debounce and gesture recognition, independent of the GPIOTE and timer
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "eda_manager_log_config.h"
+
+#include "hal_button_gesture.h"
+
+namespace hal
+{
+    ButtonGestureRecognizer::ButtonGestureRecognizer(uint32_t id, GestureCallbackFunction_t *callback_gesture,
+                                                     const ButtonTimings_t &timings, uint32_t tick_rate_hz)
+        : m_id(id),
+          m_callback_gesture(callback_gesture),
+          m_debounce_ticks(MsToTicks(timings.debounce_ms, tick_rate_hz)),
+          m_long_press_ticks(MsToTicks(timings.long_press_ms, tick_rate_hz)),
+          m_double_press_ticks(MsToTicks(timings.double_press_ms, tick_rate_hz)),
+          m_is_edge_pending(false),
+          m_last_edge_ticks(0),
+          m_settled_edge_ticks(0),
+          m_is_pressed(false),
+          m_state(GestureState_e::IDLE),
+          m_state_ticks(0)
+    {
+    }
+
+    void ButtonGestureRecognizer::Reset(bool is_pressed)
+    {
+        m_is_pressed = is_pressed;
+        m_state = GestureState_e::IDLE;
+    }
+
+    void ButtonGestureRecognizer::OnEdge(uint32_t edge_ticks)
+    {
+        m_last_edge_ticks = edge_ticks;
+        m_is_edge_pending = true;
+    }
+
+    bool ButtonGestureRecognizer::IsEdgePending(void) const
+    {
+        return m_is_edge_pending;
+    }
+
+    ButtonGestureRecognizer::Debounce_e ButtonGestureRecognizer::Debounce(uint32_t now_ticks)
+    {
+        if (!m_is_edge_pending)
+        {
+            return Debounce_e::QUIET;
+        }
+
+        const uint32_t edge_ticks = m_last_edge_ticks;
+
+        if ((now_ticks - edge_ticks) < m_debounce_ticks)
+        {
+            return Debounce_e::BOUNCING;
+        }
+
+        m_is_edge_pending = false;
+        m_settled_edge_ticks = edge_ticks;
+        return Debounce_e::SETTLED;
+    }
+
+    bool ButtonGestureRecognizer::Process(uint32_t now_ticks, Debounce_e debounce, bool is_pressed)
+    {
+        if (debounce == Debounce_e::BOUNCING)
+        {
+            return true;
+        }
+
+        // A bounce back to the previous level is not a gesture
+        if ((debounce == Debounce_e::SETTLED) && (is_pressed != m_is_pressed))
+        {
+            m_is_pressed = is_pressed;
+            OnLevelChanged(is_pressed, m_settled_edge_ticks);
+        }
+
+        switch (m_state)
+        {
+        case GestureState_e::PRESSED:
+            if (m_long_press_ticks == 0)
+            {
+                return false;
+            }
+            if ((now_ticks - m_state_ticks) >= m_long_press_ticks)
+            {
+                m_state = GestureState_e::LONG_HELD;
+                Notify(ButtonGesture_e::LONG_PRESS);
+                return false;
+            }
+            return true;
+        case GestureState_e::WAIT_SECOND:
+            if ((now_ticks - m_state_ticks) > m_double_press_ticks)
+            {
+                m_state = GestureState_e::IDLE;
+                Notify(ButtonGesture_e::PRESS);
+                return false;
+            }
+            return true;
+        default:
+            // The other states only wait for an edge
+            return false;
+        }
+    }
+
+    uint32_t ButtonGestureRecognizer::MsToTicks(uint32_t ms, uint32_t tick_rate_hz)
+    {
+        return static_cast<uint32_t>((static_cast<uint64_t>(ms) * tick_rate_hz) / 1000U);
+    }
+
+    void ButtonGestureRecognizer::OnLevelChanged(bool is_pressed, uint32_t edge_ticks)
+    {
+        switch (m_state)
+        {
+        case GestureState_e::IDLE:
+            if (is_pressed)
+            {
+                m_state = GestureState_e::PRESSED;
+                m_state_ticks = edge_ticks;
+            }
+            break;
+        case GestureState_e::PRESSED:
+            if (!is_pressed)
+            {
+                if (m_double_press_ticks == 0)
+                {
+                    m_state = GestureState_e::IDLE;
+                    Notify(ButtonGesture_e::PRESS);
+                }
+                else
+                {
+                    m_state = GestureState_e::WAIT_SECOND;
+                    m_state_ticks = edge_ticks;
+                }
+            }
+            break;
+        case GestureState_e::LONG_HELD:
+            if (!is_pressed)
+            {
+                m_state = GestureState_e::IDLE;
+                Notify(ButtonGesture_e::RELEASE);
+            }
+            break;
+        case GestureState_e::WAIT_SECOND:
+            if (is_pressed)
+            {
+                m_state = GestureState_e::SECOND_PRESSED;
+                Notify(ButtonGesture_e::DOUBLE_PRESS);
+            }
+            break;
+        case GestureState_e::SECOND_PRESSED:
+            if (!is_pressed)
+            {
+                m_state = GestureState_e::IDLE;
+            }
+            break;
+        }
+    }
+
+    void ButtonGestureRecognizer::Notify(ButtonGesture_e gesture)
+    {
+        LOG_INFO("Button %u gesture %u\n", m_id, static_cast<uint8_t>(gesture));
+
+        if (m_callback_gesture)
+        {
+            m_callback_gesture(gesture);
+        }
+    }
+}
@@ -0,0 +1,124 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file hal_button_gesture.h
+ * @brief Button debounce and gesture recognition, independent of the GPIOTE and timer
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef HAL_BUTTON_GESTURE_H
+#define HAL_BUTTON_GESTURE_H
+
+#include <cstdint>
+
+namespace hal
+{
+    /// Gestures recognized on a button, one per gesture
+    enum class ButtonGesture_e : uint8_t
+    {
+        PRESS,       // Short press, given once the double press window is over
+        RELEASE,     // End of a long press
+        LONG_PRESS,  // Button held for the long press time, given while still held
+        DOUBLE_PRESS // Second press within the double press window, its release gives nothing
+    };
+
+    /// Gesture timings of a button
+    typedef struct
+    {
+        uint16_t debounce_ms;     // Quiet time needed after an edge before the level is read
+        uint16_t long_press_ms;   // Hold time of a long press, 0 disables it
+        uint16_t double_press_ms; // Maximum time from a release to the next press, 0 disables it and PRESS is given on release
+    } ButtonTimings_t;
+
+    /// Called from the timer task when a gesture is recognized
+    using GestureCallbackFunction_t = void(ButtonGesture_e gesture);
+
+    class ButtonGestureRecognizer
+    {
+    public:
+        /// Result of the debounce of the pending edges
+        enum class Debounce_e : uint8_t
+        {
+            QUIET,    // No edge since the last evaluation
+            BOUNCING, // Edge seen, the quiet time is not over yet
+            SETTLED   // Quiet time over, the level can be read
+        };
+
+        /// Construct the recognizer of a button
+        ///
+        ///@param id Identifier of the button in the logs
+        ///@param callback_gesture The function to be called when a gesture is recognized
+        ///@param timings Gesture timings of the button
+        ///@param tick_rate_hz Rate of the tick count given to the recognizer
+        ButtonGestureRecognizer(uint32_t id, GestureCallbackFunction_t *callback_gesture,
+                                const ButtonTimings_t &timings, uint32_t tick_rate_hz);
+
+        /// Set the debounced level without giving a gesture, a button held at start up gives nothing until it is released
+        ///
+        ///@param is_pressed Current level
+        void Reset(bool is_pressed);
+
+        /// Record an edge, interrupt context. Edges inside the debounce window are merged, only the quiet time restarts.
+        ///
+        ///@param edge_ticks Time of the edge
+        void OnEdge(uint32_t edge_ticks);
+
+        /// Returns true while an edge waits for its quiet time
+        bool IsEdgePending(void) const;
+
+        /// Consume the pending edge once its quiet time is over. The only access to the state shared with OnEdge,
+        /// the caller makes it atomic against the interrupt.
+        ///
+        ///@param now_ticks Current tick count
+        ///@return Debounce result, to give to Process
+        Debounce_e Debounce(uint32_t now_ticks);
+
+        /// Run the gesture state machine, timer task context
+        ///
+        ///@param now_ticks Current tick count
+        ///@param debounce Result of Debounce for the same tick count
+        ///@param is_pressed Current level, only used once the edge settled
+        ///@return true while the button needs more evaluations
+        bool Process(uint32_t now_ticks, Debounce_e debounce, bool is_pressed);
+
+    private:
+        enum class GestureState_e : uint8_t
+        {
+            IDLE,
+            PRESSED,        // First press held, waiting for the release or the long press time
+            LONG_HELD,      // Long press given, waiting for the release
+            WAIT_SECOND,    // Short press released, waiting for a second press
+            SECOND_PRESSED  // Double press given, waiting for the release
+        };
+
+        uint32_t m_id;
+        GestureCallbackFunction_t *m_callback_gesture;
+
+        uint32_t m_debounce_ticks;
+        uint32_t m_long_press_ticks;
+        uint32_t m_double_press_ticks;
+
+        volatile bool m_is_edge_pending;     // Set by the interrupt, cleared once the level is read
+        volatile uint32_t m_last_edge_ticks; // Written by the interrupt
+        uint32_t m_settled_edge_ticks;       // Time of the edge consumed by the last SETTLED result
+
+        bool m_is_pressed;                   // Debounced level
+        GestureState_e m_state;
+        uint32_t m_state_ticks;              // Time of the debounced edge that entered the state
+
+        /// Converts a time to ticks, rounded down like pdMS_TO_TICKS
+        static uint32_t MsToTicks(uint32_t ms, uint32_t tick_rate_hz);
+
+        /// Moves the gesture state machine on a debounced level change
+        ///
+        ///@param is_pressed New debounced level
+        ///@param edge_ticks Time of the edge
+        void OnLevelChanged(bool is_pressed, uint32_t edge_ticks);
+
+        /// Gives a gesture to the callback
+        void Notify(ButtonGesture_e gesture);
+    };
+}
+
+#endif
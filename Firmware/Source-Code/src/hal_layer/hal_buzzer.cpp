@@ -10,28 +10,59 @@
 #include "hal_buzzer.h"
 #include "hal_gpio.h"
 
-static nrf_drv_pwm_t PWM_BUZZER = NRF_DRV_PWM_INSTANCE(0);
+#include "FreeRTOS.h"
+#include "task.h"
+
+// PWM0 belongs to the LEDs, the buzzer has its own instance to play at the same time
+static nrf_drv_pwm_t PWM_BUZZER = NRF_DRV_PWM_INSTANCE(1);
 
 namespace hal
 {
+    static const note_t CHARGED_NOTES[] = {
+        {84, 10}, // C6
+        {88, 10}, // E6
+        {91, 10}, // G6
+        {96, 30}, // C7
+    };
+
+    static const note_t ALARM_NOTES[] = {
+        {93, 20}, // A6
+        {BUZZER_REST, 10},
+        {93, 20},
+        {BUZZER_REST, 10},
+        {93, 20},
+        {BUZZER_REST, 10},
+    };
+
+    const melody_t MELODY_CHARGED = {CHARGED_NOTES, sizeof(CHARGED_NOTES) / sizeof(note_t), 50, BuzzerPriority_e::NORMAL};
+    const melody_t MELODY_ALARM = {ALARM_NOTES, sizeof(ALARM_NOTES) / sizeof(note_t), 50, BuzzerPriority_e::ALARM};
+
+    // Frequencies of the highest octave, C8 to B8, in Hz. Lower octaves are halved from it.
+    static const uint16_t OCTAVE_8_FREQUENCIES[12] = {4186, 4435, 4699, 4978, 5274, 5588, 5920, 6272, 6645, 7040, 7459, 7902};
+
     Buzzer::Buzzer()
     {
     }
 
     nrf_drv_pwm_t Buzzer::mPwmInstance;
-    nrf_pwm_values_individual_t Buzzer::mSeqValues[] = {0, 0, 0, 0};
-    nrf_pwm_sequence_t const Buzzer::mSequence =
-        {
-            .values = {.p_individual = mSeqValues},
-            .length = NRF_PWM_VALUES_LENGTH(mSeqValues),
-            .repeats = 0,
-            .end_delay = 0};
+    nrf_pwm_values_wave_form_t Buzzer::mSeqValues[2];
+    nrf_pwm_sequence_t Buzzer::mSequences[2];
+    bool Buzzer::mIsSilence[2];
+    const melody_t *Buzzer::mQueue[QUEUE_LENGTH];
+    uint8_t Buzzer::mQueueCount = 0;
+    const melody_t *Buzzer::mCurrentMelody = nullptr;
+    uint8_t Buzzer::mNoteIndex = 0;
+    volatile bool Buzzer::mIsPlaying = false;
+    bool Buzzer::mIsInitialized = false;
 
-    void Buzzer::pwmInit(nrf_drv_pwm_t *pwm, uint16_t frequency, uint16_t intensity)
+    void Buzzer::init()
     {
-        mFrequency = frequency;
-        mIntensity = intensity;
-        uint16_t topValue = mBaseFrecuency / frequency;
+        if (mIsInitialized)
+        {
+            return;
+        }
+
+        mPwmInstance = PWM_BUZZER;
 
         hal::Gpio::gpio_config_t buzzerPinConfig = {
             .pin_number = PIN_BUZZER,
@@ -43,6 +74,7 @@ namespace hal
 
         hal::Gpio::ConfigurePin(buzzerPinConfig);
 
+        // In wave form mode the top value is read from each sequence value, the one here is not used
         nrf_drv_pwm_config_t pwmConfig =
             {
                 .output_pins =
@@ -55,72 +87,203 @@ namespace hal
                 .irq_priority = APP_IRQ_PRIORITY_LOWEST,
                 .base_clock = NRF_PWM_CLK_1MHz,
                 .count_mode = NRF_PWM_MODE_UP,
-                .top_value = topValue,
-                .load_mode = NRF_PWM_LOAD_INDIVIDUAL,
+                .top_value = REST_TOP_VALUE,
+                .load_mode = NRF_PWM_LOAD_WAVE_FORM,
                 .step_mode = NRF_PWM_STEP_AUTO,
             };
 
-        if (nrf_drv_pwm_init(pwm, &pwmConfig, Buzzer::handler) != NRF_SUCCESS)
+        for (uint8_t slot = 0; slot < 2; slot++)
+        {
+            mSequences[slot].values.p_wave_form = &mSeqValues[slot];
+            mSequences[slot].length = NRF_PWM_VALUES_LENGTH(mSeqValues[slot]);
+            mSequences[slot].repeats = 0;
+            mSequences[slot].end_delay = 0;
+        }
+
+        if (nrf_drv_pwm_init(&mPwmInstance, &pwmConfig, Buzzer::handler) == NRF_SUCCESS)
         {
-            nrf_drv_pwm_uninit(&mPwmInstance);
-            nrf_drv_pwm_init(pwm, &pwmConfig, Buzzer::handler);
+            mIsInitialized = true;
         }
     }
 
-    void Buzzer::pwmUninit(nrf_drv_pwm_t *pwm)
+    bool Buzzer::playMelody(const melody_t &melody)
     {
-        nrf_drv_pwm_uninit(pwm);
+        if (!mIsInitialized || (melody.notes == nullptr) || (melody.length == 0))
+        {
+            return false;
+        }
+
+        bool isQueued = false;
+
+        taskENTER_CRITICAL();
+
+        if (mQueueCount < QUEUE_LENGTH)
+        {
+            mQueue[mQueueCount++] = &melody;
+            isQueued = true;
+
+            if (!mIsPlaying)
+            {
+                startNextMelody();
+            }
+            else if ((mCurrentMelody != nullptr) && (melody.priority > mCurrentMelody->priority))
+            {
+                // The STOPPED event starts the queued melody with the highest priority
+                nrf_drv_pwm_stop(&mPwmInstance, false);
+            }
+        }
+
+        taskEXIT_CRITICAL();
+
+        return isQueued;
     }
 
-    void Buzzer::init()
+    void Buzzer::stop()
     {
-        mPwmInstance = PWM_BUZZER;
+        taskENTER_CRITICAL();
+
+        mQueueCount = 0;
+
+        if (mIsPlaying)
+        {
+            nrf_drv_pwm_stop(&mPwmInstance, false);
+        }
+
+        taskEXIT_CRITICAL();
     }
 
-    void Buzzer::handler(nrf_drv_pwm_evt_type_t event_type)
+    bool Buzzer::isPlaying()
     {
-        static uint8_t sequenceIndex = 0;
+        return mIsPlaying;
+    }
 
-        if (event_type == NRF_DRV_PWM_EVT_FINISHED)
+    void Buzzer::handler(nrf_drv_pwm_evt_type_t event_type)
+    {
+        switch (event_type)
         {
-            if (sequenceIndex < currentMelody.length)
+        case NRF_DRV_PWM_EVT_END_SEQ0:
+        case NRF_DRV_PWM_EVT_END_SEQ1:
+        {
+            // The other sequence is playing, the one that ended is refilled with the note after it
+            uint8_t slot = (event_type == NRF_DRV_PWM_EVT_END_SEQ0) ? 0 : 1;
+
+            if (mIsSilence[slot])
             {
-                Buzzer::playSequence(Buzzer::currentMelody.notes[sequenceIndex]);
-                sequenceIndex++;
+                // The melody is over, both sequences hold a silence
+                nrf_drv_pwm_stop(&mPwmInstance, false);
             }
             else
             {
-                nrf_drv_pwm_uninit(&mPwmInstance);
-                sequenceIndex = 0;
+                loadNote(slot);
+                nrf_drv_pwm_sequence_update(&mPwmInstance, slot, &mSequences[slot]);
             }
+            break;
+        }
+        case NRF_DRV_PWM_EVT_STOPPED:
+            startNextMelody();
+            break;
+        default:
+            break;
         }
     }
 
-    void Buzzer::playMelody(melody_t melody)
+    void Buzzer::startNextMelody()
     {
-        currentMelody = melody;
-        Buzzer::playSequence(currentMelody.notes[0]);
+        if (mQueueCount == 0)
+        {
+            mCurrentMelody = nullptr;
+            mIsPlaying = false;
+            return;
+        }
+
+        // Highest priority first, in queuing order among the same priority
+        uint8_t next = 0;
+
+        for (uint8_t i = 1; i < mQueueCount; i++)
+        {
+            if (mQueue[i]->priority > mQueue[next]->priority)
+            {
+                next = i;
+            }
+        }
+
+        mCurrentMelody = mQueue[next];
+
+        for (uint8_t i = next; i < (mQueueCount - 1); i++)
+        {
+            mQueue[i] = mQueue[i + 1];
+        }
+        mQueueCount--;
+
+        mNoteIndex = 0;
+        loadNote(0);
+        loadNote(1);
+
+        mIsPlaying = true;
+
+        // Both sequences loop until a silence is reached, each end event reloads the sequence that ended
+        nrf_drv_pwm_complex_playback(&mPwmInstance, &mSequences[0], &mSequences[1], 1,
+                                     NRF_DRV_PWM_FLAG_LOOP | NRF_DRV_PWM_FLAG_SIGNAL_END_SEQ0 |
+                                         NRF_DRV_PWM_FLAG_SIGNAL_END_SEQ1 | NRF_DRV_PWM_FLAG_NO_EVT_FINISHED);
     }
 
-    void Buzzer::playSequence(sound_t note)
+    void Buzzer::loadNote(uint8_t slot)
     {
-        Buzzer::pwmInit(&mPwmInstance, note.frequency, note.intensity);
+        nrf_pwm_values_wave_form_t &value = mSeqValues[slot];
+        uint32_t periods;
 
-        uint16_t topValue = mBaseFrecuency / note.frequency;
+        if (mNoteIndex >= mCurrentMelody->length)
+        {
+            value.counter_top = REST_TOP_VALUE;
+            value.channel_0 = REST_TOP_VALUE;
+            mSequences[slot].repeats = 0;
+            mIsSilence[slot] = true;
+            return;
+        }
 
-        uint16_t dutyCycle = topValue - (topValue * note.intensity) / 100;
+        const note_t &note = mCurrentMelody->notes[mNoteIndex++];
+        uint16_t frequency = getFrequency(note.pitch);
 
-        mSeqValues->channel_0 = dutyCycle;
+        if (frequency == 0)
+        {
+            // A compare value equal to the top value keeps the output low
+            value.counter_top = REST_TOP_VALUE;
+            value.channel_0 = REST_TOP_VALUE;
+            periods = note.duration * (mBaseFrecuency / REST_TOP_VALUE) / 100;
+        }
+        else
+        {
+            uint32_t topValue = mBaseFrecuency / frequency;
 
-        nrf_pwm_sequence_t const mSequence =
+            if (topValue > MAX_TOP_VALUE)
             {
-                .values = {.p_individual = mSeqValues},
-                .length = NRF_PWM_VALUES_LENGTH(mSeqValues),
-                .repeats = 0,
-                .end_delay = 0};
+                topValue = MAX_TOP_VALUE;
+            }
 
-        currentSound = note;
-        nrf_drv_pwm_simple_playback(&mPwmInstance, &Buzzer::mSequence, 1, NRF_DRV_PWM_FLAG_STOP);
+            value.counter_top = static_cast<uint16_t>(topValue);
+            value.channel_0 = static_cast<uint16_t>(topValue - (topValue * mCurrentMelody->intensity) / 100);
+            periods = (note.duration * frequency) / 100;
+        }
+
+        value.channel_1 = 0;
+        value.channel_2 = 0;
+
+        // Each value is played once plus the repeats, one PWM period each
+        mSequences[slot].repeats = (periods > 1) ? (periods - 1) : 0;
+        mIsSilence[slot] = false;
     }
 
-}
\ No newline at end of file
+    uint16_t Buzzer::getFrequency(uint8_t pitch)
+    {
+        if (pitch == BUZZER_REST)
+        {
+            return 0;
+        }
+
+        // MIDI octave numbering starts at -1, pitch / 12 is 9 for the eighth octave
+        uint8_t octave = pitch / 12;
+        uint8_t shift = (octave < 9) ? (9 - octave) : 0;
+
+        return OCTAVE_8_FREQUENCIES[pitch % 12] >> shift;
+    }
+}
@@ -17,21 +17,36 @@
 
 #include <stdint.h>
 
+#define BUZZER_REST 0 /**< Pitch of a silent note */
+
 namespace hal
 {
+    /**
+     * @brief Note of a melody table, two bytes per note
+     */
     typedef struct
     {
-        uint16_t intensity;
-        uint16_t frequency; // in Hz
-        uint16_t duration;  // in ms
-    } sound_t;
+        uint8_t pitch;    // MIDI note number (69 = A4, 440 Hz), BUZZER_REST for a silence
+        uint8_t duration; // in 10 ms units
+    } note_t;
+
+    enum class BuzzerPriority_e : uint8_t
+    {
+        NORMAL,
+        ALARM // Interrupts a NORMAL melody at once
+    };
 
     typedef struct
     {
-        sound_t *notes;
+        const note_t *notes;
         uint8_t length;
+        uint8_t intensity; // Duty cycle in percent, 50 is the loudest
+        BuzzerPriority_e priority;
     } melody_t;
 
+    extern const melody_t MELODY_CHARGED;
+    extern const melody_t MELODY_ALARM;
+
     class Buzzer
     {
     public:
@@ -39,28 +54,51 @@ namespace hal
 
         static void init(void);
 
-        static void playMelody(melody_t melody);
+        /**
+         * @brief Queues a melody, played from the PWM interrupt. An ALARM melody stops a NORMAL one.
+         * @param melody Melody to play, its note table must stay valid until it is played
+         * @return false if the queue is full
+         */
+        static bool playMelody(const melody_t &melody);
 
-        static uint8_t counter;
+        /**
+         * @brief Stops the melody being played and empties the queue
+         */
+        static void stop(void);
+
+        static bool isPlaying(void);
 
     private:
-        static void pwmInit(nrf_drv_pwm_t *pwm, uint16_t frequency, uint16_t intensity);
-        static void pwmUninit(nrf_drv_pwm_t *pwm);
+        static constexpr uint8_t QUEUE_LENGTH = 4;        // Melodies waiting to be played
+        static constexpr uint16_t REST_TOP_VALUE = 1000;  // 1 ms period during a silence
+        static constexpr uint16_t MAX_TOP_VALUE = 0x7FFF; // Lowest frequency the counter can produce, ~31 Hz
+
         static void handler(nrf_drv_pwm_evt_type_t event_type);
-        static void playSequence(sound_t note);
 
-        static melody_t currentMelody;
-        static sound_t currentSound;
+        // Starts the highest priority queued melody, or leaves the PWM stopped
+        static void startNextMelody(void);
 
-        static uint16_t mFrequency;
-        static uint16_t mIntensity;
+        // Loads the next note of the melody, or a silence past its end, into a sequence slot
+        static void loadNote(uint8_t slot);
 
-        static nrf_pwm_sequence_t const mSequence;
-        static nrf_pwm_values_individual_t mSeqValues[];
+        static uint16_t getFrequency(uint8_t pitch);
 
         static const uint32_t mBaseFrecuency = 1000000U;
         static nrf_drv_pwm_t mPwmInstance;
+
+        // One waveform value per sequence: the top value sets the note frequency without a re-init
+        static nrf_pwm_values_wave_form_t mSeqValues[2];
+        static nrf_pwm_sequence_t mSequences[2];
+        static bool mIsSilence[2];
+
+        static const melody_t *mQueue[QUEUE_LENGTH];
+        static uint8_t mQueueCount;
+
+        static const melody_t *mCurrentMelody;
+        static uint8_t mNoteIndex;
+        static volatile bool mIsPlaying;
+        static bool mIsInitialized;
     };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -14,8 +14,7 @@
 #include <cstdint>
 
 // Define the static member variables
-hal::gpio_call_back_t hal::Gpio::mCallBacks[40] = {}; // Allocate storage for callbacks
-uint8_t hal::Gpio::mPinValues[40] = {};     // Allocate storage for pin values
+hal::gpio_call_back_t hal::Gpio::mCallBacks[NUMBER_OF_PINS] = {}; // Allocate storage for callbacks
 
 namespace hal
 {
@@ -34,13 +33,15 @@ namespace hal
         return nrf_gpio_pin_read(pin_number);
     }
 
-    uint8_t *Gpio::ReadMultiple(const uint32_t *pin_numbers, uint32_t num_pins)
+    void Gpio::ReadMultiple(const uint32_t *pin_numbers, uint8_t *values, uint32_t num_pins)
     {
+        // Both ports are sampled at once, the states are consistent with each other
+        const uint32_t inputs[2] = {nrf_gpio_port_in_read(NRF_P0), nrf_gpio_port_in_read(NRF_P1)};
+
         for (uint32_t i = 0; i < num_pins; i++)
         {
-            mPinValues[pin_numbers[i]] = nrf_gpio_pin_read(pin_numbers[i]);
+            values[i] = (inputs[pin_numbers[i] >> 5] >> (pin_numbers[i] & 31)) & 1UL;
         }
-        return mPinValues;
     }
 
     void Gpio::Write(uint32_t pin_number, uint32_t value)
@@ -50,10 +51,19 @@ namespace hal
 
     void Gpio::WriteMultiple(const uint32_t *pin_numbers, const uint32_t *values, uint32_t num_pins)
     {
+        uint32_t set_masks[2] = {0, 0};
+        uint32_t clear_masks[2] = {0, 0};
+
         for (uint32_t i = 0; i < num_pins; i++)
         {
-            nrf_gpio_pin_write(pin_numbers[i], values[i]);
+            uint32_t *masks = (values[i] != 0) ? set_masks : clear_masks;
+            masks[pin_numbers[i] >> 5] |= 1UL << (pin_numbers[i] & 31);
         }
+
+        nrf_gpio_port_out_set(NRF_P0, set_masks[PORT0]);
+        nrf_gpio_port_out_clear(NRF_P0, clear_masks[PORT0]);
+        nrf_gpio_port_out_set(NRF_P1, set_masks[PORT1]);
+        nrf_gpio_port_out_clear(NRF_P1, clear_masks[PORT1]);
     }
 
     void Gpio::SetCallback(HalPinEventHandler_t event_handler,
@@ -63,12 +73,15 @@ namespace hal
         mCallBacks[pin_num] = {event_handler, pin_num, polarity};
     }
 
-    nrfx_gpiote_evt_handler_t Gpio::EventHandler(nrfx_gpiote_pin_t pin_num,
-                                                 nrf_gpiote_polarity_t polarity)
+    void Gpio::EventHandler(nrfx_gpiote_pin_t pin_num,
+                            nrf_gpiote_polarity_t polarity)
     {
         auto CallBack = (mCallBacks[pin_num]).event_handler;
-        CallBack();
-        return NULL;
+
+        if (CallBack != nullptr)
+        {
+            CallBack();
+        }
     }
 
     void Gpio::ConfigurePin(const gpio_config_t config)
@@ -95,7 +108,8 @@ namespace hal
                             HalPinEventHandler_t handler)
     {
         SetCallback(handler, pin_num, polarity);
-        nrf_drv_gpiote_in_init(pin_num, &config, EventHandler(pin_num, polarity));
+        // The handler is registered with the driver, it runs in the GPIOTE interrupt
+        nrf_drv_gpiote_in_init(pin_num, &config, EventHandler);
         nrf_drv_gpiote_in_event_enable(pin_num, true);
     }
 
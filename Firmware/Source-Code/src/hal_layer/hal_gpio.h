@@ -146,12 +146,12 @@ namespace hal
         static uint8_t Read(uint32_t pin_number);
 
         /**
-         * @brief Reads the state of the list of GPIOs given as parameters
+         * @brief Reads the state of the list of GPIOs given as parameters, each port is read once
          * @param pin_numbers List of pins numbers to read
+         * @param values Pin states (0 or 1), in the order of pin_numbers
          * @param num_pins Number of pins to read
-         * @return List of all pin states where just the states of pin_numbers are updated
          */
-        static uint8_t *ReadMultiple(const uint32_t *pin_numbers, uint32_t num_pins);
+        static void ReadMultiple(const uint32_t *pin_numbers, uint8_t *values, uint32_t num_pins);
 
         /**
          * @brief Sets the state of a GPIO pin
@@ -161,7 +161,7 @@ namespace hal
         static void Write(uint32_t pin_number, uint32_t value);
 
         /**
-         * @brief Sets the state of a list of GPIOs pin
+         * @brief Sets the state of a list of GPIOs pin, with one OUTSET and one OUTCLR store per port
          * @param pin_number Lis of pin numbers to set
          * @param values Values of the pins to set (0 or 1)
          * @param num_pins Number of pins to write
@@ -182,15 +182,128 @@ namespace hal
                                 nrf_gpiote_polarity_t polarity);
 
         /**
-         * @brief Helper function for configuring a pin
+         * @brief GPIOTE event handler, forwards the event to the handler saved for the pin
          * @param pin_num Pin number
          * @param polarity Polarity for the GPIOTE channel that triggers an interruption.
          */
-        static nrfx_gpiote_evt_handler_t EventHandler(nrfx_gpiote_pin_t pin_num,
-                                                      nrf_gpiote_polarity_t polarity);
+        static void EventHandler(nrfx_gpiote_pin_t pin_num,
+                                 nrf_gpiote_polarity_t polarity);
 
-        static gpio_call_back_t mCallBacks[40];
-        static uint8_t mPinValues[40];
+        static gpio_call_back_t mCallBacks[NUMBER_OF_PINS];
+    };
+
+    /**
+     * @brief Compile-time group of GPIO pins, turned into port masks.
+     *
+     * Whatever the number of pins, a write is one OUTSET and one OUTCLR store per port and a read
+     * is one IN read per port, so the pins of a port change together. Bit i of the values is the
+     * i-th pin of the list.
+     *
+     * @tparam Pins Pin numbers, as given by NRF_GPIO_PIN_MAP
+     */
+    template <uint32_t... Pins>
+    class PinGroup
+    {
+    public:
+        static constexpr uint32_t PIN_COUNT = sizeof...(Pins);
+
+        /// Values with every pin of the group set
+        static constexpr uint32_t ALL_PINS = (PIN_COUNT == 32) ? UINT32_MAX : ((1UL << PIN_COUNT) - 1);
+
+        static constexpr uint32_t PORT0_MASK = (0UL | ... | (((Pins >> 5) == PORT0) ? (1UL << (Pins & 31)) : 0UL));
+        static constexpr uint32_t PORT1_MASK = (0UL | ... | (((Pins >> 5) == PORT1) ? (1UL << (Pins & 31)) : 0UL));
+
+        static_assert((PIN_COUNT > 0) && (PIN_COUNT <= 32), "A pin group holds 1 to 32 pins");
+        static_assert(((Pins < NUMBER_OF_PINS) && ...), "Pin number out of range");
+        static_assert(__builtin_popcount(PORT0_MASK) + __builtin_popcount(PORT1_MASK) == PIN_COUNT, "Duplicated pin in the group");
+
+        /**
+         * @brief Sets every pin of the group
+         */
+        static void Set()
+        {
+            if constexpr (PORT0_MASK != 0)
+            {
+                nrf_gpio_port_out_set(NRF_P0, PORT0_MASK);
+            }
+            if constexpr (PORT1_MASK != 0)
+            {
+                nrf_gpio_port_out_set(NRF_P1, PORT1_MASK);
+            }
+        }
+
+        /**
+         * @brief Clears every pin of the group
+         */
+        static void Clear()
+        {
+            if constexpr (PORT0_MASK != 0)
+            {
+                nrf_gpio_port_out_clear(NRF_P0, PORT0_MASK);
+            }
+            if constexpr (PORT1_MASK != 0)
+            {
+                nrf_gpio_port_out_clear(NRF_P1, PORT1_MASK);
+            }
+        }
+
+        /**
+         * @brief Sets the state of every pin of the group
+         * @param values Bit i is the state of the i-th pin
+         */
+        static void Write(uint32_t values)
+        {
+            uint32_t set_masks[2] = {0, 0};
+
+            // Fixed number of iterations, unrolled by the compiler
+            for (uint32_t i = 0; i < PIN_COUNT; i++)
+            {
+                if ((values >> i) & 1UL)
+                {
+                    set_masks[PIN_LIST[i] >> 5] |= 1UL << (PIN_LIST[i] & 31);
+                }
+            }
+
+            if constexpr (PORT0_MASK != 0)
+            {
+                nrf_gpio_port_out_set(NRF_P0, set_masks[PORT0]);
+                nrf_gpio_port_out_clear(NRF_P0, PORT0_MASK & ~set_masks[PORT0]);
+            }
+            if constexpr (PORT1_MASK != 0)
+            {
+                nrf_gpio_port_out_set(NRF_P1, set_masks[PORT1]);
+                nrf_gpio_port_out_clear(NRF_P1, PORT1_MASK & ~set_masks[PORT1]);
+            }
+        }
+
+        /**
+         * @brief Reads the state of every pin of the group
+         * @return Bit i is the state of the i-th pin
+         */
+        static uint32_t Read()
+        {
+            uint32_t inputs[2] = {0, 0};
+
+            if constexpr (PORT0_MASK != 0)
+            {
+                inputs[PORT0] = nrf_gpio_port_in_read(NRF_P0);
+            }
+            if constexpr (PORT1_MASK != 0)
+            {
+                inputs[PORT1] = nrf_gpio_port_in_read(NRF_P1);
+            }
+
+            uint32_t values = 0;
+            for (uint32_t i = 0; i < PIN_COUNT; i++)
+            {
+                values |= ((inputs[PIN_LIST[i] >> 5] >> (PIN_LIST[i] & 31)) & 1UL) << i;
+            }
+
+            return values;
+        }
+
+    private:
+        static constexpr uint32_t PIN_LIST[PIN_COUNT] = {Pins...};
     };
 }
 #endif
@@ -14,12 +14,23 @@
 
 #include "../core_layer/event_driven_architecture/manager/eda_manager.h"
 
-#include "nrf_delay.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <cstring>
 
 namespace hal
 {
     // Static members definition
-    nrf_pwm_values_common_t Leds::s_sequence[LEDS_SEQUENCE_LENGTH_TOTAL] = {};
+    nrf_pwm_values_common_t Leds::s_frames[2][LEDS_FRAME_LENGTH] = {};
+    uint8_t Leds::s_frame_colors[2][LEDS_ARRAY_QTY][3] = {};
+    LedSlot_t Leds::s_slots[LEDS_ARRAY_QTY] = {};
+    uint8_t Leds::s_front = 0;
+    uint32_t Leds::s_frame_count = 0;
+    bool Leds::s_is_back_stale = false;
+    volatile bool Leds::s_is_playing = false;
+    bool Leds::s_is_testing = false;
+    uint32_t Leds::s_test_start_frame = 0;
     Leds Leds::s_instance;
     bool Leds::s_initialized = false;
 
@@ -73,28 +84,47 @@ namespace hal
 
     void Leds::SetLedColor(RgbLed_t *led, LedPosition_e position, LedColor_e color)
     {
+        uint8_t red;
+        uint8_t green;
+        uint8_t blue;
+
+        GetColorComponents(color, red, green, blue);
+        ConfigureLedColor(led, position, red, green, blue);
+    }
+
+    void Leds::GetColorComponents(LedColor_e color, uint8_t &red, uint8_t &green, uint8_t &blue)
+    {
+        red = 0;
+        green = 0;
+        blue = 0;
+
         switch (color)
         {
         case LedColor_e::RED:
-            ConfigureLedColor(led, position, 100, 0, 0);
+            red = 100;
             break;
         case LedColor_e::GREEN:
-            ConfigureLedColor(led, position, 0, 100, 0);
+            green = 100;
             break;
         case LedColor_e::BLUE:
-            ConfigureLedColor(led, position, 0, 0, 100);
+            blue = 100;
             break;
         case LedColor_e::YELLOW:
-            ConfigureLedColor(led, position, 100, 100, 0);
+            red = 100;
+            green = 100;
             break;
         case LedColor_e::CYAN:
-            ConfigureLedColor(led, position, 100, 0, 100);
+            red = 100;
+            blue = 100;
             break;
         case LedColor_e::MAGENTA:
-            ConfigureLedColor(led, position, 0, 100, 100);
+            green = 100;
+            blue = 100;
             break;
         case LedColor_e::WHITE:
-            ConfigureLedColor(led, position, 100, 100, 100);
+            red = 100;
+            green = 100;
+            blue = 100;
             break;
         default:
             break;
@@ -129,100 +159,354 @@ namespace hal
                 .step_mode = NRF_PWM_STEP_AUTO,
             };
 
-        nrfx_pwm_init(&m_pwm_driver, &CONFIG, nullptr);
+        // Both buffers start as black frames, the trailing low value never changes
+        for (uint8_t buffer = 0; buffer < 2; buffer++)
+        {
+            for (uint16_t bit = 0; bit < LEDS_SEQUENCE_LENGTH_TOTAL; bit++)
+            {
+                s_frames[buffer][bit] = LEDS_CODED_ZERO;
+            }
+            s_frames[buffer][LEDS_SEQUENCE_LENGTH_TOTAL] = LEDS_CODED_RESET;
+        }
+
+        nrfx_pwm_init(&m_pwm_driver, &CONFIG, PwmHandler);
     }
 
     void Leds::UnInit(void)
     {
-        // Turn off all LEDs
+        // Turn off all LEDs, and let the engine latch the black frame before releasing the PWM
         TurnLedOff(&rgb_led);
+        while (s_is_playing)
+        {
+            vTaskDelay(pdMS_TO_TICKS(LEDS_FRAME_PERIOD_MS));
+        }
         nrfx_pwm_uninit(&m_pwm_driver);
     }
 
-    void Leds::ConfigureLedColor(RgbLed_t *led, LedPosition_e position, uint8_t red, uint8_t green, uint8_t blue)
+    void Leds::ConfigureLedColor(RgbLed_t *led, LedPosition_e position, uint8_t red, uint8_t green, uint8_t blue, LedPriority_e priority)
     {
-        // Casting from enum to uint8_t for intensity calculation
-        float scaling_factor = static_cast<float>(static_cast<uint8_t>(led->intensity)) / 100.0f;
-        
-        // Explicit and correct casting from enum to uint8_t
-        uint8_t s_position = static_cast<uint8_t>(position);
-        
-        // Ensure values are in correct range with proper casting
-        uint8_t scaled_red = static_cast<uint8_t>(red * scaling_factor);
-        uint8_t scaled_green = static_cast<uint8_t>(green * scaling_factor);
-        uint8_t scaled_blue = static_cast<uint8_t>(blue * scaling_factor);
+        LedPattern_e pattern = ((red | green | blue) != 0) ? LedPattern_e::SOLID : LedPattern_e::OFF;
+        uint16_t intensity = static_cast<uint16_t>(led->intensity);
+
+        // The bits are encoded by the frame engine, only when the color of a frame changes
+        SetSlot(position,
+                pattern,
+                static_cast<uint8_t>((red * intensity) / 100),
+                static_cast<uint8_t>((green * intensity) / 100),
+                static_cast<uint8_t>((blue * intensity) / 100),
+                0,
+                priority);
+    }
 
-        // Encode each color bit as PWM sequence
-        for (uint8_t j = 0; j < 8; j++)
+    void Leds::Show(void)
+    {
+        taskENTER_CRITICAL();
+        s_is_back_stale = true;
+        if (!s_is_playing)
         {
-            s_sequence[s_position * LEDS_SEQUENCE_LENGTH_PER_LED + j] = ((scaled_green << j) & 0x80) ? LEDS_CODED_ONE : LEDS_CODED_ZERO;       // green
-            s_sequence[s_position * LEDS_SEQUENCE_LENGTH_PER_LED + (j + 8)] = ((scaled_red << j) & 0x80) ? LEDS_CODED_ONE : LEDS_CODED_ZERO;   // red
-            s_sequence[s_position * LEDS_SEQUENCE_LENGTH_PER_LED + (j + 16)] = ((scaled_blue << j) & 0x80) ? LEDS_CODED_ONE : LEDS_CODED_ZERO; // blue
+            StartPlayback();
         }
+        taskEXIT_CRITICAL();
     }
 
-    void Leds::Show(void)
+    void Leds::Clear(RgbLed_t *led)
     {
-        nrf_pwm_sequence_t sequence = {};
+        // Turn off all LEDs by setting all colors to zero, whatever shows on them
+        ConfigureLedColor(led, LedPosition_e::LED1, 0, 0, 0, LedPriority_e::GUIDANCE);
+        ConfigureLedColor(led, LedPosition_e::LED2, 0, 0, 0, LedPriority_e::GUIDANCE);
+        ConfigureLedColor(led, LedPosition_e::LED3, 0, 0, 0, LedPriority_e::GUIDANCE);
+    }
 
-        sequence.values.p_common = s_sequence;
-        sequence.length = LEDS_SEQUENCE_LENGTH_TOTAL;
-        sequence.repeats = 0;
-        sequence.end_delay = 0;
+    void Leds::ClearPosition(RgbLed_t *led, LedPosition_e position, LedPriority_e priority)
+    {
+        ConfigureLedColor(led, position, 0, 0, 0, priority);
+    }
+
+    void Leds::TestLeds()
+    {
+        // Played by the frame engine, the LEDs are turned off at the end of the test
+        taskENTER_CRITICAL();
+        s_is_testing = true;
+        s_test_start_frame = s_frame_count;
+        taskEXIT_CRITICAL();
+
+        Show();
+    }
+
+    void Leds::PlaySolid(LedPosition_e position, LedColor_e color, LedIntensity_e intensity)
+    {
+        SetPattern(position, LedPattern_e::SOLID, color, 0, intensity);
+    }
+
+    void Leds::PlayBlink(LedPosition_e position, LedColor_e color, uint16_t period_ms, LedIntensity_e intensity)
+    {
+        SetPattern(position, LedPattern_e::BLINK, color, period_ms, intensity);
+    }
+
+    void Leds::PlayBreathe(LedPosition_e position, LedColor_e color, uint16_t period_ms, LedIntensity_e intensity)
+    {
+        SetPattern(position, LedPattern_e::BREATHE, color, period_ms, intensity);
+    }
 
-        // Ensure PWM is stopped before starting new sequence
-        while (!nrfx_pwm_is_stopped(&m_pwm_driver))
+    void Leds::StopPattern(LedPosition_e position)
+    {
+        SetSlot(position, LedPattern_e::OFF, 0, 0, 0, 0);
+    }
+
+    void Leds::PlayProgress(LedColor_e color, uint8_t percent, LedIntensity_e intensity)
+    {
+        uint8_t red;
+        uint8_t green;
+        uint8_t blue;
+
+        GetColorComponents(color, red, green, blue);
+
+        if (percent > 100)
         {
-            nrfx_pwm_stop(&m_pwm_driver, true);
+            percent = 100;
+        }
+
+        // Percent of the strip lit, in 1/100 of an LED
+        uint16_t lit = static_cast<uint16_t>(percent) * LEDS_ARRAY_QTY;
+
+        for (uint8_t position = 0; position < LEDS_ARRAY_QTY; position++)
+        {
+            uint16_t fill = (lit >= 100) ? 100 : lit;
+            uint16_t scale = (fill * static_cast<uint16_t>(intensity)) / 100;
+
+            lit = (lit >= 100) ? (lit - 100) : 0;
+
+            SetSlot(static_cast<LedPosition_e>(position),
+                    (scale != 0) ? LedPattern_e::SOLID : LedPattern_e::OFF,
+                    static_cast<uint8_t>((red * scale) / 100),
+                    static_cast<uint8_t>((green * scale) / 100),
+                    static_cast<uint8_t>((blue * scale) / 100),
+                    0);
         }
-        nrfx_pwm_simple_playback(&m_pwm_driver, &sequence, 1, NRFX_PWM_FLAG_STOP);
-        // This delay is necessary to ensure that the PWM information reaches the last LED in the chain.
-        // The data transmission time is approximately 1.25 microseconds.
-        // Considering the number of LEDs and the bit data for each color, we require about 75 microseconds.
-        nrf_delay_us(75);
     }
 
-    void Leds::Clear(RgbLed_t *led)
+    void Leds::SetPattern(LedPosition_e position, LedPattern_e pattern, LedColor_e color, uint16_t period_ms, LedIntensity_e intensity)
     {
-        // Turn off all LEDs by setting all colors to zero
-        ConfigureLedColor(led, LedPosition_e::LED1, 0, 0, 0);
-        ConfigureLedColor(led, LedPosition_e::LED2, 0, 0, 0);
-        ConfigureLedColor(led, LedPosition_e::LED3, 0, 0, 0);
+        uint8_t red;
+        uint8_t green;
+        uint8_t blue;
+        uint16_t scale = static_cast<uint16_t>(intensity);
+
+        GetColorComponents(color, red, green, blue);
+
+        SetSlot(position,
+                pattern,
+                static_cast<uint8_t>((red * scale) / 100),
+                static_cast<uint8_t>((green * scale) / 100),
+                static_cast<uint8_t>((blue * scale) / 100),
+                period_ms);
     }
 
-    void Leds::ClearPosition(RgbLed_t *led, LedPosition_e position)
+    void Leds::SetSlot(LedPosition_e position, LedPattern_e pattern, uint8_t red, uint8_t green, uint8_t blue, uint16_t period_ms,
+                       LedPriority_e priority)
     {
-        ConfigureLedColor(led, position, 0, 0, 0);
+        uint8_t index = static_cast<uint8_t>(position);
+
+        if (index >= LEDS_ARRAY_QTY)
+        {
+            return;
+        }
+
+        // A blink or breathe pattern without period is shown solid
+        if (((pattern == LedPattern_e::BLINK) || (pattern == LedPattern_e::BREATHE)) && (period_ms < 2 * LEDS_FRAME_PERIOD_MS))
+        {
+            pattern = LedPattern_e::SOLID;
+        }
+
+        taskENTER_CRITICAL();
+        LedSlot_t &slot = s_slots[index];
+
+        if (priority < slot.priority)
+        {
+            taskEXIT_CRITICAL();
+            return;
+        }
+
+        slot.pattern = pattern;
+        slot.red = red;
+        slot.green = green;
+        slot.blue = blue;
+        slot.period_ms = period_ms;
+        slot.start_frame = s_frame_count;
+        slot.priority = (pattern == LedPattern_e::OFF) ? LedPriority_e::INDICATION : priority;
+        s_is_back_stale = true;
+
+        if (!s_is_playing)
+        {
+            StartPlayback();
+        }
+        taskEXIT_CRITICAL();
     }
 
-    void Leds::TestLeds()
+    void Leds::StartPlayback(void)
+    {
+        s_is_playing = true;
+        s_is_back_stale = false;
+
+        RenderFrame(s_front, s_frame_count);
+        PlayFrame(s_front);
+        RenderFrame(s_front ^ 1, s_frame_count + 1);
+    }
+
+    void Leds::PlayFrame(uint8_t buffer)
+    {
+        nrf_pwm_sequence_t sequence = {};
+
+        sequence.values.p_common = s_frames[buffer];
+        sequence.length = LEDS_FRAME_LENGTH;
+        sequence.repeats = 0;
+        sequence.end_delay = LEDS_FRAME_END_DELAY_TICKS;
+
+        // The STOPPED event, at the end of the frame delay, is the frame clock
+        nrfx_pwm_simple_playback(&m_pwm_driver, &sequence, 1, NRFX_PWM_FLAG_STOP | NRFX_PWM_FLAG_NO_EVT_FINISHED);
+    }
+
+    void Leds::PwmHandler(nrfx_pwm_evt_type_t event_type)
     {
-        // Array of colors to test
-        LedColor_e colors[] = {
-            LedColor_e::RED,
-            LedColor_e::GREEN,
-            LedColor_e::BLUE,
-            LedColor_e::YELLOW,
-            LedColor_e::CYAN,
-            LedColor_e::MAGENTA,
-            LedColor_e::WHITE,
-        };
-
-        // Test all LEDs
-        for (int led_position = static_cast<int>(LedPosition_e::LED1);
-             led_position <= static_cast<int>(LedPosition_e::LED3);
-             led_position++)
+        if (event_type != NRFX_PWM_EVT_STOPPED)
+        {
+            return;
+        }
+
+        Leds &leds = GetInstance();
+        uint8_t back = s_front ^ 1;
+
+        s_frame_count++;
+
+        if (s_is_back_stale)
+        {
+            s_is_back_stale = false;
+            leds.RenderFrame(back, s_frame_count);
+        }
+
+        // Nothing moves and the LEDs already latched this frame, let the PWM rest
+        if (!leds.IsAnimated() &&
+            (memcmp(s_frame_colors[back], s_frame_colors[s_front], sizeof(s_frame_colors[back])) == 0))
+        {
+            s_is_playing = false;
+            return;
+        }
+
+        s_front = back;
+        leds.PlayFrame(s_front);
+
+        // Rendered while the frame plays, ready for the next STOPPED event
+        leds.RenderFrame(s_front ^ 1, s_frame_count + 1);
+    }
+
+    bool Leds::IsAnimated(void) const
+    {
+        if (s_is_testing)
+        {
+            return true;
+        }
+
+        for (uint8_t position = 0; position < LEDS_ARRAY_QTY; position++)
         {
-            for (LedColor_e color : colors)
+            if ((s_slots[position].pattern == LedPattern_e::BLINK) || (s_slots[position].pattern == LedPattern_e::BREATHE))
             {
-                SetLedColor(&rgb_led, static_cast<LedPosition_e>(led_position), color);
-                TurnLedOn(&rgb_led);
-                nrf_delay_ms(250); // 250 milliseconds to see the color
+                return true;
             }
         }
 
-        // Turn off all LEDs
-        TurnLedOff(&rgb_led);
+        return false;
+    }
+
+    void Leds::RenderFrame(uint8_t buffer, uint32_t frame)
+    {
+        if (s_is_testing)
+        {
+            uint32_t step = ((frame - s_test_start_frame) * LEDS_FRAME_PERIOD_MS) / TEST_STEP_MS;
+
+            if (step >= static_cast<uint32_t>(LEDS_ARRAY_QTY) * COLORS_QTY)
+            {
+                // Test over, all LEDs off
+                s_is_testing = false;
+                for (uint8_t position = 0; position < LEDS_ARRAY_QTY; position++)
+                {
+                    s_slots[position].pattern = LedPattern_e::OFF;
+                    s_slots[position].priority = LedPriority_e::INDICATION;
+                }
+            }
+            else
+            {
+                // Each LED keeps the last test color once its turn is over
+                for (uint8_t position = 0; position < LEDS_ARRAY_QTY; position++)
+                {
+                    uint32_t position_step = step - (position * COLORS_QTY);
+                    LedColor_e color = (step < position * COLORS_QTY) ? LedColor_e::WHITE : static_cast<LedColor_e>((position_step < COLORS_QTY) ? position_step : (COLORS_QTY - 1));
+                    LedSlot_t &slot = s_slots[position];
+
+                    slot.pattern = (step < position * COLORS_QTY) ? LedPattern_e::OFF : LedPattern_e::SOLID;
+                    GetColorComponents(color, slot.red, slot.green, slot.blue);
+                }
+            }
+        }
+
+        for (uint8_t position = 0; position < LEDS_ARRAY_QTY; position++)
+        {
+            uint8_t grb[3];
+
+            RenderSlot(position, frame, grb);
+
+            // Only the LEDs whose color changed are encoded again
+            if (memcmp(grb, s_frame_colors[buffer][position], sizeof(grb)) != 0)
+            {
+                nrf_pwm_values_common_t *p_bits = &s_frames[buffer][position * LEDS_SEQUENCE_LENGTH_PER_LED];
+
+                EncodeByte(&p_bits[0], grb[0]);
+                EncodeByte(&p_bits[8], grb[1]);
+                EncodeByte(&p_bits[16], grb[2]);
+                memcpy(s_frame_colors[buffer][position], grb, sizeof(grb));
+            }
+        }
+    }
+
+    void Leds::RenderSlot(uint8_t position, uint32_t frame, uint8_t *grb)
+    {
+        const LedSlot_t &slot = s_slots[position];
+        uint16_t level = 0; // Brightness from 0 to 256
+
+        switch (slot.pattern)
+        {
+        case LedPattern_e::SOLID:
+            level = 256;
+            break;
+        case LedPattern_e::BLINK:
+        {
+            uint32_t phase = ((frame - slot.start_frame) * LEDS_FRAME_PERIOD_MS) % slot.period_ms;
+            level = (phase < slot.period_ms / 2) ? 256 : 0;
+            break;
+        }
+        case LedPattern_e::BREATHE:
+        {
+            uint32_t phase = ((frame - slot.start_frame) * LEDS_FRAME_PERIOD_MS) % slot.period_ms;
+            uint32_t half = slot.period_ms / 2;
+            level = static_cast<uint16_t>(((phase < half) ? phase : (slot.period_ms - phase)) * 256 / half);
+            break;
+        }
+        default:
+            break;
+        }
+
+        // WS2812 order is green, red, blue
+        grb[0] = static_cast<uint8_t>((slot.green * level) >> 8);
+        grb[1] = static_cast<uint8_t>((slot.red * level) >> 8);
+        grb[2] = static_cast<uint8_t>((slot.blue * level) >> 8);
+    }
+
+    void Leds::EncodeByte(nrf_pwm_values_common_t *p_bits, uint8_t value)
+    {
+        // Most significant bit first
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            p_bits[bit] = ((value << bit) & 0x80) ? LEDS_CODED_ONE : LEDS_CODED_ZERO;
+        }
     }
 
     void Leds::LedScanOn(bool enable)
@@ -230,12 +514,10 @@ namespace hal
         rgb_led.intensity = LedIntensity_e::HIGH;
 
         if (enable) {
-            SetLedColor(&rgb_led, LedPosition_e::LED1, LedColor_e::BLUE);
+            PlayBreathe(LedPosition_e::LED1, LedColor_e::BLUE, SCAN_BREATHE_PERIOD_MS);
         } else {
-            ClearPosition(&rgb_led, LedPosition_e::LED1);
+            StopPattern(LedPosition_e::LED1);
         }
-
-        TurnLedOn(&rgb_led); // hoy solo hace Show()
     }
 
     void Leds::LedCharging(bool enable)
@@ -275,6 +557,26 @@ namespace hal
         }
 
         TurnLedOn(&rgb_led);
-        nrf_delay_us(100);
+    }
+
+    void Leds::LedAlignment(bool enable, uint8_t score)
+    {
+        rgb_led.intensity = LedIntensity_e::HIGH;
+
+        if (enable) {
+            if (score > 100) {
+                score = 100;
+            }
+
+            // Red to yellow over the lower half, yellow to green over the upper half
+            uint8_t red = (score < 50) ? 100 : static_cast<uint8_t>((100 - score) * 2);
+            uint8_t green = (score < 50) ? static_cast<uint8_t>(score * 2) : 100;
+
+            ConfigureLedColor(&rgb_led, LedPosition_e::LED3, red, green, 0, LedPriority_e::GUIDANCE);
+        } else {
+            ClearPosition(&rgb_led, LedPosition_e::LED3, LedPriority_e::GUIDANCE);
+        }
+
+        TurnLedOn(&rgb_led);
     }
 }
\ No newline at end of file
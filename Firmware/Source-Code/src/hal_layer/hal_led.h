@@ -26,6 +26,13 @@
 
 #define LEDS_CODED_ONE ((uint16_t)(LEDS_ONE_HIGH_TICKS | 0x8000))   /**< PWM Duty cycle for coding a 1 */
 #define LEDS_CODED_ZERO ((uint16_t)(LEDS_ZERO_HIGH_TICKS | 0x8000)) /**< PWM Duty cycle for coding a 0 */
+#define LEDS_CODED_RESET ((uint16_t)0x8000)                         /**< PWM Duty cycle keeping the line low */
+
+/**<  A frame ends with a low value, held by the sequence end delay until the next frame. */
+/**<  The delay is the WS2812 reset (latch) time and sets the animation frame rate. */
+#define LEDS_FRAME_LENGTH (LEDS_SEQUENCE_LENGTH_TOTAL + 1)          /**< Bits of all LEDs and the trailing low value */
+#define LEDS_FRAME_PERIOD_MS 20                                     /**< 20 ms per frame, 50 frames per second */
+#define LEDS_FRAME_END_DELAY_TICKS (LEDS_FRAME_PERIOD_MS * 800)     /**< End delay in PWM periods, 800 periods of 1.25us per ms */
 
 namespace hal
 {
@@ -61,6 +68,37 @@ namespace hal
         HIGH = 100,
     };
 
+    enum class LedPattern_e : uint8_t
+    {
+        OFF,
+        SOLID,
+        BLINK,   // On for the first half of the period
+        BREATHE, // Brightness ramping up and down over the period
+    };
+
+    /**
+     * @brief Owner of an LED of the chain, a pattern of lower priority does not replace a shown one
+     */
+    enum class LedPriority_e : uint8_t
+    {
+        INDICATION, // Charger state colors
+        GUIDANCE,   // Coil alignment guidance
+    };
+
+    /**
+     * @brief Pattern played on one LED, colors already scaled by the intensity
+     */
+    typedef struct
+    {
+        LedPattern_e pattern;
+        uint8_t red;
+        uint8_t green;
+        uint8_t blue;
+        uint16_t period_ms;
+        uint32_t start_frame;
+        LedPriority_e priority; // Priority of the pattern, INDICATION once the LED is off
+    } LedSlot_t;
+
     typedef struct
     {
         LedColor_e color;
@@ -97,9 +135,22 @@ namespace hal
         // Battery charged
         void LedCharged(bool enable);
 
-        // Test LEDs
+        // Coil alignment guidance, score from 0 (red) to 100 (green). Shown over the state colors
+        // until it is disabled.
+        void LedAlignment(bool enable, uint8_t score);
+
+        // Test LEDs, every color on each LED in turn for 250 ms
         void TestLeds();
 
+        // Patterns, played from the PWM interrupt without blocking the caller
+        void PlaySolid(LedPosition_e position, LedColor_e color, LedIntensity_e intensity = LedIntensity_e::HIGH);
+        void PlayBlink(LedPosition_e position, LedColor_e color, uint16_t period_ms, LedIntensity_e intensity = LedIntensity_e::HIGH);
+        void PlayBreathe(LedPosition_e position, LedColor_e color, uint16_t period_ms, LedIntensity_e intensity = LedIntensity_e::HIGH);
+        void StopPattern(LedPosition_e position);
+
+        // Progress bar over the LED strip, percent from 0 to 100, the last LED lit dims with the remainder
+        void PlayProgress(LedColor_e color, uint8_t percent, LedIntensity_e intensity = LedIntensity_e::HIGH);
+
         // Public member
         RgbLed_t rgb_led;
 
@@ -111,17 +162,53 @@ namespace hal
         Leds(const Leds&) = delete;
         Leds& operator=(const Leds&) = delete;
 
+        static constexpr uint16_t TEST_STEP_MS = 250;
+        static constexpr uint16_t SCAN_BREATHE_PERIOD_MS = 2000;
+        static constexpr uint8_t COLORS_QTY = 7;
+
         void Init(void);
         void UnInit(void);
-        void ConfigureLedColor(RgbLed_t *led, LedPosition_e position, uint8_t red, uint8_t green, uint8_t blue);
+        void ConfigureLedColor(RgbLed_t *led, LedPosition_e position, uint8_t red, uint8_t green, uint8_t blue, LedPriority_e priority = LedPriority_e::INDICATION);
         void Show(void);
         void Clear(RgbLed_t *led);
-        void ClearPosition(RgbLed_t *led, LedPosition_e position);
+        void ClearPosition(RgbLed_t *led, LedPosition_e position, LedPriority_e priority = LedPriority_e::INDICATION);
+
+        // Sets the pattern of an LED and starts the playback if it is stopped
+        void SetPattern(LedPosition_e position, LedPattern_e pattern, LedColor_e color, uint16_t period_ms, LedIntensity_e intensity);
+        // A pattern of lower priority than the one shown is dropped
+        void SetSlot(LedPosition_e position, LedPattern_e pattern, uint8_t red, uint8_t green, uint8_t blue, uint16_t period_ms,
+                     LedPriority_e priority = LedPriority_e::INDICATION);
+
+        // Color components of a named color, from 0 to 100
+        static void GetColorComponents(LedColor_e color, uint8_t &red, uint8_t &green, uint8_t &blue);
+
+        // Frame engine, the caller must mask the PWM interrupt or run in it
+        void StartPlayback(void);
+        void PlayFrame(uint8_t buffer);
+        void RenderFrame(uint8_t buffer, uint32_t frame);
+        void RenderSlot(uint8_t position, uint32_t frame, uint8_t *grb);
+        bool IsAnimated(void) const;
+        static void EncodeByte(nrf_pwm_values_common_t *p_bits, uint8_t value);
+
+        // PWM interrupt, the STOPPED event ends each frame
+        static void PwmHandler(nrfx_pwm_evt_type_t event_type);
 
     protected:
         nrfx_pwm_t m_pwm_driver;
-        static nrf_pwm_values_common_t s_sequence[LEDS_SEQUENCE_LENGTH_TOTAL];
-        
+
+        // Double buffered frames, the PWM plays one while the next is rendered in the other
+        static nrf_pwm_values_common_t s_frames[2][LEDS_FRAME_LENGTH];
+        static uint8_t s_frame_colors[2][LEDS_ARRAY_QTY][3]; // GRB values encoded in each frame buffer
+
+        static LedSlot_t s_slots[LEDS_ARRAY_QTY];
+
+        static uint8_t s_front;              // Buffer being played
+        static uint32_t s_frame_count;       // Frames played, the animation time base
+        static bool s_is_back_stale;         // Slots changed after the back buffer was rendered
+        static volatile bool s_is_playing;
+        static bool s_is_testing;
+        static uint32_t s_test_start_frame;
+
         static Leds s_instance;
         static bool s_initialized;
     };
@@ -10,25 +10,30 @@
 #ifndef HAL_RINGBUFFER_H
 #define HAL_RINGBUFFER_H
 
-#include "nrf_ringbuf.h"
-
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 
 namespace hal
 {
 
-    /// Ring buffer wrapper which provides a way to share data.
-    template <typename Item>
+    /// Lock-free single producer, single consumer ring of items.
+    ///
+    /// One context puts, the other gets: typically an interrupt and a task. The indexes are
+    /// free running and each one is written by a single side, so no critical section is needed
+    /// on Cortex-M4. Items can be built and read in place with Reserve/Commit and Peek/Release,
+    /// or copied with Put and Get.
+    ///
+    /// @tparam Item Type of the items
+    /// @tparam Capacity Maximum number of items, it must be a power of two
+    template <typename Item, size_t Capacity>
     class RingBuffer
     {
     public:
-        /// Maximum number of bytes that can be stored.
-        ///
-        /// It must be a power of two.
-        static constexpr size_t BUFFER_LENGTH = 512;
+        static_assert((Capacity > 0) && ((Capacity & (Capacity - 1)) == 0), "Ring buffer capacity must be a power of two");
 
         /// Maximum number of items that can be held by the buffer.
-        static constexpr size_t MAX_NUMBER_ITEMS = BUFFER_LENGTH / sizeof(Item);
+        static constexpr size_t MAX_NUMBER_ITEMS = Capacity;
 
         /// Ring buffer error code data type.
         enum class ErrorCode_e : uint8_t
@@ -39,44 +44,127 @@ namespace hal
             FULL,    ///< Full buffer when trying to write an item.
         };
 
-        RingBuffer();
+        RingBuffer() : mItems(), mHead(0), mTail(0)
+        {
+        }
+
+        /// Get the free slot at the head of the buffer, to be filled in place. Producer only.
+        ///
+        /// Until Commit is called the same slot is returned again and the consumer cannot see it.
+        /// @return Free slot, nullptr if the buffer is full.
+        Item *Reserve()
+        {
+            const uint32_t head = mHead.load(std::memory_order_relaxed);
+
+            if ((head - mTail.load(std::memory_order_acquire)) >= Capacity)
+            {
+                return nullptr;
+            }
+
+            return &mItems[head & (Capacity - 1)];
+        }
 
-        /// Read an item from the buffer.
+        /// Publish the slot returned by Reserve. Producer only.
+        void Commit()
+        {
+            // The item must be written before the consumer sees the new head
+            mHead.store(mHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        /// Get the oldest item without removing it. Consumer only.
+        ///
+        /// The item stays valid until Release is called.
+        /// @return Oldest item, nullptr if the buffer is empty.
+        Item *Peek()
+        {
+            const uint32_t tail = mTail.load(std::memory_order_relaxed);
+
+            if (mHead.load(std::memory_order_acquire) == tail)
+            {
+                return nullptr;
+            }
+
+            return &mItems[tail & (Capacity - 1)];
+        }
+
+        /// Remove the item returned by Peek. Consumer only.
+        void Release()
+        {
+            // The item must be read before the producer can reuse its slot
+            mTail.store(mTail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        /// Read an item from the buffer. Consumer only.
         /// @param item Read item.
         /// @return `SUCCESS` if the operation was successful.
-        /// @return `FAIL` if the operation failed.
-        ErrorCode_e Get(Item &item);
+        /// @return `EMPTY` if there is no item to read.
+        ErrorCode_e Get(Item &item)
+        {
+            Item *p_item = Peek();
+
+            if (p_item == nullptr)
+            {
+                return ErrorCode_e::EMPTY;
+            }
+
+            item = *p_item;
+            Release();
 
-        /// Write an item to the buffer.
+            return ErrorCode_e::SUCCESS;
+        }
+
+        /// Write an item to the buffer. Producer only.
         /// @param item Item to write into the buffer.
         /// @return `SUCCESS` if the operation was successful.
-        /// @return `FAIL` if the operation failed.
-        ErrorCode_e Put(const Item &item);
+        /// @return `FULL` if there is no space left.
+        ErrorCode_e Put(const Item &item)
+        {
+            Item *p_item = Reserve();
+
+            if (p_item == nullptr)
+            {
+                return ErrorCode_e::FULL;
+            }
+
+            *p_item = item;
+            Commit();
+
+            return ErrorCode_e::SUCCESS;
+        }
 
         /// Return whether there are any items in the buffer.
         /// @return `true` if the buffer is empty.
         /// @return `false` if there is at least one item in the buffer.
-        bool IsEmpty() const;
+        bool IsEmpty() const
+        {
+            return GetItemCount() == 0;
+        }
 
         /// Return whether there is space left in the buffer.
         /// @return `true` if the buffer is full.
         /// @return `false` if there is space for at least one item in the buffer.
-        bool IsFull() const;
+        bool IsFull() const
+        {
+            return GetItemCount() >= Capacity;
+        }
 
         /// Return the number of items currently stored in the buffer.
+        ///
+        /// Seen from the other side the count can be outdated by the time it is used.
         /// @return Number of items in the buffer.
-        size_t GetItemCount() const;
+        size_t GetItemCount() const
+        {
+            return mHead.load(std::memory_order_acquire) - mTail.load(std::memory_order_acquire);
+        }
 
     private:
-        uint8_t mBuffer[BUFFER_LENGTH];
-        nrf_ringbuf_cb_t mControlBlock;
-        const nrf_ringbuf_t mRingBuffer =
-            {
-                .p_buffer = mBuffer,
-                .bufsize_mask = BUFFER_LENGTH - 1,
-                .p_cb = &mControlBlock};
+        // uint32_t is an unsigned long with the ARM toolchain and an unsigned int on most hosts
+        static_assert((ATOMIC_INT_LOCK_FREE == 2) && (ATOMIC_LONG_LOCK_FREE == 2), "Ring buffer indexes must be lock-free");
+
+        Item mItems[Capacity];
 
-        size_t mItemCount = 0;
+        std::atomic<uint32_t> mHead; ///< Written by the producer only.
+        std::atomic<uint32_t> mTail; ///< Written by the consumer only.
     };
 
 }
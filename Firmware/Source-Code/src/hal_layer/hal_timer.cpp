@@ -61,6 +61,11 @@ namespace hal
         return &mDriverInstance;
     }
 
+    uint32_t Timer::GetCompareEventAddress()
+    {
+        return nrf_drv_timer_compare_event_address_get(&mDriverInstance, NRF_TIMER_CC_CHANNEL0);
+    }
+
     void Timer::DriverCallback(nrf_timer_event_t eventType, void *context)
     {
         if (eventType != NRF_TIMER_EVENT_COMPARE0)
@@ -100,7 +105,7 @@ namespace hal
                                        NRF_TIMER_CC_CHANNEL0,
                                        timeIntervalTicks,
                                        shortMask,
-                                       true);
+                                       mEventHandler != nullptr);
     }
 
     uint32_t Timer::Timer128NsToTicks(uint32_t timer_ns) const
@@ -106,6 +106,12 @@ public:
 
     nrf_drv_timer_t* GetInstance();
 
+    /// Address of the compare event, to be connected to a task through PPI.
+    ///
+    /// @note When the timer is created without event handler its interrupt is not enabled,
+    /// so the compare event only drives PPI and never wakes up the CPU.
+    uint32_t GetCompareEventAddress();
+
 private:
     static void DriverCallback(nrf_timer_event_t eventType, void* context);
 
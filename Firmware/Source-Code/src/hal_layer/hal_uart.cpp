@@ -9,13 +9,32 @@
 
 #include "hal_uart.h"
 
-#include "nrf_drv_uart.h"
+#include "nrf_drv_ppi.h"
+#include "nrfx_uarte.h"
 #include "sdk_errors.h"
 
+#include "FreeRTOS.h"
+#include "task.h"
+
 namespace hal
 {
+    static_assert(Uart::MAX_PACKET_LENGTH <= 254, "A frame longer than 254 bytes needs more than one COBS code byte");
 
-    Uart::Uart(Config_t config) : mConfig(config)
+    Uart::Uart(Config_t config)
+        : mRxPacket(nullptr),
+          mRxCode(0),
+          mRxCodeRemaining(0),
+          mIsRxPacketDropped(false),
+          mDroppedFrameCount(0),
+          mTxQueue(),
+          mTxQueueHead(0),
+          mTxQueueCount(0),
+          mTxFrame(nullptr),
+          mConfig(config),
+          mIdleTimer({.period = GetIdleTimeNs(config.baudrate),
+                      .autostart = false,
+                      .timerNumber = Timer::PeripheralNumber::UART_IDLE_TIMER},
+                     IdleTimerCallback, this)
     {
     }
 
@@ -34,6 +53,12 @@ namespace hal
             return ErrorCode_e::FAIL;
         }
 
+        errCode = InitIdleDetection();
+        if (errCode != NRF_SUCCESS)
+        {
+            return ErrorCode_e::FAIL;
+        }
+
         errCode = StartReceiving();
         if (errCode != NRF_SUCCESS)
         {
@@ -43,19 +68,21 @@ namespace hal
         return ErrorCode_e::SUCCESS;
     }
 
-    void Uart::UnInit() const
+    void Uart::UnInit()
     {
-        nrf_drv_uart_uninit(&mDriverInstance);
+        nrf_drv_ppi_channel_disable(mIdlePpiChannel);
+        nrf_drv_ppi_channel_free(mIdlePpiChannel);
+        mIdleTimer.UnInit();
+        nrfx_uarte_uninit(&mDriverInstance);
     }
 
     Uart::ErrorCode_e Uart::Read(Packet_t &packet)
     {
-        if (mRxPacketBuffer.IsEmpty())
+        PacketBuffer::ErrorCode_e errCode = mRxPacketBuffer.Get(packet);
+        if (errCode == PacketBuffer::ErrorCode_e::EMPTY)
         {
             return ErrorCode_e::EMPTY_BUFFER;
         }
-
-        PacketBuffer::ErrorCode_e errCode = mRxPacketBuffer.Get(packet);
         if (errCode != PacketBuffer::ErrorCode_e::SUCCESS)
         {
             return ErrorCode_e::FAIL;
@@ -63,44 +90,115 @@ namespace hal
         return ErrorCode_e::SUCCESS;
     }
 
-    Uart::ErrorCode_e Uart::Write(const Packet_t &packet)
+    const Uart::Packet_t *Uart::PeekPacket()
+    {
+        return mRxPacketBuffer.Peek();
+    }
+
+    void Uart::ReleasePacket()
+    {
+        mRxPacketBuffer.Release();
+    }
+
+    Uart::ErrorCode_e Uart::Write(TxFrame_t &frame)
     {
-        if (packet.length == 0)
+        if ((frame.length == 0) || (frame.length > MAX_PACKET_LENGTH))
         {
             return ErrorCode_e::EMPTY_PACKET;
         }
 
-        if (mTxPacketBuffer.IsFull())
+        if (frame.isPending)
+        {
+            return ErrorCode_e::BUSY;
+        }
+
+        if (mTxQueueCount >= TX_QUEUE_LENGTH)
         {
             return ErrorCode_e::FULL_BUFFER;
         }
 
-        PacketBuffer::ErrorCode_e errCode = mTxPacketBuffer.Put(packet);
-        if (errCode != PacketBuffer::ErrorCode_e::SUCCESS)
+        ErrorCode_e result = ErrorCode_e::SUCCESS;
+
+        taskENTER_CRITICAL();
+        if (mTxQueueCount < TX_QUEUE_LENGTH)
         {
-            return ErrorCode_e::FAIL;
+            // Encoded only once a slot is sure, the interrupt just hands the buffer to EasyDMA
+            EncodeFrame(frame);
+
+            frame.isPending = true;
+            mTxQueue[(mTxQueueHead + mTxQueueCount) % TX_QUEUE_LENGTH] = &frame;
+            mTxQueueCount++;
+
+            if (mTxFrame == nullptr)
+            {
+                StartTransmitting();
+            }
         }
+        else
+        {
+            result = ErrorCode_e::FULL_BUFFER;
+        }
+        taskEXIT_CRITICAL();
 
-        StartTransmitting();
+        return result;
+    }
 
-        return ErrorCode_e::SUCCESS;
+    uint32_t Uart::GetDroppedFrameCount() const
+    {
+        return mDroppedFrameCount;
     }
 
-    void Uart::DriverCallback(nrf_drv_uart_event_t *event, void *context)
+    void Uart::DriverCallback(nrfx_uarte_event_t const *event, void *context)
     {
         auto instance = static_cast<Uart *>(context);
         instance->HandleDriverEvent[event->type](event, instance);
     }
 
+    void Uart::IdleTimerCallback(void const *context)
+    {
+        auto instance = static_cast<Uart *>(const_cast<void *>(context));
+
+        // The transfer ends with an RX_DONE event carrying the bytes received so far
+        nrfx_uarte_rx_abort(&instance->mDriverInstance);
+    }
+
+    uint32_t Uart::GetIdleTimeNs(Baudrate_e baudrate)
+    {
+        uint32_t bitsPerSecond;
+
+        switch (baudrate)
+        {
+        case Baudrate_e::BAUD_1200: bitsPerSecond = 1200; break;
+        case Baudrate_e::BAUD_2400: bitsPerSecond = 2400; break;
+        case Baudrate_e::BAUD_4800: bitsPerSecond = 4800; break;
+        case Baudrate_e::BAUD_9600: bitsPerSecond = 9600; break;
+        case Baudrate_e::BAUD_14400: bitsPerSecond = 14400; break;
+        case Baudrate_e::BAUD_19200: bitsPerSecond = 19200; break;
+        case Baudrate_e::BAUD_28800: bitsPerSecond = 28800; break;
+        case Baudrate_e::BAUD_38400: bitsPerSecond = 38400; break;
+        case Baudrate_e::BAUD_57600: bitsPerSecond = 57600; break;
+        case Baudrate_e::BAUD_76800: bitsPerSecond = 76800; break;
+        case Baudrate_e::BAUD_115200: bitsPerSecond = 115200; break;
+        case Baudrate_e::BAUD_230400: bitsPerSecond = 230400; break;
+        case Baudrate_e::BAUD_250000: bitsPerSecond = 250000; break;
+        case Baudrate_e::BAUD_460800: bitsPerSecond = 460800; break;
+        case Baudrate_e::BAUD_921600: bitsPerSecond = 921600; break;
+        default: bitsPerSecond = 1000000; break;
+        }
+
+        // 10 bits per character: start, 8 data bits, stop
+        return static_cast<uint32_t>((IDLE_CHARACTERS * 10ULL * 1000000000ULL) / bitsPerSecond);
+    }
+
     ret_code_t Uart::InitDriver()
     {
-        nrf_drv_uart_config_t config = NRF_DRV_UART_DEFAULT_CONFIG;
+        nrfx_uarte_config_t config = NRFX_UARTE_DEFAULT_CONFIG;
         config.p_context = static_cast<void *>(this);
-        config.baudrate = static_cast<nrf_uart_baudrate_t>(mConfig.baudrate);
+        config.baudrate = static_cast<nrf_uarte_baudrate_t>(mConfig.baudrate);
         config.pselrxd = mConfig.rxPin;
         config.pseltxd = mConfig.txPin;
 
-        ret_code_t errCode = nrf_drv_uart_init(&mDriverInstance, &config, DriverCallback);
+        ret_code_t errCode = nrfx_uarte_init(&mDriverInstance, &config, DriverCallback);
 #if LOG_ENABLED
         if ((Uart::ErrorCode_e)errCode == Uart::ErrorCode_e::SUCCESS)
         {
@@ -114,69 +212,198 @@ namespace hal
         return errCode;
     }
 
+    ret_code_t Uart::InitIdleDetection()
+    {
+        if (mIdleTimer.Init() != Timer::ErrorCode::SUCCESS)
+        {
+            return NRF_ERROR_INTERNAL;
+        }
+
+        ret_code_t errCode = nrf_drv_ppi_init();
+        if ((errCode != NRF_SUCCESS) && (errCode != NRF_ERROR_MODULE_ALREADY_INITIALIZED))
+        {
+            return errCode;
+        }
+
+        errCode = nrf_drv_ppi_channel_alloc(&mIdlePpiChannel);
+        if (errCode != NRF_SUCCESS)
+        {
+            return errCode;
+        }
+
+        // Every received byte restarts the idle timer from zero, it stops by itself on its compare event
+        nrf_drv_timer_t *timer = mIdleTimer.GetInstance();
+        APP_ERROR_CHECK(nrf_drv_ppi_channel_assign(mIdlePpiChannel,
+                                                   nrfx_uarte_event_address_get(&mDriverInstance, NRF_UARTE_EVENT_RXDRDY),
+                                                   nrf_drv_timer_task_address_get(timer, NRF_TIMER_TASK_CLEAR)));
+        APP_ERROR_CHECK(nrf_drv_ppi_channel_fork_assign(mIdlePpiChannel,
+                                                        nrf_drv_timer_task_address_get(timer, NRF_TIMER_TASK_START)));
+
+        return nrf_drv_ppi_channel_enable(mIdlePpiChannel);
+    }
+
     ret_code_t Uart::StartReceiving()
     {
-        ret_code_t errCode = nrf_drv_uart_rx(&mDriverInstance, mRxPacket.data, 1);
-        return errCode;
+        // The second buffer is taken by EasyDMA as soon as the first one is full, no byte is lost in between
+        ret_code_t errCode = nrfx_uarte_rx(&mDriverInstance, mRxDmaBuffers[0], RX_DMA_BUFFER_LENGTH);
+        if (errCode != NRF_SUCCESS)
+        {
+            return errCode;
+        }
+        return nrfx_uarte_rx(&mDriverInstance, mRxDmaBuffers[1], RX_DMA_BUFFER_LENGTH);
     }
 
     void Uart::StartTransmitting()
     {
-        if (nrf_drv_uart_tx_in_progress(&mDriverInstance))
+        if (mTxQueueCount == 0)
         {
+            mTxFrame = nullptr;
             return;
         }
-        CallDriverCallbackWithTxEvent();
-    }
 
-    void Uart::CallDriverCallbackWithTxEvent()
-    {
-        nrf_drv_uart_event_t event = {.type = NRF_DRV_UART_EVT_TX_DONE};
-        DriverCallback(&event, static_cast<void *>(this));
+        mTxFrame = mTxQueue[mTxQueueHead];
+        mTxQueueHead = (mTxQueueHead + 1) % TX_QUEUE_LENGTH;
+        mTxQueueCount--;
+
+        // Code byte, payload and delimiter in a single transfer
+        if (nrfx_uarte_tx(&mDriverInstance, mTxFrame->buffer, mTxFrame->length + 2) != NRF_SUCCESS)
+        {
+            mTxFrame->isPending = false;
+            mTxFrame = nullptr;
+        }
     }
 
-    void Uart::HandleDriverTxEvent(nrf_drv_uart_event_t *event, Uart *instance)
+    void Uart::EncodeFrame(TxFrame_t &frame)
     {
-        PacketBuffer::ErrorCode_e errCode = instance->mTxPacketBuffer.Get(instance->mTxPacket);
-        if (errCode != PacketBuffer::ErrorCode_e::SUCCESS)
+        uint8_t *p_payload = frame.Payload();
+
+        // Walking backwards, each zero is replaced by the distance to the next zero or to the end
+        uint8_t code = 1;
+        for (uint32_t i = frame.length; i > 0; i--)
         {
-            return;
+            if (p_payload[i - 1] == FRAME_DELIMITER)
+            {
+                p_payload[i - 1] = code;
+                code = 1;
+            }
+            else
+            {
+                code++;
+            }
         }
-        nrf_drv_uart_tx(&instance->mDriverInstance, instance->mTxPacket.data, instance->mTxPacket.length);
+
+        frame.buffer[0] = code;
+        frame.buffer[frame.length + 1] = FRAME_DELIMITER;
     }
 
-    void Uart::HandleDriverRxEvent(nrf_drv_uart_event_t *event, Uart *instance)
+    void Uart::DecodeReceivedBytes(const uint8_t *p_data, size_t length)
     {
-        // Received bytes counter has to be checked, since there could be an
-        // event from RXTO interrupt
-        if (event->data.rxtx.bytes > 0)
+        for (size_t i = 0; i < length; i++)
         {
-            if (*event->data.rxtx.p_data == '\n')
+            const uint8_t byte = p_data[i];
+
+            if (byte == FRAME_DELIMITER)
             {
-                PacketBuffer::ErrorCode_e errCode = instance->mRxPacketBuffer.Put(instance->mRxPacket);
-                LOG_INFO("HAL UART: ABP Serial Message received \n");
-                if (errCode != PacketBuffer::ErrorCode_e::SUCCESS)
+                if (!mIsRxPacketDropped && (mRxCodeRemaining == 0) && (mRxPacket != nullptr) && (mRxPacket->length > 0))
+                {
+                    // The frame was decoded in its slot, publishing it copies nothing
+                    mRxPacketBuffer.Commit();
+                    mRxPacket = nullptr;
+
+                    // execute event handler passed down on construction
+                    mHalRxEventHandler(mHalRxEventHandlerContext);
+                }
+                else if (mIsRxPacketDropped || (mRxCodeRemaining != 0))
                 {
-                    // Handle error when it is not possible to write a packet
-                    // to the Rx buffer. As of now, the packet is discarded.
+                    mDroppedFrameCount++;
                 }
-                // execute event handler passed down on construction
-                instance->mRxPacket.length = 0;
-                instance->mHalRxEventHandler(instance->mHalRxEventHandlerContext);
+
+                if (mRxPacket != nullptr)
+                {
+                    mRxPacket->length = 0;
+                }
+                mRxCode = 0;
+                mRxCodeRemaining = 0;
+                mIsRxPacketDropped = false;
+                continue;
             }
-            else
+
+            if (mIsRxPacketDropped)
+            {
+                // Skipped up to the next delimiter
+                continue;
+            }
+
+            if (mRxPacket == nullptr)
             {
-                // If a buffer overflow were to happen, discard the buffer
-                // content and start overriding it from the start
-                instance->mRxPacket.length = ++instance->mRxPacket.length % MAX_PACKET_LENGTH;
+                mRxPacket = mRxPacketBuffer.Reserve();
+                if (mRxPacket == nullptr)
+                {
+                    // No slot left, the reader is late
+                    mIsRxPacketDropped = true;
+                    continue;
+                }
+                mRxPacket->length = 0;
+            }
 
-                // TODO: Set a corrupt message flag or handle this situation
-                // in another way.
+            if (mRxCodeRemaining == 0)
+            {
+                // A block shorter than 254 bytes stands for a zero, except the last one of the frame
+                if ((mRxCode != 0) && (mRxCode != 0xFF))
+                {
+                    if (mRxPacket->length >= MAX_PACKET_LENGTH)
+                    {
+                        mIsRxPacketDropped = true;
+                        continue;
+                    }
+                    mRxPacket->data[mRxPacket->length++] = 0;
+                }
+                mRxCode = byte;
+                mRxCodeRemaining = byte - 1;
             }
+            else
+            {
+                if (mRxPacket->length >= MAX_PACKET_LENGTH)
+                {
+                    mIsRxPacketDropped = true;
+                    continue;
+                }
+                mRxPacket->data[mRxPacket->length++] = byte;
+                mRxCodeRemaining--;
+            }
+        }
+    }
+
+    void Uart::HandleDriverTxEvent(nrfx_uarte_event_t const *event, Uart *instance)
+    {
+        if (instance->mTxFrame != nullptr)
+        {
+            instance->mTxFrame->isPending = false;
+        }
+        instance->StartTransmitting();
+    }
+
+    void Uart::HandleDriverRxEvent(nrfx_uarte_event_t const *event, Uart *instance)
+    {
+        instance->DecodeReceivedBytes(event->data.rxtx.p_data, event->data.rxtx.bytes);
+
+        if (event->data.rxtx.bytes == RX_DMA_BUFFER_LENGTH)
+        {
+            // EasyDMA moved on to the other buffer, this one becomes the next
+            nrfx_uarte_rx(&instance->mDriverInstance, event->data.rxtx.p_data, RX_DMA_BUFFER_LENGTH);
+        }
+        else
+        {
+            // Transfer stopped by the idle timer, both buffers are free again
+            instance->StartReceiving();
         }
-        nrf_drv_uart_rx(&instance->mDriverInstance, &instance->mRxPacket.data[instance->mRxPacket.length], 1);
     }
 
-    void Uart::HandleDriverErrorEvent(nrf_drv_uart_event_t *event, Uart *instance) {}
+    void Uart::HandleDriverErrorEvent(nrfx_uarte_event_t const *event, Uart *instance)
+    {
+        // The driver drops both buffers on an error, the frame in progress is lost
+        instance->mIsRxPacketDropped = true;
+        instance->StartReceiving();
+    }
 
 }
@@ -11,18 +11,26 @@
 #define HAL_UART_H
 
 #include "hal_ringbuffer.h"
+#include "hal_timer.h"
 #include "../../core_layer/event_driven_architecture/manager/eda_manager.h"
-#include "nrf_drv_uart.h"
+#include "nrf_drv_ppi.h"
+#include "nrfx_uarte.h"
 #include "sdk_errors.h"
 
 #include <cstdint>
 
+#define UART_IDLE_TIMER TIMER_3
+
 namespace hal
 {
 
     typedef void (*HalRxEventHandler_t)(void *);
 
     /// UART class which abstracts away the hardware.
+    ///
+    /// Frames are COBS encoded and end with a zero byte, so binary payloads need no escaping.
+    /// Reception runs on two EasyDMA buffers and takes no interrupt per byte: a buffer is handed
+    /// over when it is full, or when the line has been idle for IDLE_CHARACTERS.
     class Uart
     {
     public:
@@ -32,6 +40,21 @@ namespace hal
         /// Number of possible events for which a callback is needed. ToDo: If greater than 1, a list of handlers needs to be implemented
         static constexpr size_t NUMBER_HAL_EVENTS = 1;
 
+        /// Length of each of the two reception DMA buffers.
+        static constexpr size_t RX_DMA_BUFFER_LENGTH = 64;
+
+        /// Character times without reception after which the received bytes are handed over.
+        static constexpr uint32_t IDLE_CHARACTERS = 3;
+
+        /// Frames waiting to be sent.
+        static constexpr size_t TX_QUEUE_LENGTH = 4;
+
+        /// Received packets waiting to be read, a power of two.
+        static constexpr size_t RX_PACKET_COUNT = 4;
+
+        /// Byte ending a frame, it never appears inside a COBS encoded frame.
+        static constexpr uint8_t FRAME_DELIMITER = 0x00;
+
         /// Packet which holds a UART message.
         struct Packet_t
         {
@@ -39,25 +62,39 @@ namespace hal
             uint32_t length = 0;             ///< Size, in bytes, of the payload.
         };
 
+        /// Frame to be sent, owned by the caller.
+        ///
+        /// The payload is encoded in place and sent straight from this buffer, so the frame must
+        /// stay in RAM and must not be modified while `isPending` is set.
+        struct TxFrame_t
+        {
+            uint8_t buffer[MAX_PACKET_LENGTH + 2]; ///< COBS code byte, payload, delimiter.
+            uint32_t length = 0;                   ///< Size, in bytes, of the payload.
+            volatile bool isPending = false;       ///< Set by Write, cleared once the frame is sent.
+
+            /// Payload area of the frame.
+            uint8_t *Payload() { return &buffer[1]; }
+        };
+
         /// UART baudrate.
         enum class Baudrate_e : uint32_t
         {
-            BAUD_1200 = NRF_UART_BAUDRATE_1200,
-            BAUD_2400 = NRF_UART_BAUDRATE_2400,
-            BAUD_4800 = NRF_UART_BAUDRATE_4800,
-            BAUD_9600 = NRF_UART_BAUDRATE_9600,
-            BAUD_14400 = NRF_UART_BAUDRATE_14400,
-            BAUD_19200 = NRF_UART_BAUDRATE_19200,
-            BAUD_28800 = NRF_UART_BAUDRATE_28800,
-            BAUD_38400 = NRF_UART_BAUDRATE_38400,
-            BAUD_57600 = NRF_UART_BAUDRATE_57600,
-            BAUD_76800 = NRF_UART_BAUDRATE_76800,
-            BAUD_115200 = NRF_UART_BAUDRATE_115200,
-            BAUD_230400 = NRF_UART_BAUDRATE_230400,
-            BAUD_250000 = NRF_UART_BAUDRATE_250000,
-            BAUD_460800 = NRF_UART_BAUDRATE_460800,
-            BAUD_921600 = NRF_UART_BAUDRATE_921600,
-            BAUD_1000000 = NRF_UART_BAUDRATE_1000000
+            BAUD_1200 = NRF_UARTE_BAUDRATE_1200,
+            BAUD_2400 = NRF_UARTE_BAUDRATE_2400,
+            BAUD_4800 = NRF_UARTE_BAUDRATE_4800,
+            BAUD_9600 = NRF_UARTE_BAUDRATE_9600,
+            BAUD_14400 = NRF_UARTE_BAUDRATE_14400,
+            BAUD_19200 = NRF_UARTE_BAUDRATE_19200,
+            BAUD_28800 = NRF_UARTE_BAUDRATE_28800,
+            BAUD_38400 = NRF_UARTE_BAUDRATE_38400,
+            BAUD_57600 = NRF_UARTE_BAUDRATE_57600,
+            BAUD_76800 = NRF_UARTE_BAUDRATE_76800,
+            BAUD_115200 = NRF_UARTE_BAUDRATE_115200,
+            BAUD_230400 = NRF_UARTE_BAUDRATE_230400,
+            BAUD_250000 = NRF_UARTE_BAUDRATE_250000,
+            BAUD_460800 = NRF_UARTE_BAUDRATE_460800,
+            BAUD_921600 = NRF_UARTE_BAUDRATE_921600,
+            BAUD_1000000 = NRF_UARTE_BAUDRATE_1000000
         };
 
         /// UART peripheral configuration.
@@ -76,6 +113,7 @@ namespace hal
             EMPTY_BUFFER, ///< Empty buffer when trying to read a packet.
             FULL_BUFFER,  ///< Full buffer when trying to write a packet.
             EMPTY_PACKET, ///< Tried to send an empty packet.
+            BUSY,         ///< Tried to send a frame still pending.
         };
 
         Uart(Config_t config);
@@ -84,40 +122,63 @@ namespace hal
         ErrorCode_e Init(HalRxEventHandler_t eventHandler, void *context);
 
         /// Deinitialize the UART peripheral.
-        void UnInit() const;
+        void UnInit();
 
         /// Read the last UART packet from the reception buffer.
         /// @param packet Retrieved packet.
         /// @return `SUCCESS` if the operation is successfull.
-        /// @return `FAIL` if the buffer is empty.
+        /// @return `EMPTY_BUFFER` if there is no packet to read.
         ErrorCode_e Read(Packet_t &packet);
 
-        /// Write a UART packet to the transmission buffer.
-        /// @param packet Packet to be written.
+        /// Get the oldest received packet in place, without copying it.
+        /// @return Oldest packet, valid until ReleasePacket is called, or nullptr if there is none.
+        const Packet_t *PeekPacket();
+
+        /// Free the packet returned by PeekPacket.
+        void ReleasePacket();
+
+        /// Queue a frame for transmission, without copying it.
+        /// @param frame Frame to be sent, its payload is encoded in place.
         /// @return `SUCCESS` if the operation is successfull.
-        /// @return `FAIL` if the buffer is full.
-        ErrorCode_e Write(const Packet_t &packet);
+        /// @return `EMPTY_PACKET` if the payload is empty or too long.
+        /// @return `BUSY` if the frame is still pending.
+        /// @return `FULL_BUFFER` if the transmission queue is full.
+        ErrorCode_e Write(TxFrame_t &frame);
+
+        /// Get the number of received frames dropped because they were malformed, too long or not read in time.
+        uint32_t GetDroppedFrameCount() const;
 
         HalRxEventHandler_t mHalRxEventHandler;
         void *mHalRxEventHandlerContext;
 
     private:
-        using PacketBuffer = RingBuffer<Packet_t>;
+        using PacketBuffer = RingBuffer<Packet_t, RX_PACKET_COUNT>;
 
-        using DriverEventHandler = void(nrf_drv_uart_event_t *event, Uart *instance);
+        using DriverEventHandler = void(nrfx_uarte_event_t const *event, Uart *instance);
         static constexpr size_t NUMBER_DRIVER_EVENTS = 3;
 
-        static void DriverCallback(nrf_drv_uart_event_t *event, void *context);
+        static void DriverCallback(nrfx_uarte_event_t const *event, void *context);
+
+        /// Called by the idle timer once the line has been quiet for IDLE_CHARACTERS
+        static void IdleTimerCallback(void const *context);
+
+        /// Time of IDLE_CHARACTERS at a baudrate, in nanoseconds
+        static uint32_t GetIdleTimeNs(Baudrate_e baudrate);
 
         ret_code_t InitDriver();
+        ret_code_t InitIdleDetection();
         ret_code_t StartReceiving();
         void StartTransmitting();
 
-        void CallDriverCallbackWithTxEvent();
+        /// Encode the payload of a frame in place. Up to 254 bytes, COBS adds a single code byte.
+        static void EncodeFrame(TxFrame_t &frame);
+
+        /// Feed received bytes to the COBS decoder, complete frames go to the reception buffer
+        void DecodeReceivedBytes(const uint8_t *p_data, size_t length);
 
-        static void HandleDriverTxEvent(nrf_drv_uart_event_t *event, Uart *instance);
-        static void HandleDriverRxEvent(nrf_drv_uart_event_t *event, Uart *instance);
-        static void HandleDriverErrorEvent(nrf_drv_uart_event_t *event, Uart *instance);
+        static void HandleDriverTxEvent(nrfx_uarte_event_t const *event, Uart *instance);
+        static void HandleDriverRxEvent(nrfx_uarte_event_t const *event, Uart *instance);
+        static void HandleDriverErrorEvent(nrfx_uarte_event_t const *event, Uart *instance);
 
         DriverEventHandler *HandleDriverEvent[NUMBER_DRIVER_EVENTS] =
             {
@@ -125,12 +186,27 @@ namespace hal
                 HandleDriverRxEvent,
                 HandleDriverErrorEvent};
 
-        Packet_t mRxPacket;
+        uint8_t mRxDmaBuffers[2][RX_DMA_BUFFER_LENGTH];
+
+        // COBS decoder state
+        Packet_t *mRxPacket;      ///< Slot reserved in the reception buffer, the frame is decoded in place.
+        uint8_t mRxCode;          ///< Code byte of the current block, 0 at the start of a frame.
+        uint8_t mRxCodeRemaining; ///< Bytes left in the current block.
+        bool mIsRxPacketDropped;  ///< Set when the frame being received is discarded up to the next delimiter.
+        uint32_t mDroppedFrameCount;
+
         PacketBuffer mRxPacketBuffer;
-        Packet_t mTxPacket;
-        PacketBuffer mTxPacketBuffer;
+
+        TxFrame_t *mTxQueue[TX_QUEUE_LENGTH];
+        size_t mTxQueueHead;
+        size_t mTxQueueCount;
+        TxFrame_t *mTxFrame; ///< Frame being sent, nullptr if the transmitter is idle.
+
         const Config_t mConfig;
-        const nrf_drv_uart_t mDriverInstance = NRF_DRV_UART_INSTANCE(0);
+        const nrfx_uarte_t mDriverInstance = NRFX_UARTE_INSTANCE(0);
+
+        Timer mIdleTimer;
+        nrf_ppi_channel_t mIdlePpiChannel;
     };
 
 }
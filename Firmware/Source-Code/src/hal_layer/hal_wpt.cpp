@@ -16,13 +16,15 @@
 #include "svc_wpt_manager.h"
 #include "eda_manager_log_config.h"
 
+#include "app_error.h"
+
 #include <cmath>
 #include <cstdint>
 #include <cstdio>
 namespace hal
 {
     Wpt_LTC4125::Wpt_LTC4125() : mDac(), timerImon(mtimerImonConfig, nullptr, this),
-                                 timerNtc(mtimerNtcConfig, nullptr, this)
+                                 mTimerLimitSampling(mTimerLimitSamplingConfig)
     {
         ConfigureDac();
         //  Initialize the WPT module by setting the DAC values
@@ -33,6 +35,16 @@ namespace hal
 
     MeasurementReadyCallback_t Wpt_LTC4125::mImonReadyCallback = nullptr;
 
+    StatChangedCallback_t Wpt_LTC4125::mStatChangedCallback = nullptr;
+
+    volatile uint8_t Wpt_LTC4125::mStatLevel = 1;
+
+    bool Wpt_LTC4125::mIsStatInterruptEnabled = false;
+
+    LimitTripCallback_t Wpt_LTC4125::mLimitTripCallback = nullptr;
+
+    Adc::AdcLimitChannel Wpt_LTC4125::mLimitChannels[Adc::MAX_LIMIT_CHANNELS];
+
     void Wpt_LTC4125::Init(void)
     {
         SetDeltaFBThreshold();
@@ -46,14 +58,87 @@ namespace hal
 
     void Wpt_LTC4125::Enable(void)
     {
-        // Enable the WPT module
-        Gpio::Write(PIN_WPT_EN, 0);
+        // Enable the WPT module, the pin is owned by GPIOTE (active low)
+        nrf_drv_gpiote_clr_task_trigger(PIN_WPT_EN);
     }
 
     void Wpt_LTC4125::Disable(void)
     {
         // Disable the WPT module
-        Gpio::Write(PIN_WPT_EN, 1);
+        nrf_drv_gpiote_set_task_trigger(PIN_WPT_EN);
+    }
+
+    void Wpt_LTC4125::ConfigureEnablePin(void)
+    {
+        // Starts de-asserted (high). Task mode lets the SAADC limit events drive the pin through PPI
+        nrf_drv_gpiote_out_config_t enableConfig = GPIOTE_CONFIG_OUT_TASK_TOGGLE(true);
+
+        Gpio::Init();
+        Gpio::ConfigurePin(PIN_WPT_EN, enableConfig);
+        nrf_drv_gpiote_out_task_enable(PIN_WPT_EN);
+    }
+
+    void Wpt_LTC4125::StartHardwareLimits(LimitTripCallback_t callback)
+    {
+        mLimitTripCallback = callback;
+
+        // Both limits set the enable pin high, i.e. stop the power transfer
+        const uint32_t disableTaskAddress = nrf_drv_gpiote_set_task_addr_get(PIN_WPT_EN);
+
+        // The NTC sits on the low side of the divider, its voltage drops as the coil heats up
+        mLimitChannels[0] = {
+            .pin = PIN_WPT_NTC,
+            .low_limit_mV = NtcTemperatureToVoltage(CoilOverTemperatureLimit_C),
+            .high_limit_mV = INT16_MAX,
+            .trip_task_address = disableTaskAddress};
+
+        mLimitChannels[1] = {
+            .pin = PIN_WPT_IMON,
+            .low_limit_mV = INT16_MIN,
+            .high_limit_mV = ImonOvercurrentLimit_mV,
+            .trip_task_address = disableTaskAddress};
+
+        // Only measured: the battery reading comes from the scan instead of disarming the limits
+        mLimitChannels[2] = {
+            .pin = PIN_BAT_MEAS,
+            .low_limit_mV = INT16_MIN,
+            .high_limit_mV = INT16_MAX,
+            .trip_task_address = 0};
+
+        if (!mIsLimitSamplingTimerInitialized)
+        {
+            mIsLimitSamplingTimerInitialized = (mTimerLimitSampling.Init() == Timer::ErrorCode::SUCCESS);
+        }
+
+        if (Adc::start_limit_monitor(mLimitChannels,
+                                     Adc::MAX_LIMIT_CHANNELS,
+                                     mTimerLimitSampling.GetCompareEventAddress(),
+                                     LimitHandler) != Adc::ErrorCode::SUCCESS)
+        {
+            LOG_ERROR("WPT HAL: Hardware limits could not be armed\n");
+            return;
+        }
+
+        mTimerLimitSampling.Clear();
+        mTimerLimitSampling.Start();
+    }
+
+    void Wpt_LTC4125::StopHardwareLimits(void)
+    {
+        mTimerLimitSampling.Stop();
+        Adc::stop_limit_monitor();
+    }
+
+    void Wpt_LTC4125::LimitHandler(nrf_saadc_input_t pin, nrf_saadc_limit_t limit)
+    {
+        // The enable pin was already de-asserted by PPI, only report the reason
+        LimitFault_e fault = (pin == PIN_WPT_NTC) ? LimitFault_e::COIL_OVER_TEMPERATURE
+                                                  : LimitFault_e::OVERCURRENT;
+
+        if (mLimitTripCallback)
+        {
+            mLimitTripCallback(fault);
+        }
     }
 
     void Wpt_LTC4125::StopSearch(void)
@@ -196,6 +281,17 @@ namespace hal
         return (int16_t)((temp_mK - 273150) / 1000);
     }
 
+    int16_t Wpt_LTC4125::NtcTemperatureToVoltage(int16_t temperature_C)
+    {
+        const int16_t R_FIXED = 5000; // Same divider as NtcVoltageToTemperature
+        float temperature_K = temperature_C + 273.15f;
+
+        // Beta equation: R_NTC = R0 * exp(B * (1/T - 1/T0))
+        float R_NTC = NTC_R0 * expf(NTC_BETA * ((1.0f / temperature_K) - (1000.0f / T0_mK)));
+
+        return static_cast<int16_t>(VCC_mV * R_NTC / (R_FIXED + R_NTC));
+    }
+
     void Wpt_LTC4125::GetImon(MeasurementReadyCallback_t callback)
     {
         mImonReadyCallback = callback;
@@ -205,11 +301,62 @@ namespace hal
 
     uint8_t Wpt_LTC4125::GetStat(void)
     {
-        // Get the Status of the WPT module
-        // TODO : The ticket for HSD-285 was created to investigate the IC response.
-        uint8_t statRead = 0;
+        // STAT is an open-drain output, it is pulled low while the LTC4125 delivers
+        // power to a receiver and released (pulled up) otherwise. The level is
+        // latched on every edge, so no pin access is needed here.
+        return mStatLevel;
+    }
+
+    void Wpt_LTC4125::EnableStatInterrupt(StatChangedCallback_t callback)
+    {
+        mStatChangedCallback = callback;
+
+        if (mIsStatInterruptEnabled)
+        {
+            return;
+        }
 
-        return statRead;
+        Gpio::Init();
+
+        nrf_drv_gpiote_in_config_t statConfig = NRFX_GPIOTE_CONFIG_IN_SENSE_TOGGLE(false);
+        statConfig.pull = NRF_GPIO_PIN_PULLUP;
+
+        ret_code_t err_code = nrf_drv_gpiote_in_init(PIN_WPT_STAT, &statConfig, StatHandler);
+        APP_ERROR_CHECK(err_code);
+
+        mStatLevel = nrf_drv_gpiote_in_is_set(PIN_WPT_STAT) ? 1 : 0;
+        nrf_drv_gpiote_in_event_enable(PIN_WPT_STAT, true);
+        mIsStatInterruptEnabled = true;
+    }
+
+    void Wpt_LTC4125::DisableStatInterrupt(void)
+    {
+        if (!mIsStatInterruptEnabled)
+        {
+            return;
+        }
+
+        nrf_drv_gpiote_in_event_disable(PIN_WPT_STAT);
+        nrf_drv_gpiote_in_uninit(PIN_WPT_STAT);
+        mIsStatInterruptEnabled = false;
+    }
+
+    void Wpt_LTC4125::StatHandler(nrfx_gpiote_pin_t pin_num, nrf_gpiote_polarity_t polarity)
+    {
+        uint8_t level = nrf_drv_gpiote_in_is_set(pin_num) ? 1 : 0;
+
+        // Toggle events can be reported twice for a single bounce, only forward real transitions
+        if (level == mStatLevel)
+        {
+            return;
+        }
+
+        mStatLevel = level;
+
+        if (mStatChangedCallback)
+        {
+            mStatChangedCallback(level);
+        }
     }
 
     void Wpt_LTC4125::wptImonCallback(const void *context)
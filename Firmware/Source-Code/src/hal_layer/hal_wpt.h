@@ -14,6 +14,8 @@
 #include "hal_dac.h"
 #include "hal_timer.h"
 
+#include "nrf_drv_gpiote.h"
+
 const int16_t NTC_R0 = 5000;   // NTC nominal resistance at 25°C
 const int16_t NTC_BETA = 3480; // NTC Beta coefficient
 const int32_t T0_mK = 298150;  // 25°C in milliKelvin (298.15K)
@@ -22,6 +24,18 @@ namespace hal
 {
     using MeasurementReadyCallback_t = void (*)(const uint16_t);
 
+    using StatChangedCallback_t = void (*)(const uint8_t);
+
+    /// Hardware limit that de-asserted the WPT enable pin
+    enum class LimitFault_e : uint8_t
+    {
+        NONE = 0,
+        COIL_OVER_TEMPERATURE,
+        OVERCURRENT
+    };
+
+    using LimitTripCallback_t = void (*)(const LimitFault_e);
+
     class Wpt_LTC4125
     {
     public:
@@ -37,6 +51,18 @@ namespace hal
         /// Disable the WPT module
         void Disable(void);
 
+        /// Hand the enable pin over to GPIOTE so that it can be driven through PPI
+        void ConfigureEnablePin(void);
+
+        /// Arm the coil NTC and IMON hardware limits
+        ///
+        /// A trip de-asserts the enable pin through PPI, without CPU, and then calls the callback.
+        /// @param callback Called from the SAADC interrupt after the enable pin was de-asserted
+        void StartHardwareLimits(LimitTripCallback_t callback);
+
+        /// Disarm the coil NTC and IMON hardware limits
+        void StopHardwareLimits(void);
+
         /// Stop the WPT power search
         void StopSearch(void);
 
@@ -53,8 +79,18 @@ namespace hal
         void GetImon(MeasurementReadyCallback_t callback);
 
         /// Get the Status of the WPT module
+        ///
+        /// @return Last STAT level latched by the edge interrupt (0 = pulled low)
         static uint8_t GetStat(void);
 
+        /// Configure the STAT pin as a GPIOTE toggle input
+        ///
+        /// @param callback Called from the GPIOTE interrupt with the new STAT level
+        static void EnableStatInterrupt(StatChangedCallback_t callback);
+
+        /// Disable the STAT pin edge interrupt
+        static void DisableStatInterrupt(void);
+
         /// Set pulse width threshold in mV steps
         void SetPulseWidthThresholdStep(uint8_t step);
 
@@ -78,6 +114,15 @@ namespace hal
         /// Stop the NTC measurement
         void StopMeasureNtc(void);
 
+        /// Convert a temperature in ºC to the NTC voltage, inverse of NtcVoltageToTemperature
+        static int16_t NtcTemperatureToVoltage(int16_t temperature_C);
+
+        /// Limit handler called from the SAADC interrupt
+        ///
+        /// @param pin Analog input that tripped
+        /// @param limit Limit that tripped
+        static void LimitHandler(nrf_saadc_input_t pin, nrf_saadc_limit_t limit);
+
         /// Set the delta FB threshold
         void SetDeltaFBThreshold(void);
 
@@ -107,6 +152,22 @@ namespace hal
 
         static MeasurementReadyCallback_t mNtcReadyCallback;
 
+        /// GPIOTE handler for the STAT pin
+        ///
+        /// @param pin_num Pin number
+        /// @param polarity Polarity of the GPIOTE channel that triggered the interruption
+        static void StatHandler(nrfx_gpiote_pin_t pin_num, nrf_gpiote_polarity_t polarity);
+
+        static StatChangedCallback_t mStatChangedCallback;
+
+        static LimitTripCallback_t mLimitTripCallback;
+
+        static Adc::AdcLimitChannel mLimitChannels[Adc::MAX_LIMIT_CHANNELS];
+
+        static volatile uint8_t mStatLevel;
+
+        static bool mIsStatInterruptEnabled;
+
         static constexpr uint8_t AdcBufferSize = 16;
 
         static constexpr uint32_t PeriodTimer = 78126;
@@ -125,6 +186,10 @@ namespace hal
 
         static constexpr uint16_t VoltageMinimunDriverPulseWidth = 100;
 
+        static constexpr int16_t CoilOverTemperatureLimit_C = 60;   // Coil NTC temperature that stops the power transfer (adjust as needed)
+        static constexpr int16_t ImonOvercurrentLimit_mV = 1500;    // IMON voltage that stops the power transfer (adjust as needed)
+        static constexpr uint32_t LimitSamplingPeriod = 1000000;    // 1 ms between limit checks, in nanoseconds
+
         int16_t mNtc[AdcBufferSize] = {0};
 
         int16_t mImon[AdcBufferSize] = {0};
@@ -138,13 +203,17 @@ namespace hal
             .autostart = true,
             .timerNumber = Timer::PeripheralNumber::TIMER_1};
 
-        static constexpr Timer::Config_t mtimerNtcConfig = {
-            .period = PeriodTimer,
+        static constexpr Timer::Config_t mTimerLimitSamplingConfig = {
+            .period = LimitSamplingPeriod,
             .autostart = true,
             .timerNumber = Timer::PeripheralNumber::TIMER_2};
 
         Timer timerImon;
-        Timer timerNtc;
+
+        // Created without handler: it only triggers the SAADC sampling through PPI
+        Timer mTimerLimitSampling;
+
+        bool mIsLimitSamplingTimerInitialized = false;
     };
 }
 #endif
\ No newline at end of file
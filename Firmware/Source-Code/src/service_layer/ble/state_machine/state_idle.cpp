@@ -11,6 +11,7 @@
 #include "svc_ble_state_machine.h"
 #include "svc_ble_port.h"
 #include "svc_ble_manager.h"
+#include "svc_ble_telemetry.h"
 
 namespace svc
 {
@@ -40,6 +41,36 @@ namespace svc
             stateMachine->ChangeState(states->pStateScanning);            
             break;
         }
+
+        case BlePort::Event_e::BIND_IMPLANT:
+        {
+            BleManager::BindImplant();
+            break;
+        }
+
+        case BlePort::Event_e::UNBIND_IMPLANT:
+        {
+            BleManager::UnbindImplant();
+            break;
+        }
+
+        case BlePort::Event_e::SET_SCAN_PROFILE:
+        {
+            BleManager::SetScanProfile(static_cast<ScanProfile_e>(optDataAddress));
+            break;
+        }
+
+        case BlePort::Event_e::TELEMETRY_SAMPLE:
+        {
+            BleTelemetry::Sample();
+            break;
+        }
+
+        case BlePort::Event_e::TELEMETRY_FLUSH:
+        {
+            BleTelemetry::Flush();
+            break;
+        }
         }
     }
 
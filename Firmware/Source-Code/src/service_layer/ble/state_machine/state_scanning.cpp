@@ -11,6 +11,7 @@
 #include "svc_ble_state_machine.h"
 #include "svc_ble_port.h"
 #include "svc_ble_manager.h"
+#include "svc_ble_telemetry.h"
 
 
 namespace svc
@@ -39,6 +40,44 @@ namespace svc
                 stateMachine->ChangeState(states->pStateIdle);
                 break;
             }
+            case BlePort::Event_e::BIND_IMPLANT:
+            {
+                // The scan restarts with the accept list in place
+                BleManager::BindImplant();
+                BleManager::ConnectImplant();
+                break;
+            }
+            case BlePort::Event_e::UNBIND_IMPLANT:
+            {
+                BleManager::UnbindImplant();
+                break;
+            }
+            case BlePort::Event_e::SET_SCAN_PROFILE:
+            {
+                BleManager::SetScanProfile(static_cast<ScanProfile_e>(optDataAddress));
+                break;
+            }
+            case BlePort::Event_e::CONNECT_IMPLANT:
+            {
+                BleManager::ConnectImplant();
+                break;
+            }
+            case BlePort::Event_e::LINK_LOST:
+            {
+                // The timeout timer keeps running, the session ends if the scan does not find the implant either
+                BleManager::ResumeScanning();
+                break;
+            }
+            case BlePort::Event_e::TELEMETRY_SAMPLE:
+            {
+                BleTelemetry::Sample();
+                break;
+            }
+            case BlePort::Event_e::TELEMETRY_FLUSH:
+            {
+                BleTelemetry::Flush();
+                break;
+            }
         }
     }
 
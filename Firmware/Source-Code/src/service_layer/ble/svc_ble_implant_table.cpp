@@ -0,0 +1,225 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_ble_implant_table.cpp
+ * @brief Table of the implants in range
+ *
+ * @copyright Copyright (c) 2024
+ */
+
+#include "svc_ble_implant_table.h"
+
+#include "eda_manager_log_config.h"
+
+#include "FreeRTOS.h"
+
+#include <atomic>
+#include <cstring>
+
+namespace svc
+{
+    ImplantTable::ImplantTable() : mEntries(), mSelected(INVALID_INDEX), mBoundAddress(), mIsBound(false)
+    {
+        memset(mIndex, INVALID_INDEX, sizeof(mIndex));
+    }
+
+    bool ImplantTable::Update(const ble_gap_addr_t &address, const ChargingStatusParameters_t &status, int8_t rssi, uint32_t nowTicks)
+    {
+        Age(nowTicks);
+
+        uint8_t index = Find(address);
+
+        if (index == INVALID_INDEX)
+        {
+            index = Allocate(nowTicks);
+
+            mEntries[index].address = address;
+            mEntries[index].rssiAverage = static_cast<int16_t>(rssi * 16);
+            mEntries[index].advertisementCount = 0;
+            mEntries[index].isUsed = true;
+            Index(index);
+        }
+        else
+        {
+            Entry_t &entry = mEntries[index];
+            entry.rssiAverage += (static_cast<int16_t>(rssi * 16) - entry.rssiAverage) >> RSSI_AVERAGE_SHIFT;
+        }
+
+        Entry_t &entry = mEntries[index];
+        entry.status = status;
+        entry.rssi = rssi;
+        entry.lastSeenTicks = nowTicks;
+        entry.advertisementCount++;
+
+        if (mIsBound)
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return IsSameAddress(address, mBoundAddress);
+        }
+
+        // No session yet: follow the strongest implant, switching only on a clear margin
+        uint8_t best = SelectBest();
+
+        if ((mSelected == INVALID_INDEX) ||
+            (mEntries[best].rssiAverage >= mEntries[mSelected].rssiAverage + SELECTION_HYSTERESIS_DB * 16))
+        {
+            if (mSelected != best)
+            {
+                LOG_DEBUG("Implant candidate %02x:%02x, RSSI %d dBm.",
+                          mEntries[best].address.addr[1], mEntries[best].address.addr[0],
+                          mEntries[best].rssiAverage / 16);
+            }
+            mSelected = best;
+        }
+
+        return (index == mSelected);
+    }
+
+    void ImplantTable::Bind(const ble_gap_addr_t &address)
+    {
+        mBoundAddress = address;
+
+        // The address must be visible to the scan context before the flag
+        std::atomic_thread_fence(std::memory_order_release);
+        mIsBound = true;
+    }
+
+    void ImplantTable::Unbind(void)
+    {
+        mIsBound = false;
+    }
+
+    bool ImplantTable::IsBound(void) const
+    {
+        return mIsBound;
+    }
+
+    bool ImplantTable::GetRssiAverage(const ble_gap_addr_t &address, int8_t &rssiAverage) const
+    {
+        uint8_t index = Find(address);
+
+        if (index == INVALID_INDEX)
+        {
+            return false;
+        }
+
+        rssiAverage = static_cast<int8_t>(mEntries[index].rssiAverage / 16);
+        return true;
+    }
+
+    bool ImplantTable::IsSameAddress(const ble_gap_addr_t &a, const ble_gap_addr_t &b)
+    {
+        return (a.addr_type == b.addr_type) && (memcmp(a.addr, b.addr, BLE_GAP_ADDR_LEN) == 0);
+    }
+
+    uint8_t ImplantTable::Hash(const ble_gap_addr_t &address)
+    {
+        uint8_t hash = address.addr_type;
+
+        for (uint8_t i = 0; i < BLE_GAP_ADDR_LEN; i++)
+        {
+            hash = static_cast<uint8_t>(hash * 31 + address.addr[i]);
+        }
+
+        return hash & (INDEX_SLOTS - 1);
+    }
+
+    uint8_t ImplantTable::Find(const ble_gap_addr_t &address) const
+    {
+        // The index keeps a free slot, the probe ends on it when the address is not present
+        for (uint8_t slot = Hash(address); mIndex[slot] != INVALID_INDEX; slot = (slot + 1) & (INDEX_SLOTS - 1))
+        {
+            if (IsSameAddress(mEntries[mIndex[slot]].address, address))
+            {
+                return mIndex[slot];
+            }
+        }
+
+        return INVALID_INDEX;
+    }
+
+    void ImplantTable::Index(uint8_t entry)
+    {
+        uint8_t slot = Hash(mEntries[entry].address);
+
+        while (mIndex[slot] != INVALID_INDEX)
+        {
+            slot = (slot + 1) & (INDEX_SLOTS - 1);
+        }
+
+        mIndex[slot] = entry;
+    }
+
+    void ImplantTable::Free(uint8_t entry)
+    {
+        mEntries[entry].isUsed = false;
+
+        // Entries are freed seldom, rebuilding is simpler than keeping deleted markers in the probes
+        memset(mIndex, INVALID_INDEX, sizeof(mIndex));
+
+        for (uint8_t i = 0; i < MAX_IMPLANTS; i++)
+        {
+            if (mEntries[i].isUsed)
+            {
+                Index(i);
+            }
+        }
+    }
+
+    uint8_t ImplantTable::Allocate(uint32_t nowTicks)
+    {
+        uint8_t oldest = 0;
+
+        for (uint8_t i = 0; i < MAX_IMPLANTS; i++)
+        {
+            if (!mEntries[i].isUsed)
+            {
+                return i;
+            }
+
+            if ((nowTicks - mEntries[i].lastSeenTicks) > (nowTicks - mEntries[oldest].lastSeenTicks))
+            {
+                oldest = i;
+            }
+        }
+
+        // Table full, reuse the least recently seen implant
+        if (oldest == mSelected)
+        {
+            mSelected = INVALID_INDEX;
+        }
+
+        Free(oldest);
+        return oldest;
+    }
+
+    void ImplantTable::Age(uint32_t nowTicks)
+    {
+        for (uint8_t i = 0; i < MAX_IMPLANTS; i++)
+        {
+            if (mEntries[i].isUsed && ((nowTicks - mEntries[i].lastSeenTicks) > pdMS_TO_TICKS(IMPLANT_STALE_MS)))
+            {
+                Free(i);
+
+                if (i == mSelected)
+                {
+                    mSelected = INVALID_INDEX;
+                }
+            }
+        }
+    }
+
+    uint8_t ImplantTable::SelectBest(void) const
+    {
+        uint8_t best = INVALID_INDEX;
+
+        for (uint8_t i = 0; i < MAX_IMPLANTS; i++)
+        {
+            if (mEntries[i].isUsed && ((best == INVALID_INDEX) || (mEntries[i].rssiAverage > mEntries[best].rssiAverage)))
+            {
+                best = i;
+            }
+        }
+
+        return best;
+    }
+}
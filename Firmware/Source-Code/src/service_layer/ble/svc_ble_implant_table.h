@@ -0,0 +1,111 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_ble_implant_table.h
+ * @brief Table of the implants in range
+ *
+ * @copyright Copyright (c) 2024
+ */
+
+#ifndef SVC_BLE_IMPLANT_TABLE_H
+#define SVC_BLE_IMPLANT_TABLE_H
+
+#include "ble_gap.h"
+#include "svc_ble_messages.h"
+
+#include <cstdint>
+
+namespace svc
+{
+    class ImplantTable
+    {
+    public:
+        static constexpr uint8_t MAX_IMPLANTS = 4;           // Implants tracked at once
+        static constexpr uint32_t IMPLANT_STALE_MS = 30000;  // Entry freed when not seen for this long
+        static constexpr int8_t SELECTION_HYSTERESIS_DB = 6; // Smoothed RSSI margin needed to switch candidates
+
+        typedef struct
+        {
+            ble_gap_addr_t address;
+            ChargingStatusParameters_t status; // Latest decoded status
+            int8_t rssi;                       // RSSI of the latest advertisement, dBm
+            int16_t rssiAverage;               // Exponential average of the RSSI, 1/16 dBm
+            uint32_t lastSeenTicks;
+            uint32_t advertisementCount;
+            bool isUsed;
+        } Entry_t;
+
+        /// Constructor of the implant table
+        ImplantTable();
+
+        /// Record an IPG advertisement. Called from the scan context only.
+        ///
+        /// @param address Address of the advertiser
+        /// @param status Decoded IPG status
+        /// @param rssi RSSI of the advertisement
+        /// @param nowTicks Tick count of the reception
+        /// @return true if the advertisement comes from the bound implant, or from the best candidate when none is bound
+        bool Update(const ble_gap_addr_t &address, const ChargingStatusParameters_t &status, int8_t rssi, uint32_t nowTicks);
+
+        /// Lock the session onto an implant, its advertisements are the only ones selected until Unbind
+        ///
+        /// @param address Address of the implant
+        void Bind(const ble_gap_addr_t &address);
+
+        /// Release the session binding
+        void Unbind(void);
+
+        /// Check if an implant is bound
+        bool IsBound(void) const;
+
+        /// Get the smoothed RSSI of an implant
+        ///
+        /// @param address Address of the implant
+        /// @param rssiAverage Smoothed RSSI in dBm
+        /// @return false if the implant is not in the table
+        bool GetRssiAverage(const ble_gap_addr_t &address, int8_t &rssiAverage) const;
+
+    private:
+        static constexpr uint8_t INVALID_INDEX = 0xFF;
+        static constexpr uint8_t RSSI_AVERAGE_SHIFT = 2; // Average weight of a new sample: 1/4
+        static constexpr uint8_t INDEX_SLOTS = 8;        // Slots of the address index, a power of two above MAX_IMPLANTS
+
+        static_assert((INDEX_SLOTS & (INDEX_SLOTS - 1)) == 0, "The index is masked, its size must be a power of two");
+        static_assert(INDEX_SLOTS > MAX_IMPLANTS, "The index needs a free slot to end a probe");
+
+        /// Compare two BLE addresses
+        static bool IsSameAddress(const ble_gap_addr_t &a, const ble_gap_addr_t &b);
+
+        /// Get the slot of an address in the index
+        static uint8_t Hash(const ble_gap_addr_t &address);
+
+        /// Get the index of an implant, INVALID_INDEX if not present
+        uint8_t Find(const ble_gap_addr_t &address) const;
+
+        /// Add a used entry to the address index
+        void Index(uint8_t entry);
+
+        /// Free an entry and rebuild the address index without it
+        void Free(uint8_t entry);
+
+        /// Get a free entry, evicting the least recently seen one when the table is full
+        uint8_t Allocate(uint32_t nowTicks);
+
+        /// Free the entries not seen for IMPLANT_STALE_MS
+        void Age(uint32_t nowTicks);
+
+        /// Get the entry with the strongest smoothed RSSI, INVALID_INDEX if the table is empty
+        uint8_t SelectBest(void) const;
+
+        Entry_t mEntries[MAX_IMPLANTS];
+
+        uint8_t mIndex[INDEX_SLOTS]; // Entry of each address, open addressing with linear probing
+
+        uint8_t mSelected;
+
+        ble_gap_addr_t mBoundAddress;
+
+        volatile bool mIsBound;
+    };
+}
+
+#endif // SVC_BLE_IMPLANT_TABLE_H
@@ -9,17 +9,49 @@
 #include "../../core_layer/event_driven_architecture/manager/eda_manager_log_config.h"
 #include "svc_ble_manager.h"
 #include "svc_ble_port.h"
+#include "svc_ble_telemetry.h"
 
 #include "app_error.h"
 #include "nrf_sdh.h"
 #include "nrf_sdh_ble.h"
+#include "task.h"
+
+#if (IPG_CONNECTED_MODE != 0) && (NRF_SDH_BLE_CENTRAL_LINK_COUNT == 0)
+#error "The connected mode needs a central link in sdk_config.h, and RAM_START moved to the value nrf_sdh_ble_enable reports"
+#endif
 
 namespace svc
 {
     AdvertisementData_t BleManager::mAdvertisementData;
 
+    eda::Snapshot<AdvertisementData_t> BleManager::mAdvertisementSnapshot;
+
+    ImplantTable BleManager::mImplantTable;
+
+    PhyReport BleManager::mPhyReport;
+
+    bool BleManager::mIsImplantBound = false;
+
+    ble_gap_addr_t BleManager::mBoundAddress;
+
+    bool BleManager::mIsLinkSubscribed = false;
+
+    uint8_t BleManager::mConnectFailures = 0;
+
+    ScanProfile_e BleManager::mScanProfile = ScanProfile_e::DISCOVERY;
+
+    uint32_t BleManager::mScanTimeoutMs = GetScanTimeoutMs(ScanProfile_e::DISCOVERY);
+
     eda::Timer BleManager::mTimeoutTimer(TIMER_NAME, SCAN_TIMEOUT_MS, ONESHOT, TimerCallback);
 
+    volatile uint32_t BleManager::mLastSeenTicks = 0;
+
+    ChargingStatusParameters_t BleManager::mDeviceFoundStatus;
+
+    int8_t BleManager::mDeviceFoundRssi = BLE_RSSI_NOT_AVAILABLE;
+
+    uint32_t BleManager::mDeviceFoundTicks = 0;
+
     BleManager::BleManager(void)
     {
     }
@@ -27,11 +59,27 @@ namespace svc
     void BleManager::Init()
     {
         hal::Ble::Init(ScanEventHandler);
+
+        // Advertisements from other devices are dropped by the HAL before reaching the parser
+        hal::Ble::SetManufacturerFilter(CARSS_COMPANY_ID);
+
+        hal::Ble::SetScanPhys(IPG_SCAN_EXTENDED != 0, BLE_GAP_PHY_1MBPS | ((IPG_SCAN_CODED_PHY != 0) ? BLE_GAP_PHY_CODED : 0));
+
+        static const ble_uuid128_t telemetryUuidBase = {IPG_TELEMETRY_UUID_BASE};
+        hal::Ble::SetLinkCharacteristic(&telemetryUuidBase, IPG_TELEMETRY_SERVICE_UUID, IPG_TELEMETRY_STATUS_CHAR_UUID, LinkEventHandler);
+
+        // The charger telemetry service advertises alongside the scan
+        BleTelemetry::Init();
     }
 
     void BleManager::StartScanning(void)
     {
         LOG_DEBUG("Starting scan.");
+        mPhyReport.Start(static_cast<uint32_t>(xTaskGetTickCount()), GetScanDutyPermille(mScanProfile));
+
+        // The first status of the scan is always sent, the RSSI of a report is never BLE_RSSI_NOT_AVAILABLE
+        mDeviceFoundRssi = BLE_RSSI_NOT_AVAILABLE;
+
         hal::Ble::StartScanning();
         StartTimeoutTimer();
     }
@@ -40,14 +88,133 @@ namespace svc
     {
         LOG_DEBUG("Stopping scan.");
 
+        hal::Ble::Disconnect();
         hal::Ble::StopScanning();
         StopTimeoutTimer();
+
+        mPhyReport.Log(static_cast<uint32_t>(xTaskGetTickCount()), IPG_ADV_INTERVAL_MS);
+
+        hal::BleDispatchStats_t stats;
+        hal::Ble::GetDispatchStats(stats);
+
+        // 64 cycles per microsecond
+        LOG_INFO("SoftDevice events: %d interrupts, ISR max %d us, latency max %d us, dispatch max %d us.",
+                 stats.irq_count, stats.isr_cycles_max / 64, stats.latency_cycles_max / 64, stats.dispatch_cycles_max / 64);
+    }
+
+    void BleManager::SetScanProfile(ScanProfile_e profile)
+    {
+        // Several states ask for the same profile, the scan is only restarted on a change
+        if ((profile >= ScanProfile_e::COUNT) || (profile == mScanProfile))
+        {
+            return;
+        }
+
+        const ScanProfile_t &timing = mScanProfiles[static_cast<uint8_t>(profile)];
+
+        mScanProfile = profile;
+
+        mScanTimeoutMs = GetScanTimeoutMs(profile);
+
+        mPhyReport.SetDutyCycle(static_cast<uint32_t>(xTaskGetTickCount()), GetScanDutyPermille(profile));
+
+        LOG_INFO("Scan profile %d, timeout %d ms.", static_cast<uint8_t>(profile), mScanTimeoutMs);
+
+        hal::Ble::SetScanTiming(timing.intervalMs, timing.windowMs);
+
+        if (mTimeoutTimer.IsRunning())
+        {
+            mTimeoutTimer.Start(mScanTimeoutMs);
+        }
+    }
+
+    void BleManager::BindImplant(void)
+    {
+        // The published data always comes from the selected candidate
+        AdvertisementData_t data = GetAdvertisementData();
+
+        LOG_INFO("Binding implant.");
+        mImplantTable.Bind(data.address);
+        hal::Ble::SetAcceptList(&data.address);
+        mBoundAddress = data.address;
+        mIsImplantBound = true;
+        mConnectFailures = 0;
+    }
+
+    void BleManager::UnbindImplant(void)
+    {
+        if (!mIsImplantBound)
+        {
+            return;
+        }
+
+        LOG_INFO("Unbinding implant.");
+        hal::Ble::Disconnect();
+        mImplantTable.Unbind();
+        hal::Ble::SetAcceptList(nullptr);
+        mIsImplantBound = false;
+    }
+
+    bool BleManager::IsImplantBound(void)
+    {
+        return mIsImplantBound;
+    }
+
+    void BleManager::ConnectImplant(void)
+    {
+        if ((IPG_CONNECTED_MODE == 0) || !mIsImplantBound || hal::Ble::IsConnected())
+        {
+            return;
+        }
+
+        if (mConnectFailures >= IPG_CONNECT_MAX_ATTEMPTS)
+        {
+            // The IPG does not offer the service, the advertisements are good enough
+            return;
+        }
+
+        mIsLinkSubscribed = false;
+
+        if (!hal::Ble::Connect(&mBoundAddress))
+        {
+            mConnectFailures++;
+        }
+    }
+
+    void BleManager::ResumeScanning(void)
+    {
+        if (hal::Ble::IsConnected())
+        {
+            return;
+        }
+
+        LOG_INFO("Link lost, back to scanning.");
+        hal::Ble::StartScanning();
+    }
+
+    bool BleManager::GetFreshAdvertisementData(AdvertisementData_t &data, uint32_t maxAgeMs)
+    {
+        uint32_t timestampTicks;
+        uint32_t sequence;
+
+        if (!mAdvertisementSnapshot.Read(data, timestampTicks, sequence))
+        {
+            return false;
+        }
+
+        // Unsigned difference, correct across the tick counter wrap
+        uint32_t ageTicks = static_cast<uint32_t>(xTaskGetTickCount()) - timestampTicks;
+
+        return (ageTicks <= pdMS_TO_TICKS(maxAgeMs));
     }
 
     void BleManager::StartTimeoutTimer(void)
     {
         LOG_DEBUG("Starting timeout timer.");
-        mTimeoutTimer.Start();
+
+        // The scan start counts as the last sighting, the implant has the full timeout to show up
+        mLastSeenTicks = static_cast<uint32_t>(xTaskGetTickCount());
+        mTimeoutTimer.Start(mScanTimeoutMs);
     }
 
     void BleManager::StopTimeoutTimer(void)
@@ -58,8 +225,18 @@ namespace svc
 
     void BleManager::TimerCallback(TimerHandle_t xTimer)
     {
+        // Timer task context: the timer is one-shot, it is only re-armed here
+        uint32_t elapsedTicks = static_cast<uint32_t>(xTaskGetTickCount()) - mLastSeenTicks;
+        uint32_t elapsedMs = (elapsedTicks * 1000U) / configTICK_RATE_HZ;
+
+        if (elapsedMs < mScanTimeoutMs)
+        {
+            // The implant was seen meanwhile, wait for the rest of the timeout after that sighting
+            mTimeoutTimer.Start(mScanTimeoutMs - elapsedMs);
+            return;
+        }
+
         LOG_DEBUG("Timeout timer expired.");
-        mTimeoutTimer.StopFromISR();
         BlePort::SendEvent(BlePort::Event_e::SCAN_TIMEOUT, NULL);
     }
 
@@ -75,7 +252,8 @@ namespace svc
             LOG_DEBUG("Filter match.");
             break;
         case NRF_BLE_SCAN_EVT_WHITELIST_ADV_REPORT:
-            LOG_DEBUG("Whitelist adv report.");
+            // Advertisement from the bound implant
+            AdvertisementEventHandler(event->p_not_found);
             break;
         case NRF_BLE_SCAN_EVT_NOT_FOUND:
             AdvertisementEventHandler(event->p_not_found);
@@ -85,15 +263,54 @@ namespace svc
         }
     }
 
+    void BleManager::LinkEventHandler(hal::BleLinkEvent_t *event)
+    {
+        switch (event->link_evt_id)
+        {
+        case hal::BLE_LINK_EVENT_CONNECTED:
+            LOG_DEBUG("Link connected.");
+            break;
+        case hal::BLE_LINK_EVENT_SUBSCRIBED:
+            mIsLinkSubscribed = true;
+            mConnectFailures = 0;
+            break;
+        case hal::BLE_LINK_EVENT_NOTIFICATION:
+        {
+            ChargingStatusParameters_t status;
+
+            // The characteristic carries the advertisement payload, without the company identifier
+            if (IpgAdvertisementDecoder::Decode(event->data.p_data, event->data.len, status) == IpgAdvertisementDecoder::Result_e::TOO_SHORT)
+            {
+                LOG_WARNING("IPG notification too short: %d bytes.", event->data.len);
+                break;
+            }
+
+            PublishStatus(event->peer_addr, status, event->rssi);
+            break;
+        }
+        case hal::BLE_LINK_EVENT_DISCONNECTED:
+            if (!mIsLinkSubscribed)
+            {
+                mConnectFailures++;
+            }
+            mIsLinkSubscribed = false;
+
+            BlePort::SendEvent(BlePort::Event_e::LINK_LOST, NULL);
+            break;
+        default:
+            break;
+        }
+    }
+
     void BleManager::AdvertisementEventHandler(const hal::BleGapEventAdvReport_t *p_adv_report)
     {
         uint8_t *adv_data = p_adv_report->data.p_data;
         uint8_t adv_data_len = p_adv_report->data.len;
 
-        ParseAdvertisementData(adv_data, adv_data_len);
+        ParseAdvertisementData(adv_data, adv_data_len, p_adv_report);
     }
 
-    void BleManager::ParseAdvertisementData(uint8_t *adv_data, uint16_t adv_data_len)
+    void BleManager::ParseAdvertisementData(uint8_t *adv_data, uint16_t adv_data_len, const hal::BleGapEventAdvReport_t *p_adv_report)
     {
         uint16_t index = 0;
 
@@ -120,7 +337,7 @@ namespace svc
                 break;
             case BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA:
                 // Handle manufacturer-specific data
-                ParseManufacturerSpecificData(adv_data, adv_data_len, index);
+                ParseManufacturerSpecificData(data, data_length, p_adv_report);
                 break;
             // Add other cases as needed
             default:
@@ -132,33 +349,93 @@ namespace svc
         }
     }
 
-    void BleManager::ParseManufacturerSpecificData(uint8_t *adv_data, uint16_t adv_data_len, uint16_t index)
+    void BleManager::ParseManufacturerSpecificData(const uint8_t *data, uint8_t data_len, const hal::BleGapEventAdvReport_t *p_adv_report)
     {
-        // Check if this is the manufacturer-specific data with Company ID 0xFFFF
-        uint16_t company_id = adv_data[index + 2] | (adv_data[index + 3] << 8);
+        if (data_len < sizeof(uint16_t))
+        {
+            return;
+        }
+
+        uint16_t company_id = data[0] | (data[1] << 8);
 
-        if (company_id == CARSS_COMPANY_ID)
+        if (company_id != CARSS_COMPANY_ID)
         {
-            mAdvertisementData.chargingStatusParameters.GET_VRECT_DET = adv_data[index + 4];
-            mAdvertisementData.chargingStatusParameters.GET_VRECT_OVP = adv_data[index + 5];
-            mAdvertisementData.chargingStatusParameters.GET_VCHG_RAIL_SUPPLY_CIRCUIT_POWER_GOOD = adv_data[index + 6];
-            mAdvertisementData.chargingStatusParameters.GET_CHG1_STATUS = adv_data[index + 7];
-            mAdvertisementData.chargingStatusParameters.GET_CHG1_OVP_ERR = adv_data[index + 8];
-            mAdvertisementData.chargingStatusParameters.GET_CHG2_STATUS = adv_data[index + 9];
-            mAdvertisementData.chargingStatusParameters.GET_CHG2_OVP_ERR = adv_data[index + 10];
-            mAdvertisementData.chargingStatusParameters.GET_THERM_REF = adv_data[index + 11] | (adv_data[index + 12] << 8);
-            mAdvertisementData.chargingStatusParameters.GET_THERM_OUT = adv_data[index + 13] | (adv_data[index + 14] << 8);
-            mAdvertisementData.chargingStatusParameters.GET_THERM_OFST = adv_data[index + 15] | (adv_data[index + 16] << 8);
-            mAdvertisementData.chargingStatusParameters.BATTERY_VOLTAGE_MEASURED = adv_data[index + 17] | (adv_data[index + 18] << 8) | (adv_data[index + 19] << 16) | (adv_data[index + 20] << 24);
-            mAdvertisementData.chargingStatusParameters.GET_TEST_INFO = adv_data[index + 21] | (adv_data[index + 22] << 8) | (adv_data[index + 23] << 16);
+            return;
+        }
 
-            uint32_t optDataAddress = reinterpret_cast<uint32_t>(&mAdvertisementData);
+        ChargingStatusParameters_t status;
 
-            BlePort::SendEventFromISR(BlePort::Event_e::DEVICE_FOUND, optDataAddress);
+        IpgAdvertisementDecoder::Result_e result = IpgAdvertisementDecoder::Decode(&data[sizeof(uint16_t)],
+                                                                                   data_len - sizeof(uint16_t),
+                                                                                   status);
 
-            // Restart the timer when the Device is found
-            mTimeoutTimer.StartFromISR();
+        if (result == IpgAdvertisementDecoder::Result_e::TOO_SHORT)
+        {
+            LOG_WARNING("IPG advertisement too short: %d bytes, the legacy layout needs %d.",
+                        data_len - sizeof(uint16_t),
+                        IpgAdvertisementDecoder::LEGACY_PAYLOAD_LENGTH);
+            return;
         }
+
+        if (PublishStatus(p_adv_report->peer_addr, status, p_adv_report->rssi))
+        {
+            mPhyReport.Record(p_adv_report->primary_phy, p_adv_report->rssi);
+        }
+
+        // The bound implant is still advertising, the link can be brought back
+        if ((IPG_CONNECTED_MODE != 0) && mIsImplantBound && !hal::Ble::IsConnected() &&
+            (mConnectFailures < IPG_CONNECT_MAX_ATTEMPTS))
+        {
+            BlePort::SendEvent(BlePort::Event_e::CONNECT_IMPLANT, NULL);
+        }
+    }
+
+    bool BleManager::PublishStatus(const ble_gap_addr_t &address, const ChargingStatusParameters_t &status, int8_t rssi)
+    {
+        uint32_t nowTicks = static_cast<uint32_t>(xTaskGetTickCount());
+
+        if (rssi == BLE_RSSI_NOT_AVAILABLE)
+        {
+            rssi = mAdvertisementData.rssi;
+        }
+
+        if (!mImplantTable.Update(address, status, rssi, nowTicks))
+        {
+            // Another implant in range, kept in the table but not used for the charge control
+            return false;
+        }
+
+        mAdvertisementData.chargingStatusParameters = status;
+        mAdvertisementData.rssi = rssi;
+        mImplantTable.GetRssiAverage(address, mAdvertisementData.rssiAverage);
+        mAdvertisementData.address = address;
+
+        // Publish the complete set at once, readers never see a partially parsed advertisement
+        mAdvertisementSnapshot.Write(mAdvertisementData, nowTicks);
+
+        // Compared with the last DEVICE_FOUND, a change held back by the period goes out with a later status
+        if ((!IsSameStatus(status, mDeviceFoundStatus) || (rssi != mDeviceFoundRssi)) &&
+            ((nowTicks - mDeviceFoundTicks) >= pdMS_TO_TICKS(DEVICE_FOUND_MIN_PERIOD_MS)))
+        {
+            mDeviceFoundStatus = status;
+            mDeviceFoundRssi = rssi;
+            mDeviceFoundTicks = nowTicks;
+
+            // The optional data is the snapshot sequence number
+            BlePort::SendEvent(BlePort::Event_e::DEVICE_FOUND, mAdvertisementSnapshot.GetSequence());
+        }
+
+        // The timeout timer picks this up on expiry, nothing is posted to the timer task per packet
+        mLastSeenTicks = nowTicks;
+
+        return true;
+    }
+
+    bool BleManager::IsSameStatus(const ChargingStatusParameters_t &a, const ChargingStatusParameters_t &b)
+    {
+#define IPG_ADV_EQUAL(name, type, bytes) &&(a.name == b.name)
+        return true IPG_ADV_LAYOUT(IPG_ADV_EQUAL);
+#undef IPG_ADV_EQUAL
     }
 
     void BleManager::ParseLocalName(uint8_t *adv_data, uint16_t adv_data_len, uint16_t index, uint8_t length)
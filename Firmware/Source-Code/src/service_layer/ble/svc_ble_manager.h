@@ -10,16 +10,26 @@
 #define SVC_BLE_MANAGER_H
 
 #include "hal_ble.h"
+#include "svc_ble_implant_table.h"
+#include "svc_ble_messages.h"
+#include "svc_ble_phy_report.h"
 
+#include "eda_snapshot.h"
 #include "eda_timer.h"
 
 #include <cstdint>
 
-#define SCAN_INTERVAL 0x00A0
-#define SCAN_WINDOW 0x0050
-
 #define TIMER_NAME "BleTimeoutTimer"
 #define SCAN_TIMEOUT_MS 10000 //Changed from original value of 2000
+
+// The scan timeout runs SCAN_TIMEOUT_MS past the longest gap the scan profile leaves between two IPG advertisements
+#define IPG_ADV_INTERVAL_MS 1000     // IPG advertising interval
+#define IPG_ADV_DELAY_MAX_MS 10      // Random delay added by the link layer to each advertising event
+
+// DEVICE_FOUND is sent on a new status or RSSI, at most once per this period. The advertisements are
+// never held back, the notifications of the connected mode are coalesced to the advertising rate.
+#define DEVICE_FOUND_MIN_PERIOD_MS (IPG_ADV_INTERVAL_MS / 2)
+
 #define PERIODIC 1
 #define ONESHOT 0
 
@@ -29,6 +39,25 @@
 // The CARSS_COMPANY_ID on the IPG is 0xF0F0 for production firmware, 0xFFFF for DVT firmware
 #define CARSS_COMPANY_ID 0xF0F0
 
+// Connected mode: once bound, the charger connects to the IPG and subscribes to its charging status
+// characteristic, which notifies the IPG_ADV_LAYOUT payload at the connection rate. Scanning takes
+// over whenever the link is lost. Build time only, off until the IPG firmware offers the service.
+// Enabling it needs NRF_SDH_BLE_CENTRAL_LINK_COUNT 1 and NRF_SDH_BLE_TOTAL_LINK_COUNT 2 in sdk_config.h,
+// and the application RAM_START raised to the minimum logged by nrf_sdh_ble_enable.
+#define IPG_CONNECTED_MODE 0 // 1 to enable the connected mode
+#define IPG_CONNECT_MAX_ATTEMPTS 3 // Failed connections before staying on scanning for the session
+
+// Extended scanning receives extended advertisements (larger payloads). Coded PHY trades data rate for
+// range, for deep implants; it implies extended scanning and halves the scan window given to each PHY.
+#define IPG_SCAN_EXTENDED 0  // 1 to scan for extended advertisements
+#define IPG_SCAN_CODED_PHY 0 // 1 to also scan on Coded PHY
+
+// IPG charging status GATT service, placeholder UUIDs until the IPG firmware defines it
+#define IPG_TELEMETRY_UUID_BASE {0x3C, 0x8F, 0x21, 0x5A, 0x6D, 0x4E, 0x9B, 0xA1, \
+                                 0x47, 0x2C, 0xE0, 0x13, 0x00, 0x00, 0x5D, 0xC4}
+#define IPG_TELEMETRY_SERVICE_UUID 0x1500
+#define IPG_TELEMETRY_STATUS_CHAR_UUID 0x1501
+
 namespace svc
 {
     enum class BleEventType_e : uint8_t
@@ -38,6 +67,15 @@ namespace svc
         STOP_SCANNING
     };
 
+    /// Scan duty cycle profiles, selected from the charger state
+    enum class ScanProfile_e : uint8_t
+    {
+        DISCOVERY,  // Continuous scan while looking for an implant
+        MODERATE,   // Charging or slow charging, IPG data used by the power control
+        KEEP_ALIVE, // Stable charging, only the link supervision is needed
+        COUNT
+    };
+
     enum class BleManagerStatus_e : uint8_t
     {
         INVALID,
@@ -45,26 +83,13 @@ namespace svc
         SCANNING
     };
 
-    typedef struct
-    {
-        uint8_t GET_VRECT_DET;
-        uint8_t GET_VRECT_OVP;
-        uint8_t GET_VCHG_RAIL_SUPPLY_CIRCUIT_POWER_GOOD;
-        uint8_t GET_CHG1_STATUS;
-        uint8_t GET_CHG1_OVP_ERR;
-        uint8_t GET_CHG2_STATUS;
-        uint8_t GET_CHG2_OVP_ERR;
-        uint16_t GET_THERM_REF;
-        uint16_t GET_THERM_OUT;
-        uint16_t GET_THERM_OFST;
-        uint32_t BATTERY_VOLTAGE_MEASURED;
-        uint32_t GET_TEST_INFO;
-    } ChargingStatusParameters_t;
-
     typedef struct
     {
         ChargingStatusParameters_t chargingStatusParameters;
         char localName[32];
+        int8_t rssi;
+        int8_t rssiAverage;
+        ble_gap_addr_t address;
     } AdvertisementData_t;
 
     using EventHandler_t = void (*)(ble_evt_t *event, void *context);
@@ -84,26 +109,166 @@ namespace svc
         /// Stop BLE Scanning
         static void StopScanning(void);
 
-        // Getter for advertisement data
-        static const AdvertisementData_t& GetAdvertisementData() 
+        /// Select the scan duty cycle and rescale the scan timeout accordingly
+        ///
+        /// @param profile Scan profile to use
+        static void SetScanProfile(ScanProfile_e profile);
+
+        /// Longest time between two received advertisements of an implant in range with a scan profile.
+        ///
+        /// Each advertising event lands a fixed step earlier or later in the scan interval, plus the random
+        /// advertising delay. A step no larger than the window cannot jump over it, so the window is reached
+        /// after a bounded number of events. A scan interval that divides the advertising interval has no
+        /// step and can miss the implant for good, it gives UINT32_MAX.
+        ///
+        /// @param profile Scan profile
+        /// @return Longest gap in milliseconds
+        static constexpr uint32_t GetMaxAdvertisementGapMs(ScanProfile_e profile)
+        {
+            const ScanProfile_t &timing = mScanProfiles[static_cast<uint8_t>(profile)];
+            const uint32_t eventMaxMs = IPG_ADV_INTERVAL_MS + IPG_ADV_DELAY_MAX_MS;
+
+            if (timing.windowMs >= timing.intervalMs)
+            {
+                return eventMaxMs;
+            }
+
+            const uint32_t driftMs = IPG_ADV_INTERVAL_MS % timing.intervalMs;
+            const uint32_t stepMs = (driftMs < (timing.intervalMs - driftMs)) ? driftMs : (timing.intervalMs - driftMs);
+
+            if ((stepMs <= IPG_ADV_DELAY_MAX_MS) || ((stepMs + IPG_ADV_DELAY_MAX_MS) > timing.windowMs))
+            {
+                return UINT32_MAX;
+            }
+
+            // Events missed while the phase crosses the rest of the interval, at the smallest step
+            const uint32_t missed = ((timing.intervalMs - timing.windowMs) + (stepMs - IPG_ADV_DELAY_MAX_MS) - 1) / (stepMs - IPG_ADV_DELAY_MAX_MS);
+
+            return (missed + 1) * eventMaxMs;
+        }
+
+        /// Scan timeout of a scan profile, counted from the last IPG advertisement
+        ///
+        /// @param profile Scan profile
+        /// @return Timeout in milliseconds
+        static constexpr uint32_t GetScanTimeoutMs(ScanProfile_e profile)
         {
-            return mAdvertisementData;
+            return SCAN_TIMEOUT_MS + GetMaxAdvertisementGapMs(profile);
         }
 
+        /// Share of the time the scanner listens on each PHY with a scan profile
+        ///
+        /// @param profile Scan profile
+        /// @return Duty cycle in permille
+        static constexpr uint16_t GetScanDutyPermille(ScanProfile_e profile)
+        {
+            const ScanProfile_t &timing = mScanProfiles[static_cast<uint8_t>(profile)];
+
+            // With Coded PHY each PHY gets its own window, both fit in the interval
+            const uint16_t maxWindowMs = (IPG_SCAN_CODED_PHY != 0) ? (timing.intervalMs / 2) : timing.intervalMs;
+            const uint16_t windowMs = (timing.windowMs < maxWindowMs) ? timing.windowMs : maxWindowMs;
+
+            return static_cast<uint16_t>((static_cast<uint32_t>(windowMs) * 1000U) / timing.intervalMs);
+        }
+
+        /// Bind the implant of the last advertisement, from now on only its advertisements are received
+        static void BindImplant(void);
+
+        /// Release the bound implant and accept any CARSS implant again
+        static void UnbindImplant(void);
+
+        /// Check if an implant is bound
+        static bool IsImplantBound(void);
+
+        /// Connect to the bound implant, if the connected mode is enabled
+        static void ConnectImplant(void);
+
+        /// Fall back to scanning after the link to the implant was lost
+        static void ResumeScanning(void);
+
+        // Getter for advertisement data, returns a consistent copy of the last IPG advertisement
+        static AdvertisementData_t GetAdvertisementData() 
+        {
+            AdvertisementData_t data;
+            mAdvertisementSnapshot.Read(data);
+            return data;
+        }
+
+        /// Get the last IPG advertisement with its reception time
+        ///
+        /// @param data Copy of the advertisement data
+        /// @param timestampTicks Tick count when the advertisement was received
+        /// @param sequence Number of IPG advertisements received so far
+        /// @return false if no IPG advertisement was received yet
+        static bool GetAdvertisementData(AdvertisementData_t &data, uint32_t &timestampTicks, uint32_t &sequence)
+        {
+            return mAdvertisementSnapshot.Read(data, timestampTicks, sequence);
+        }
+
+        /// Get the last IPG status, only if it was received recently enough to act on
+        ///
+        /// @param data Copy of the advertisement data
+        /// @param maxAgeMs Oldest reception accepted, in milliseconds
+        /// @return false if no IPG status was received in the last maxAgeMs
+        static bool GetFreshAdvertisementData(AdvertisementData_t &data, uint32_t maxAgeMs);
+
     private:
         static EventHandler_t mEventHandler;
 
+        // Written by the parser in the SoftDevice event context only, published through the snapshot
         static AdvertisementData_t mAdvertisementData;
 
+        static eda::Snapshot<AdvertisementData_t> mAdvertisementSnapshot;
+
+        // Every IPG in range, only the selected one is published in mAdvertisementSnapshot
+        static ImplantTable mImplantTable;
+
+        // Reception of the selected implant per PHY, over the current scan
+        static PhyReport mPhyReport;
+
+        static bool mIsImplantBound;
+
+        static ble_gap_addr_t mBoundAddress;
+
+        static bool mIsLinkSubscribed;
+
+        static uint8_t mConnectFailures;
+
+        struct ScanProfile_t
+        {
+            uint16_t intervalMs;
+            uint16_t windowMs;
+        };
+
+        // The scan intervals do not divide IPG_ADV_INTERVAL_MS, see GetMaxAdvertisementGapMs
+        static constexpr ScanProfile_t mScanProfiles[static_cast<uint8_t>(ScanProfile_e::COUNT)] = {
+            {100, 100},  // DISCOVERY: 100 % duty cycle
+            {220, 110},  // MODERATE: 50 % duty cycle, 100 ms step per advertisement
+            {1200, 250}, // KEEP_ALIVE: 21 % duty cycle, 200 ms step per advertisement
+        };
+
+        static ScanProfile_e mScanProfile;
+
+        static uint32_t mScanTimeoutMs;
+
         static eda::Timer mTimeoutTimer;
 
-        /// Start the timeout timer
+        // Tick count of the last IPG status, or of the scan start. Written from the SoftDevice event
+        // context with a plain store, the timeout timer compares it with the current time on expiry.
+        static volatile uint32_t mLastSeenTicks;
+
+        // Status and RSSI of the last DEVICE_FOUND, and its tick count
+        static ChargingStatusParameters_t mDeviceFoundStatus;
+        static int8_t mDeviceFoundRssi;
+        static uint32_t mDeviceFoundTicks;
+
+        /// Start the timeout timer, counting from now
         static void StartTimeoutTimer(void);
 
         /// Stop the timeout timer
         static void StopTimeoutTimer(void);
 
-        /// Callback function for the timer
+        /// Callback function for the timer, re-armed for the remaining time while the implant is seen
         ///
         /// @param xTimer Handle to the timer
         static void TimerCallback(TimerHandle_t xTimer);
@@ -113,6 +278,22 @@ namespace svc
         /// @param event Pointer to the BLE scan event
         static void ScanEventHandler(hal::BleScanEvent_t *event);
 
+        /// Handle the events of the link to the implant, in the SoftDevice event context
+        ///
+        /// @param event Pointer to the link event
+        static void LinkEventHandler(hal::BleLinkEvent_t *event);
+
+        /// Publish an IPG status from the advertisements or from the link
+        ///
+        /// @param address Address of the IPG
+        /// @param status Decoded IPG status
+        /// @param rssi RSSI of the reception, BLE_RSSI_NOT_AVAILABLE to keep the last one
+        /// @return true if the status comes from the selected implant and was published
+        static bool PublishStatus(const ble_gap_addr_t &address, const ChargingStatusParameters_t &status, int8_t rssi);
+
+        /// Compare two IPG statuses field by field
+        static bool IsSameStatus(const ChargingStatusParameters_t &a, const ChargingStatusParameters_t &b);
+
         /// Handle advertisement events
         ///
         /// @param p_adv_report Pointer to the advertisement report
@@ -122,14 +303,15 @@ namespace svc
         ///
         /// @param adv_data Pointer to the advertisement data
         /// @param adv_data_len Length of the advertisement data
-        static void ParseAdvertisementData(uint8_t *adv_data, uint16_t adv_data_len);
+        /// @param p_adv_report Advertisement report the data belongs to
+        static void ParseAdvertisementData(uint8_t *adv_data, uint16_t adv_data_len, const hal::BleGapEventAdvReport_t *p_adv_report);
 
         /// Parse manufacturer-specific data from advertisement data
         ///
-        /// @param adv_data Pointer to the advertisement data
-        /// @param adv_data_len Length of the advertisement data
-        /// @param index Index where the manufacturer-specific data starts
-        static void ParseManufacturerSpecificData(uint8_t *adv_data, uint16_t adv_data_len, uint16_t index);
+        /// @param data Pointer to the manufacturer-specific data, starting with the company identifier
+        /// @param data_len Length of the manufacturer-specific data
+        /// @param p_adv_report Advertisement report the data belongs to
+        static void ParseManufacturerSpecificData(const uint8_t *data, uint8_t data_len, const hal::BleGapEventAdvReport_t *p_adv_report);
 
         /// Parse the local name from advertisement data
         ///
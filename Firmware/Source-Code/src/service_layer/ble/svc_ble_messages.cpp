@@ -0,0 +1,51 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_ble_messages.cpp
+ * @brief IPG advertisement layout and decoder
+ *
+ * @copyright Copyright (c) 2024
+ */
+
+#include "svc_ble_messages.h"
+
+namespace svc
+{
+    template <typename T>
+    void IpgAdvertisementDecoder::ReadField(const uint8_t *&p_cursor, T &value, uint8_t bytes)
+    {
+        T decoded = 0;
+
+        for (uint8_t i = 0; i < bytes; i++)
+        {
+            decoded |= static_cast<T>(static_cast<T>(p_cursor[i]) << (8 * i));
+        }
+
+        value = decoded;
+        p_cursor += bytes;
+    }
+
+    IpgAdvertisementDecoder::Result_e IpgAdvertisementDecoder::Decode(const uint8_t *p_data, uint16_t length, ChargingStatusParameters_t &parameters)
+    {
+        if ((p_data == nullptr) || (length < LEGACY_PAYLOAD_LENGTH))
+        {
+            return Result_e::TOO_SHORT;
+        }
+
+        const uint8_t *p_cursor = p_data;
+
+#define IPG_ADV_DECODE(name, type, bytes) ReadField<type>(p_cursor, parameters.name, bytes);
+
+        if (length < PAYLOAD_LENGTH)
+        {
+            // Only the legacy layout is shorter, the lengths in between are not told apart
+            IPG_ADV_LAYOUT_LEGACY(IPG_ADV_DECODE)
+            return Result_e::LEGACY;
+        }
+
+        IPG_ADV_LAYOUT(IPG_ADV_DECODE)
+
+#undef IPG_ADV_DECODE
+
+        return (length > PAYLOAD_LENGTH) ? Result_e::EXTENDED : Result_e::OK;
+    }
+}
@@ -0,0 +1,101 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_ble_messages.h
+ * @brief IPG advertisement layout and decoder
+ *
+ * @copyright Copyright (c) 2024
+ */
+
+#ifndef SVC_BLE_MESSAGES_H
+#define SVC_BLE_MESSAGES_H
+
+#include <cstdint>
+
+// IPG manufacturer specific data layout, following the company identifier.
+// Fields are little endian and sent in this order, each on its number of bytes. The decoder and
+// ChargingStatusParameters_t are both generated from this list: a new field is appended to
+// IPG_ADV_LAYOUT, nowhere else.
+//
+//    FIELD(name, type, bytes)
+#define IPG_ADV_LAYOUT_COMMON(FIELD)                           \
+    FIELD(GET_VRECT_DET, uint8_t, 1)                           \
+    FIELD(GET_VRECT_OVP, uint8_t, 1)                           \
+    FIELD(GET_VCHG_RAIL_SUPPLY_CIRCUIT_POWER_GOOD, uint8_t, 1) \
+    FIELD(GET_CHG1_STATUS, uint8_t, 1)                         \
+    FIELD(GET_CHG1_OVP_ERR, uint8_t, 1)                        \
+    FIELD(GET_CHG2_STATUS, uint8_t, 1)                         \
+    FIELD(GET_CHG2_OVP_ERR, uint8_t, 1)                        \
+    FIELD(GET_THERM_REF, uint16_t, 2)                          \
+    FIELD(GET_THERM_OUT, uint16_t, 2)                          \
+    FIELD(GET_THERM_OFST, uint16_t, 2)                         \
+    FIELD(BATTERY_VOLTAGE_MEASURED, uint32_t, 4)
+
+// Layout of the first IPG firmware, 20 bytes: GET_TEST_INFO is sent on 3 bytes and ends the payload
+#define IPG_ADV_LAYOUT_LEGACY(FIELD) \
+    IPG_ADV_LAYOUT_COMMON(FIELD)     \
+    FIELD(GET_TEST_INFO, uint32_t, 3)
+
+#define IPG_ADV_LAYOUT(FIELD)    \
+    IPG_ADV_LAYOUT_COMMON(FIELD) \
+    FIELD(GET_TEST_INFO, uint32_t, 4)
+
+namespace svc
+{
+#define IPG_ADV_MEMBER(name, type, bytes) type name;
+
+    typedef struct
+    {
+        IPG_ADV_LAYOUT(IPG_ADV_MEMBER)
+    } ChargingStatusParameters_t;
+
+#undef IPG_ADV_MEMBER
+
+    class IpgAdvertisementDecoder
+    {
+    public:
+        enum class Result_e : uint8_t
+        {
+            OK,
+            TOO_SHORT,   // Payload shorter than the legacy layout, nothing decoded
+            EXTENDED,    // Decoded, trailing bytes from a newer IPG layout were ignored
+            LEGACY       // Decoded from IPG_ADV_LAYOUT_LEGACY
+        };
+
+        // Version of IPG_ADV_LAYOUT, to be bumped with the layout. IPG_ADV_LAYOUT_LEGACY is version 0.
+        // The advertisement has no version byte: a layout only appends fields, so the
+        // version is told by the payload length.
+        static constexpr uint8_t LAYOUT_VERSION = 1;
+
+#define IPG_ADV_SIZE(name, type, bytes) +(bytes)
+
+        /// Payload length of the layout, company identifier excluded
+        static constexpr uint16_t PAYLOAD_LENGTH = 0 IPG_ADV_LAYOUT(IPG_ADV_SIZE);
+
+        /// Payload length of the legacy layout, the shortest payload decoded
+        static constexpr uint16_t LEGACY_PAYLOAD_LENGTH = 0 IPG_ADV_LAYOUT_LEGACY(IPG_ADV_SIZE);
+
+#undef IPG_ADV_SIZE
+
+        static_assert(LEGACY_PAYLOAD_LENGTH < PAYLOAD_LENGTH, "The layouts are told apart by their length");
+
+        /// Decode the IPG payload in a single pass, straight from the advertisement buffer.
+        /// A payload of LEGACY_PAYLOAD_LENGTH is decoded with the legacy layout.
+        ///
+        /// @param p_data Payload, starting right after the company identifier
+        /// @param length Payload length
+        /// @param parameters Decoded fields, left untouched unless the result is OK or EXTENDED
+        /// @return Decoding result
+        static Result_e Decode(const uint8_t *p_data, uint16_t length, ChargingStatusParameters_t &parameters);
+
+    private:
+        /// Read a little endian field and move the cursor past it
+        ///
+        /// @param p_cursor Position of the field in the payload
+        /// @param value Decoded value
+        /// @param bytes Length of the field in the payload, up to sizeof(T)
+        template <typename T>
+        static void ReadField(const uint8_t *&p_cursor, T &value, uint8_t bytes);
+    };
+}
+
+#endif // SVC_BLE_MESSAGES_H
@@ -0,0 +1,120 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_ble_phy_report.cpp
+ * @brief Reception statistics of the IPG advertisements per PHY
+ *
+ * @copyright Copyright (c) 2024
+ */
+
+#include "svc_ble_phy_report.h"
+
+#include "../../core_layer/event_driven_architecture/manager/eda_manager_log_config.h"
+
+#include "FreeRTOS.h"
+#include "ble_gap.h"
+
+namespace svc
+{
+    PhyReport::PhyReport() : mCounters(), mListenedTicksPermille(0), mDutyStartTicks(0), mDutyPermille(1000)
+    {
+    }
+
+    void PhyReport::Start(uint32_t nowTicks, uint16_t dutyPermille)
+    {
+        for (Counters_t &counters : mCounters)
+        {
+            counters = {0, 0, 0, 0};
+        }
+
+        mListenedTicksPermille = 0;
+        mDutyStartTicks = nowTicks;
+        mDutyPermille = dutyPermille;
+    }
+
+    void PhyReport::SetDutyCycle(uint32_t nowTicks, uint16_t dutyPermille)
+    {
+        mListenedTicksPermille = GetListenedTicksPermille(nowTicks);
+        mDutyStartTicks = nowTicks;
+        mDutyPermille = dutyPermille;
+    }
+
+    uint64_t PhyReport::GetListenedTicksPermille(uint32_t nowTicks) const
+    {
+        return mListenedTicksPermille + static_cast<uint64_t>(nowTicks - mDutyStartTicks) * mDutyPermille;
+    }
+
+    void PhyReport::Record(uint8_t primaryPhy, int8_t rssi)
+    {
+        Phy_e phy;
+
+        if (primaryPhy == BLE_GAP_PHY_CODED)
+        {
+            phy = Phy_e::PHY_CODED;
+        }
+        else if (primaryPhy == BLE_GAP_PHY_1MBPS)
+        {
+            phy = Phy_e::PHY_1M;
+        }
+        else
+        {
+            return;
+        }
+
+        Counters_t &counters = mCounters[static_cast<uint8_t>(phy)];
+
+        if ((counters.received == 0) || (rssi < counters.rssiMin))
+        {
+            counters.rssiMin = rssi;
+        }
+
+        if ((counters.received == 0) || (rssi > counters.rssiMax))
+        {
+            counters.rssiMax = rssi;
+        }
+
+        counters.rssiSum += rssi;
+        counters.received++;
+    }
+
+    void PhyReport::GetStats(Phy_e phy, uint32_t nowTicks, uint32_t advIntervalMs, PhyStats_t &stats) const
+    {
+        const Counters_t &counters = mCounters[static_cast<uint8_t>(phy)];
+
+        // An advertisement is only heard when it falls in a scan window, the expected count follows the duty cycle
+        uint32_t listenedMs = static_cast<uint32_t>(GetListenedTicksPermille(nowTicks) / configTICK_RATE_HZ);
+
+        stats.received = counters.received;
+        stats.expected = (advIntervalMs != 0) ? (listenedMs / advIntervalMs) : 0;
+
+        // The scan duty cycle applies to both PHYs alike, the loss compares them on the same footing
+        if (stats.expected > stats.received)
+        {
+            stats.lossPermille = static_cast<uint16_t>(((stats.expected - stats.received) * 1000U) / stats.expected);
+        }
+        else
+        {
+            stats.lossPermille = 0;
+        }
+
+        stats.rssiMin = counters.rssiMin;
+        stats.rssiMax = counters.rssiMax;
+        stats.rssiAverage = (counters.received != 0) ? static_cast<int8_t>(counters.rssiSum / static_cast<int32_t>(counters.received)) : 0;
+    }
+
+    void PhyReport::Log(uint32_t nowTicks, uint32_t advIntervalMs) const
+    {
+        static const char *const names[] = {"1M", "Coded"};
+
+        for (uint8_t i = 0; i < static_cast<uint8_t>(Phy_e::COUNT); i++)
+        {
+            PhyStats_t stats;
+
+            GetStats(static_cast<Phy_e>(i), nowTicks, advIntervalMs, stats);
+
+            LOG_INFO("PHY %s: %d/%d advertisements, loss %d permille.",
+                     names[i], stats.received, stats.expected, stats.lossPermille);
+            LOG_INFO("PHY %s: RSSI average %d, min %d, max %d dBm.",
+                     names[i], stats.rssiAverage, stats.rssiMin, stats.rssiMax);
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_ble_phy_report.h
+ * @brief Reception statistics of the IPG advertisements per PHY
+ *
+ * @copyright Copyright (c) 2024
+ */
+
+#ifndef SVC_BLE_PHY_REPORT_H
+#define SVC_BLE_PHY_REPORT_H
+
+#include <cstdint>
+
+namespace svc
+{
+    class PhyReport
+    {
+    public:
+        enum class Phy_e : uint8_t
+        {
+            PHY_1M,
+            PHY_CODED,
+            COUNT
+        };
+
+        typedef struct
+        {
+            uint32_t received;        // Advertisements of the selected implant
+            uint32_t expected;        // Advertisements sent by the implant while the scanner listened
+            uint16_t lossPermille;    // Share of the expected advertisements not received
+            int8_t rssiMin;           // dBm, 0 if none received
+            int8_t rssiMax;           // dBm, 0 if none received
+            int8_t rssiAverage;       // dBm, 0 if none received
+        } PhyStats_t;
+
+        /// Constructor of the PHY report
+        PhyReport();
+
+        /// Clear the counters and start a new period
+        ///
+        /// @param nowTicks Tick count of the period start
+        /// @param dutyPermille Share of the time the scanner listens on each PHY
+        void Start(uint32_t nowTicks, uint16_t dutyPermille);
+
+        /// Change the scan duty cycle within the period, the time before is counted at the previous one
+        ///
+        /// @param nowTicks Tick count of the change
+        /// @param dutyPermille Share of the time the scanner listens on each PHY
+        void SetDutyCycle(uint32_t nowTicks, uint16_t dutyPermille);
+
+        /// Count an advertisement of the selected implant
+        ///
+        /// @param primaryPhy PHY of the primary advertising packet, BLE_GAP_PHYS bitfield value
+        /// @param rssi RSSI of the advertisement
+        void Record(uint8_t primaryPhy, int8_t rssi);
+
+        /// Get the statistics of a PHY since Start
+        ///
+        /// @param phy PHY to report
+        /// @param nowTicks Tick count of the end of the period
+        /// @param advIntervalMs Advertising interval of the implant, on each PHY it uses
+        /// @param stats Statistics of the PHY
+        void GetStats(Phy_e phy, uint32_t nowTicks, uint32_t advIntervalMs, PhyStats_t &stats) const;
+
+        /// Log the comparison of the PHYs
+        ///
+        /// @param nowTicks Tick count of the end of the period
+        /// @param advIntervalMs Advertising interval of the implant, on each PHY it uses
+        void Log(uint32_t nowTicks, uint32_t advIntervalMs) const;
+
+    private:
+        typedef struct
+        {
+            uint32_t received;
+            int32_t rssiSum;
+            int8_t rssiMin;
+            int8_t rssiMax;
+        } Counters_t;
+
+        /// Listening time since Start, in ticks weighted by the duty cycle in permille
+        uint64_t GetListenedTicksPermille(uint32_t nowTicks) const;
+
+        Counters_t mCounters[static_cast<uint8_t>(Phy_e::COUNT)];
+
+        uint64_t mListenedTicksPermille; // Listening time of the previous duty cycles
+        uint32_t mDutyStartTicks;        // Tick count of the last duty cycle change
+        uint16_t mDutyPermille;
+    };
+}
+
+#endif // SVC_BLE_PHY_REPORT_H
@@ -29,6 +29,13 @@ namespace svc
             STOP_SCANNING,
             SCAN_TIMEOUT,
             DEVICE_FOUND,
+            BIND_IMPLANT,
+            UNBIND_IMPLANT,
+            SET_SCAN_PROFILE,
+            CONNECT_IMPLANT,
+            LINK_LOST,
+            TELEMETRY_SAMPLE,
+            TELEMETRY_FLUSH,
         };
 
         static void SendEvent(Event_e eventID, uint32_t optDataAddress)
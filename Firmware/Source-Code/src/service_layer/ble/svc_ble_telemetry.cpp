@@ -0,0 +1,241 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_ble_telemetry.cpp
+ * @brief Charger GATT telemetry service
+ *
+ * @copyright Copyright (c) 2024
+ */
+
+#include "svc_ble_telemetry.h"
+
+#include "../../core_layer/event_driven_architecture/manager/eda_manager_log_config.h"
+#include "svc_ble_port.h"
+#include "svc_wpt_manager.h"
+#include "svc_wpt_session.h"
+
+#include "ble_srv_common.h"
+
+namespace svc
+{
+    eda::Timer BleTelemetry::mSampleTimer("BleTelemetryTimer", DEFAULT_SAMPLE_PERIOD_MS, 1, TimerCallback);
+
+    uint16_t BleTelemetry::mStatusHandle = BLE_GATT_HANDLE_INVALID;
+
+    uint16_t BleTelemetry::mBatchHandle = BLE_GATT_HANDLE_INVALID;
+
+    uint16_t BleTelemetry::mBatchCccdHandle = BLE_GATT_HANDLE_INVALID;
+
+    uint16_t BleTelemetry::mConfigHandle = BLE_GATT_HANDLE_INVALID;
+
+    volatile bool BleTelemetry::mIsNotifyEnabled = false;
+
+    volatile uint16_t BleTelemetry::mSamplePeriodMs = DEFAULT_SAMPLE_PERIOD_MS;
+
+    volatile uint16_t BleTelemetry::mNotifyPeriodMs = DEFAULT_NOTIFY_PERIOD_MS;
+
+    uint16_t BleTelemetry::mSequence = 0;
+
+    uint16_t BleTelemetry::mSamplesSinceFlush = 0;
+
+    TelemetryRecord_t BleTelemetry::mRecords[BUFFER_RECORDS];
+
+    uint8_t BleTelemetry::mHead = 0;
+
+    uint8_t BleTelemetry::mCount = 0;
+
+    void BleTelemetry::Init(void)
+    {
+        static const ble_uuid128_t uuidBase = {CHARGER_TELEMETRY_UUID_BASE};
+        uint8_t uuidType;
+
+        uint16_t serviceHandle = hal::Ble::AddService(&uuidBase, CHARGER_TELEMETRY_SERVICE_UUID, &uuidType);
+
+        const ble_uuid_t statusUuid = {.uuid = CHARGER_TELEMETRY_STATUS_CHAR_UUID, .type = uuidType};
+        const ble_uuid_t batchUuid = {.uuid = CHARGER_TELEMETRY_BATCH_CHAR_UUID, .type = uuidType};
+        const ble_uuid_t configUuid = {.uuid = CHARGER_TELEMETRY_CONFIG_CHAR_UUID, .type = uuidType};
+
+        hal::Ble::AddCharacteristic(serviceHandle, statusUuid, {.read = true, .write = false, .notify = false},
+                                    RECORD_SIZE, &mStatusHandle, nullptr);
+        hal::Ble::AddCharacteristic(serviceHandle, batchUuid, {.read = false, .write = false, .notify = true},
+                                    NRF_SDH_BLE_GATT_MAX_MTU_SIZE - 3, &mBatchHandle, &mBatchCccdHandle);
+        hal::Ble::AddCharacteristic(serviceHandle, configUuid, {.read = true, .write = true, .notify = false},
+                                    2 * sizeof(uint16_t), &mConfigHandle, nullptr);
+
+        const uint8_t config[] = {
+            static_cast<uint8_t>(mSamplePeriodMs), static_cast<uint8_t>(mSamplePeriodMs >> 8),
+            static_cast<uint8_t>(mNotifyPeriodMs), static_cast<uint8_t>(mNotifyPeriodMs >> 8)};
+        hal::Ble::SetValue(mConfigHandle, config, sizeof(config));
+
+        const ble_uuid_t serviceUuid = {.uuid = CHARGER_TELEMETRY_SERVICE_UUID, .type = uuidType};
+        hal::Ble::StartAdvertising(CHARGER_DEVICE_NAME, serviceUuid, PeripheralEventHandler);
+    }
+
+    void BleTelemetry::Sample(void)
+    {
+        WptSession &session = WptSession::Instance();
+        WptSessionReport_t report;
+
+        session.GetReport(report);
+
+        const TelemetryRecord_t record = {
+            .sequence = mSequence++,
+            .sessionState = static_cast<uint8_t>(session.IsRunning() ? 1 : 0),
+            .pgoodState = WptManager::GetPgoodState(),
+            .ipgTemperature = WptManager::GetIpgTemperature(),
+            .powerLevel = WptManager::Instance().GetPowerLevel(),
+            .faultFlags = WptManager::GetFaultFlags(),
+            .deliveredEnergyMj = report.deliveredEnergyMj,
+            .sessionDurationS = report.durationS,
+            .powerCap = WptManager::GetPowerCap(),
+            .powerCapFlags = WptManager::GetPowerCapFlags()};
+
+        uint8_t encoded[RECORD_SIZE];
+        EncodeRecord(record, encoded);
+
+        // The status characteristic always holds the latest record, for clients that only read
+        hal::Ble::SetValue(mStatusHandle, encoded, sizeof(encoded));
+
+        if (!mIsNotifyEnabled)
+        {
+            mHead = 0;
+            mCount = 0;
+            mSamplesSinceFlush = 0;
+            return;
+        }
+
+        // A client that does not keep up loses the oldest records, the sequence shows the gap
+        if (mCount == BUFFER_RECORDS)
+        {
+            mHead = (mHead + 1) % BUFFER_RECORDS;
+            mCount--;
+        }
+
+        mRecords[(mHead + mCount) % BUFFER_RECORDS] = record;
+        mCount++;
+        mSamplesSinceFlush++;
+
+        uint16_t recordsPerNotification = (hal::Ble::GetPeripheralMtu() - 3) / RECORD_SIZE;
+
+        if ((mCount >= recordsPerNotification) ||
+            (static_cast<uint32_t>(mSamplesSinceFlush) * mSamplePeriodMs >= mNotifyPeriodMs))
+        {
+            Flush();
+        }
+    }
+
+    void BleTelemetry::Flush(void)
+    {
+        uint8_t payload[NRF_SDH_BLE_GATT_MAX_MTU_SIZE - 3];
+        uint16_t recordsPerNotification = (hal::Ble::GetPeripheralMtu() - 3) / RECORD_SIZE;
+
+        if (recordsPerNotification > sizeof(payload) / RECORD_SIZE)
+        {
+            recordsPerNotification = sizeof(payload) / RECORD_SIZE;
+        }
+
+        mSamplesSinceFlush = 0;
+
+        while (mIsNotifyEnabled && (mCount > 0))
+        {
+            uint8_t count = (mCount < recordsPerNotification) ? mCount : recordsPerNotification;
+
+            for (uint8_t i = 0; i < count; i++)
+            {
+                EncodeRecord(mRecords[(mHead + i) % BUFFER_RECORDS], &payload[i * RECORD_SIZE]);
+            }
+
+            if (!hal::Ble::Notify(mBatchHandle, payload, count * RECORD_SIZE))
+            {
+                // Queue full, TELEMETRY_FLUSH comes back with the next transmission complete event
+                break;
+            }
+
+            mHead = (mHead + count) % BUFFER_RECORDS;
+            mCount -= count;
+        }
+    }
+
+    void BleTelemetry::PeripheralEventHandler(hal::BlePeripheralEvent_t *event)
+    {
+        switch (event->peripheral_evt_id)
+        {
+        case hal::BLE_PERIPHERAL_EVENT_CONNECTED:
+            mIsNotifyEnabled = false;
+            mSampleTimer.Start(mSamplePeriodMs);
+            break;
+        case hal::BLE_PERIPHERAL_EVENT_DISCONNECTED:
+            mIsNotifyEnabled = false;
+            mSampleTimer.Stop();
+            break;
+        case hal::BLE_PERIPHERAL_EVENT_WRITE:
+            if ((event->handle == mBatchCccdHandle) && (event->data.len == 2))
+            {
+                mIsNotifyEnabled = ble_srv_is_notification_enabled(event->data.p_data);
+            }
+            else if (event->handle == mConfigHandle)
+            {
+                ApplyConfig(event->data.p_data, event->data.len);
+            }
+            break;
+        case hal::BLE_PERIPHERAL_EVENT_TX_COMPLETE:
+            BlePort::SendEvent(BlePort::Event_e::TELEMETRY_FLUSH, NULL);
+            break;
+        default:
+            break;
+        }
+    }
+
+    void BleTelemetry::ApplyConfig(const uint8_t *p_data, uint16_t len)
+    {
+        if (len < 2 * sizeof(uint16_t))
+        {
+            return;
+        }
+
+        uint16_t samplePeriodMs = p_data[0] | (p_data[1] << 8);
+        uint16_t notifyPeriodMs = p_data[2] | (p_data[3] << 8);
+
+        if (samplePeriodMs < MIN_SAMPLE_PERIOD_MS)
+        {
+            samplePeriodMs = MIN_SAMPLE_PERIOD_MS;
+        }
+
+        // A notification never carries less than a sample
+        if (notifyPeriodMs < samplePeriodMs)
+        {
+            notifyPeriodMs = samplePeriodMs;
+        }
+
+        mSamplePeriodMs = samplePeriodMs;
+        mNotifyPeriodMs = notifyPeriodMs;
+
+        // Show the applied values to the client
+        const uint8_t config[] = {
+            static_cast<uint8_t>(samplePeriodMs), static_cast<uint8_t>(samplePeriodMs >> 8),
+            static_cast<uint8_t>(notifyPeriodMs), static_cast<uint8_t>(notifyPeriodMs >> 8)};
+        hal::Ble::SetValue(mConfigHandle, config, sizeof(config));
+
+        mSampleTimer.Start(samplePeriodMs);
+    }
+
+    void BleTelemetry::EncodeRecord(const TelemetryRecord_t &record, uint8_t *p_buffer)
+    {
+        uint8_t *p_cursor = p_buffer;
+
+        p_cursor += uint16_encode(record.sequence, p_cursor);
+        *p_cursor++ = record.sessionState;
+        *p_cursor++ = record.pgoodState;
+        p_cursor += uint16_encode(static_cast<uint16_t>(record.ipgTemperature), p_cursor);
+        *p_cursor++ = record.powerLevel;
+        *p_cursor++ = record.faultFlags;
+        p_cursor += uint32_encode(record.deliveredEnergyMj, p_cursor);
+        p_cursor += uint32_encode(record.sessionDurationS, p_cursor);
+        *p_cursor++ = record.powerCap;
+        *p_cursor++ = record.powerCapFlags;
+    }
+
+    void BleTelemetry::TimerCallback(TimerHandle_t xTimer)
+    {
+        BlePort::SendEvent(BlePort::Event_e::TELEMETRY_SAMPLE, NULL);
+    }
+}
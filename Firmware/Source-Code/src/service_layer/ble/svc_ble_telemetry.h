@@ -0,0 +1,117 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_ble_telemetry.h
+ * @brief Charger GATT telemetry service
+ *
+ * @copyright Copyright (c) 2024
+ */
+
+#ifndef SVC_BLE_TELEMETRY_H
+#define SVC_BLE_TELEMETRY_H
+
+#include "hal_ble.h"
+
+#include "eda_timer.h"
+
+#include <cstdint>
+
+// Charger telemetry GATT service
+#define CHARGER_TELEMETRY_UUID_BASE {0x7B, 0x1E, 0x94, 0x02, 0xC5, 0x3A, 0x58, 0x8D, \
+                                     0x2F, 0x46, 0xB1, 0x60, 0x00, 0x00, 0x6A, 0x3E}
+#define CHARGER_TELEMETRY_SERVICE_UUID 0x2000
+#define CHARGER_TELEMETRY_STATUS_CHAR_UUID 0x2001 // Read: last record
+#define CHARGER_TELEMETRY_BATCH_CHAR_UUID 0x2002  // Notify: batch of records
+#define CHARGER_TELEMETRY_CONFIG_CHAR_UUID 0x2003 // Read / write: sample and notification periods
+
+#define CHARGER_DEVICE_NAME "Hornet Charger"
+
+namespace svc
+{
+    /// Charger state sampled on each telemetry period
+    typedef struct
+    {
+        uint16_t sequence;         // Incremented on each sample, to detect lost records
+        uint8_t sessionState;      // 1 while a charge session runs
+        uint8_t pgoodState;        // PGOOD power control state, WptManager::GetPgoodState
+        int16_t ipgTemperature;    // Degrees Celsius
+        uint8_t powerLevel;        // Transmitter pulse width step
+        uint8_t faultFlags;        // WptFault_e flags
+        uint32_t deliveredEnergyMj;
+        uint32_t sessionDurationS;
+        uint8_t powerCap;          // Highest power level the charger battery allows
+        uint8_t powerCapFlags;     // PowerCapReason_e flags
+    } TelemetryRecord_t;
+
+    class BleTelemetry
+    {
+    public:
+        // Encoded record: little endian fields, in the TelemetryRecord_t order
+        static constexpr uint16_t RECORD_SIZE = 18;
+
+        static constexpr uint16_t DEFAULT_SAMPLE_PERIOD_MS = 1000;
+        static constexpr uint16_t DEFAULT_NOTIFY_PERIOD_MS = 5000;
+        static constexpr uint16_t MIN_SAMPLE_PERIOD_MS = 100;
+
+        /// Create the GATT service and start advertising it. Called once the BLE stack is up.
+        static void Init(void);
+
+        /// Sample the charger state and notify the batch when due. Called from the BLE task.
+        static void Sample(void);
+
+        /// Notify the buffered records, as many per notification as the MTU allows. Called from the BLE task.
+        static void Flush(void);
+
+    private:
+        static constexpr uint8_t BUFFER_RECORDS = 32; // Records kept while the notification queue is full
+
+        /// Handle the events of the client link, in the SoftDevice event context
+        ///
+        /// @param event Pointer to the peripheral event
+        static void PeripheralEventHandler(hal::BlePeripheralEvent_t *event);
+
+        /// Apply the periods written by the client, clamped to the valid range
+        ///
+        /// @param p_data Written value: sample period and notification period, uint16 little endian
+        /// @param len Length of the written value
+        static void ApplyConfig(const uint8_t *p_data, uint16_t len);
+
+        /// Encode a record
+        ///
+        /// @param record Record to encode
+        /// @param p_buffer Destination, RECORD_SIZE bytes
+        static void EncodeRecord(const TelemetryRecord_t &record, uint8_t *p_buffer);
+
+        /// Callback function for the sample timer
+        ///
+        /// @param xTimer Handle to the timer
+        static void TimerCallback(TimerHandle_t xTimer);
+
+        static eda::Timer mSampleTimer;
+
+        static uint16_t mStatusHandle;
+
+        static uint16_t mBatchHandle;
+
+        static uint16_t mBatchCccdHandle;
+
+        static uint16_t mConfigHandle;
+
+        static volatile bool mIsNotifyEnabled;
+
+        static volatile uint16_t mSamplePeriodMs;
+
+        static volatile uint16_t mNotifyPeriodMs;
+
+        static uint16_t mSequence;
+
+        static uint16_t mSamplesSinceFlush;
+
+        static TelemetryRecord_t mRecords[BUFFER_RECORDS];
+
+        static uint8_t mHead;
+
+        static uint8_t mCount;
+    };
+}
+
+#endif // SVC_BLE_TELEMETRY_H
@@ -9,7 +9,9 @@
 #include "svc_pmc_state_charging_battery.h"
 
 #include "eda_manager_log_config.h"
+#include "hal_buzzer.h"
 
+#include "svc_pmc_fuel_gauge.h"
 #include "svc_pmc_port.h"
 #include "svc_pmc_state_machine.h"
 
@@ -24,6 +26,7 @@ namespace svc
     void PmcStateChargingBattery::Entry()
     {
         mPmcManager.EnableBatteryCharger();
+        FuelGauge::Instance().SetCharging(true);
         LOG_DEBUG("PMC State Machine: Charging Battery Entry\n");
     }
 
@@ -73,6 +76,11 @@ namespace svc
             LOG_DEBUG("PMC State Machine Charging Battery state: Battery Present Indicator\n");
             break;
         }
+        case PmcPort::Event_e::PMC_READ_FAST_CHARGER_INDICATOR:
+        {
+            LOG_DEBUG("PMC State Machine Charging Battery state: Fast Charge Indicator\n");
+            break;
+        }
         case PmcPort::Event_e::PMC_FAULT_CONDITION:
         {
             /** @TODO: Handle the PMC fault conditions */
@@ -80,6 +88,22 @@ namespace svc
             PmcPort::SendEvent(PmcPort::Event_e::PMC_POWER_OFF, NULL);
             break;
         }
+        case PmcPort::Event_e::PMC_BATTERY_LOW:
+        {
+            LOG_INFO("PMC State Machine Charging Battery state: Battery Low, SoC %d permille\n", optDataAddress);
+            break;
+        }
+        case PmcPort::Event_e::PMC_BATTERY_CRITICAL:
+        {
+            LOG_WARNING("PMC State Machine Charging Battery state: Battery Critical, SoC %d permille\n", optDataAddress);
+            hal::Buzzer::playMelody(hal::MELODY_ALARM);
+            break;
+        }
+        case PmcPort::Event_e::PMC_BATTERY_NORMAL:
+        {
+            LOG_INFO("PMC State Machine Charging Battery state: Battery Normal, SoC %d permille\n", optDataAddress);
+            break;
+        }
         default:
         {
             ASSERT(false);
@@ -91,6 +115,7 @@ namespace svc
     void PmcStateChargingBattery::Exit()
     {
         mPmcManager.DisableBatteryCharger();
+        FuelGauge::Instance().SetCharging(false);
         LOG_DEBUG("PMC State Machine: Charging Battery Exit\n");
     }
 }
@@ -9,6 +9,7 @@
 #include "svc_pmc_state_enable.h"
 
 #include "eda_manager_log_config.h"
+#include "hal_buzzer.h"
 
 #include "svc_pmc_port.h"
 #include "svc_pmc_state_machine.h"
@@ -68,6 +69,42 @@ namespace svc
             PmcPort::SendEvent(PmcPort::Event_e::PMC_POWER_OFF, NULL);
             break;
         }
+        case PmcPort::Event_e::PMC_BATTERY_CHARGED:
+        {
+            LOG_DEBUG("PMC State Machine Enable state: Battery Full Charged\n");
+            break;
+        }
+        case PmcPort::Event_e::PMC_BATTERY_CHARGING:
+        {
+            LOG_DEBUG("PMC State Machine Enable state: Battery Charging\n");
+            break;
+        }
+        case PmcPort::Event_e::PMC_READ_FAST_CHARGER_INDICATOR:
+        {
+            LOG_DEBUG("PMC State Machine Enable state: Fast Charge Indicator\n");
+            break;
+        }
+        case PmcPort::Event_e::PMC_READ_CHARGER_PRESENT_INDICATOR:
+        {
+            LOG_DEBUG("PMC State Machine Enable state: Battery Present Indicator\n");
+            break;
+        }
+        case PmcPort::Event_e::PMC_BATTERY_LOW:
+        {
+            LOG_INFO("PMC State Machine Enable state: Battery Low, SoC %d permille\n", optDataAddress);
+            break;
+        }
+        case PmcPort::Event_e::PMC_BATTERY_CRITICAL:
+        {
+            LOG_WARNING("PMC State Machine Enable state: Battery Critical, SoC %d permille\n", optDataAddress);
+            hal::Buzzer::playMelody(hal::MELODY_ALARM);
+            break;
+        }
+        case PmcPort::Event_e::PMC_BATTERY_NORMAL:
+        {
+            LOG_INFO("PMC State Machine Enable state: Battery Normal, SoC %d permille\n", optDataAddress);
+            break;
+        }
         default:
         {
             ASSERT(false);
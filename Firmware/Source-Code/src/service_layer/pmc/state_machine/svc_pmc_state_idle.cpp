@@ -9,6 +9,7 @@
 #include "svc_pmc_state_idle.h"
 
 #include "eda_manager_log_config.h"
+#include "hal_buzzer.h"
 
 #include "svc_pmc_port.h"
 #include "svc_pmc_state_machine.h"
@@ -77,6 +78,31 @@ namespace svc
         {
             break;
         }
+        case PmcPort::Event_e::PMC_BATTERY_CHARGED:
+        {
+            break;
+        }
+        case PmcPort::Event_e::PMC_FAULT_CONDITION:
+        {
+            LOG_DEBUG("PMC State Machine Idle state: PMC Fault Condition\n");
+            break;
+        }
+        case PmcPort::Event_e::PMC_BATTERY_LOW:
+        {
+            LOG_INFO("PMC State Machine Idle state: Battery Low, SoC %d permille\n", optDataAddress);
+            break;
+        }
+        case PmcPort::Event_e::PMC_BATTERY_CRITICAL:
+        {
+            LOG_WARNING("PMC State Machine Idle state: Battery Critical, SoC %d permille\n", optDataAddress);
+            hal::Buzzer::playMelody(hal::MELODY_ALARM);
+            break;
+        }
+        case PmcPort::Event_e::PMC_BATTERY_NORMAL:
+        {
+            LOG_INFO("PMC State Machine Idle state: Battery Normal, SoC %d permille\n", optDataAddress);
+            break;
+        }
         default:
         {
             ASSERT(false);
@@ -0,0 +1,219 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_pmc_edge_filter.cpp
+ * @brief Debounce and pulse decoding of indicator input pins
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "svc_pmc_edge_filter.h"
+
+#include "eda_manager_log_config.h"
+#include "hal_gpio.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+namespace svc
+{
+    eda::Timer EdgeFilter::mTimer("EdgeFilterTimer", FILTER_PERIOD_MS, 0, TimerCallback);
+
+    EdgeFilter &EdgeFilter::Instance()
+    {
+        static EdgeFilter instance;
+        return instance;
+    }
+
+    EdgeFilter::EdgeFilter() : mChannels(), mChannelCount(0), mIsTimerArmed(false)
+    {
+    }
+
+    uint8_t EdgeFilter::AddChannel(uint32_t pin, uint32_t debounceMs, uint32_t pulseWindowMs, StateChangedCallback_t callback)
+    {
+        if (mChannelCount >= MAX_CHANNELS)
+        {
+            LOG_ERROR("Edge Filter: too many channels. Max allowed: %d\n", MAX_CHANNELS);
+            return INVALID_CHANNEL;
+        }
+
+        Channel_t &channel = mChannels[mChannelCount];
+
+        channel.pin = pin;
+        channel.debounceTicks = pdMS_TO_TICKS(debounceMs);
+        channel.pulseWindowTicks = pdMS_TO_TICKS(pulseWindowMs);
+        channel.callback = callback;
+        channel.isEdgePending = false;
+        channel.lastEdgeTicks = 0;
+        channel.level = hal::Gpio::Read(pin);
+        channel.transitionCount = 0;
+        channel.lastTransitionTicks = 0;
+        channel.state = (channel.level != 0) ? PinState_e::HIGH : PinState_e::LOW;
+        channel.counters = {};
+
+        // The interrupt ignores the channel until it is counted
+        return mChannelCount++;
+    }
+
+    void EdgeFilter::OnEdgeFromISR(uint8_t channel)
+    {
+        if (channel >= mChannelCount)
+        {
+            return;
+        }
+
+        Channel_t &entry = mChannels[channel];
+
+        // Edges inside the debounce window are merged, only the quiet time restarts
+        entry.counters.edges++;
+        if (entry.isEdgePending)
+        {
+            entry.counters.bounces++;
+        }
+
+        entry.lastEdgeTicks = static_cast<uint32_t>(xTaskGetTickCountFromISR());
+        entry.isEdgePending = true;
+
+        if (!mIsTimerArmed)
+        {
+            mIsTimerArmed = true;
+            mTimer.StartFromISR();
+        }
+    }
+
+    EdgeFilter::PinState_e EdgeFilter::GetState(uint8_t channel) const
+    {
+        return (channel < mChannelCount) ? mChannels[channel].state : PinState_e::UNKNOWN;
+    }
+
+    bool EdgeFilter::GetCounters(uint8_t channel, Counters_t &counters) const
+    {
+        if (channel >= mChannelCount)
+        {
+            return false;
+        }
+
+        taskENTER_CRITICAL();
+        counters = mChannels[channel].counters;
+        taskEXIT_CRITICAL();
+
+        return true;
+    }
+
+    void EdgeFilter::TimerCallback(TimerHandle_t xTimer)
+    {
+        Instance().Process();
+    }
+
+    void EdgeFilter::Process()
+    {
+        const uint32_t nowTicks = static_cast<uint32_t>(xTaskGetTickCount());
+        bool isActive = false;
+
+        for (uint8_t i = 0; i < mChannelCount; i++)
+        {
+            isActive |= ProcessChannel(i, nowTicks);
+        }
+
+        // Disarm only if no edge came in meanwhile, the next edge then starts the timer again
+        taskENTER_CRITICAL();
+        for (uint8_t i = 0; i < mChannelCount; i++)
+        {
+            isActive |= mChannels[i].isEdgePending;
+        }
+
+        if (!isActive)
+        {
+            mIsTimerArmed = false;
+        }
+        taskEXIT_CRITICAL();
+
+        if (isActive)
+        {
+            mTimer.Start();
+        }
+    }
+
+    bool EdgeFilter::ProcessChannel(uint8_t channel, uint32_t nowTicks)
+    {
+        Channel_t &entry = mChannels[channel];
+
+        taskENTER_CRITICAL();
+        const bool isSettled = entry.isEdgePending && ((nowTicks - entry.lastEdgeTicks) >= entry.debounceTicks);
+        if (isSettled)
+        {
+            entry.isEdgePending = false;
+        }
+        const bool isBouncing = entry.isEdgePending;
+        taskEXIT_CRITICAL();
+
+        if (isBouncing)
+        {
+            return true;
+        }
+
+        if (isSettled)
+        {
+            const uint8_t level = hal::Gpio::Read(entry.pin);
+
+            if (level == entry.level)
+            {
+                // The pin went back to its previous level within the window
+                entry.counters.glitches++;
+            }
+            else
+            {
+                entry.level = level;
+                entry.counters.transitions++;
+
+                if ((entry.transitionCount != 0) && ((nowTicks - entry.lastTransitionTicks) <= entry.pulseWindowTicks))
+                {
+                    if (entry.transitionCount < UINT8_MAX)
+                    {
+                        entry.transitionCount++;
+                    }
+                }
+                else
+                {
+                    entry.transitionCount = 1;
+                }
+                entry.lastTransitionTicks = nowTicks;
+            }
+        }
+
+        bool isActive = false;
+        PinState_e state = entry.state;
+
+        if ((entry.pulseWindowTicks == 0) || (entry.transitionCount == 0) ||
+            ((nowTicks - entry.lastTransitionTicks) > entry.pulseWindowTicks))
+        {
+            // Level held for the pulse window, or no pulse decoding on this channel
+            state = (entry.level != 0) ? PinState_e::HIGH : PinState_e::LOW;
+            entry.transitionCount = 0;
+        }
+        else
+        {
+            // Too early to tell a level change from a pulse, the published state is kept meanwhile
+            if (entry.transitionCount >= PULSE_MIN_TRANSITIONS)
+            {
+                state = PinState_e::PULSING;
+            }
+            isActive = true;
+        }
+
+        if (state != entry.state)
+        {
+            entry.state = state;
+            entry.counters.published++;
+
+            LOG_DEBUG("Edge Filter: pin %d state %d, %d edges\n", entry.pin, static_cast<uint8_t>(state), entry.counters.edges);
+
+            if (entry.callback != nullptr)
+            {
+                entry.callback(channel, state);
+            }
+        }
+
+        return isActive;
+    }
+}
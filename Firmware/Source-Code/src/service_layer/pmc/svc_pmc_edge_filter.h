@@ -0,0 +1,125 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_pmc_edge_filter.h
+ * @brief Debounce and pulse decoding of indicator input pins
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SVC_PMC_EDGE_FILTER_H
+#define SVC_PMC_EDGE_FILTER_H
+
+#include "eda_timer.h"
+
+#include <cstdint>
+
+namespace svc
+{
+    class EdgeFilter
+    {
+    public:
+        static constexpr uint8_t MAX_CHANNELS = 4;           // Pins filtered at once
+        static constexpr uint8_t INVALID_CHANNEL = 0xFF;
+        static constexpr uint32_t FILTER_PERIOD_MS = 10;     // Evaluation period while edges are pending
+        static constexpr uint8_t PULSE_MIN_TRANSITIONS = 4;  // Transitions in a row, each within the pulse window, to decode a pulsing pin
+
+        /// Decoded state of a pin
+        enum class PinState_e : uint8_t
+        {
+            LOW,
+            HIGH,
+            PULSING,
+            UNKNOWN
+        };
+
+        /// Called from the timer task when the decoded state of a channel changes
+        using StateChangedCallback_t = void (*)(uint8_t channel, PinState_e state);
+
+        /// Edge counters of a channel, edges - published is the number of suppressed edges
+        typedef struct
+        {
+            uint32_t edges;       // Edges seen by the interrupt
+            uint32_t bounces;     // Edges merged in a debounce window
+            uint32_t glitches;    // Debounced edges back to the previous level
+            uint32_t transitions; // Debounced level changes, published or not
+            uint32_t published;   // State changes given to the callback
+        } Counters_t;
+
+        /// Returns the edge filter instance.
+        static EdgeFilter &Instance();
+
+        /// Adds a pin to the filter. The current level is taken as the initial state, it is not published.
+        /// The pin must already be configured as an input with its pull resistor.
+        ///
+        /// @param pin Pin number, read again once the edges settle
+        /// @param debounceMs Quiet time needed after an edge before the level is read
+        /// @param pulseWindowMs Maximum time between the transitions of a pulsing pin, 0 disables the pulse decoding.
+        ///                      A level is published only after being held for this time.
+        /// @param callback Function called on a state change
+        /// @return Channel number, INVALID_CHANNEL if the table is full
+        uint8_t AddChannel(uint32_t pin, uint32_t debounceMs, uint32_t pulseWindowMs, StateChangedCallback_t callback);
+
+        /// Records an edge of a channel. Called from the GPIOTE interrupt.
+        ///
+        /// @param channel Channel number returned by AddChannel
+        void OnEdgeFromISR(uint8_t channel);
+
+        /// Returns the last published state of a channel.
+        PinState_e GetState(uint8_t channel) const;
+
+        /// Gets the edge counters of a channel.
+        ///
+        /// @param channel Channel number
+        /// @param counters Copy of the counters
+        /// @return false if the channel does not exist
+        bool GetCounters(uint8_t channel, Counters_t &counters) const;
+
+    private:
+        typedef struct
+        {
+            uint32_t pin;
+            uint32_t debounceTicks;
+            uint32_t pulseWindowTicks;
+            StateChangedCallback_t callback;
+
+            volatile bool isEdgePending;      // Set by the interrupt, cleared once the level is read
+            volatile uint32_t lastEdgeTicks;  // Written by the interrupt
+
+            uint8_t level;                    // Debounced level
+            uint8_t transitionCount;          // Transitions in a row, each within the pulse window
+            uint32_t lastTransitionTicks;
+            PinState_e state;                 // Last published state
+
+            Counters_t counters;
+        } Channel_t;
+
+        /// Construct EdgeFilter
+        EdgeFilter();
+
+        /// Callback function for the filter timer
+        ///
+        /// @param xTimer Handle to the timer
+        static void TimerCallback(TimerHandle_t xTimer);
+
+        /// Debounces the pending edges and publishes the state changes, timer task context.
+        void Process();
+
+        /// Updates one channel.
+        ///
+        /// @param channel Channel to update
+        /// @param nowTicks Current tick count
+        /// @return true while the channel needs more evaluations
+        bool ProcessChannel(uint8_t channel, uint32_t nowTicks);
+
+        static eda::Timer mTimer;
+
+        Channel_t mChannels[MAX_CHANNELS];
+
+        uint8_t mChannelCount;
+
+        volatile bool mIsTimerArmed;
+    };
+}
+
+#endif // SVC_PMC_EDGE_FILTER_H
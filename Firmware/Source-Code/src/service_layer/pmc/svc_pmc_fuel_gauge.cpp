@@ -0,0 +1,221 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_pmc_fuel_gauge.cpp
+ * @brief Charger battery state of charge estimator
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "svc_pmc_fuel_gauge.h"
+
+#include "eda_manager_log_config.h"
+#include "svc_pmc_port.h"
+#include "svc_wpt_manager.h"
+#include "svc_wpt_session.h"
+
+namespace svc
+{
+    // Rest voltage of a Li-ion cell against its charge, ascending voltages
+    const FuelGauge::OcvPoint_t FuelGauge::OCV_TABLE[OCV_TABLE_SIZE] = {
+        {3000, 0},
+        {3300, 20},
+        {3500, 50},
+        {3600, 100},
+        {3680, 200},
+        {3740, 300},
+        {3780, 400},
+        {3820, 500},
+        {3870, 600},
+        {3930, 700},
+        {4000, 800},
+        {4080, 900},
+        {4180, 1000},
+    };
+
+    FuelGauge &FuelGauge::Instance()
+    {
+        static FuelGauge instance;
+        return instance;
+    }
+
+    FuelGauge::FuelGauge() : mIsInitialized(false),
+                             mIsCharging(false),
+                             mSocFiltered(0),
+                             mSessionEnergyMj(DEFAULT_SESSION_ENERGY_MJ),
+                             mLevel(BatteryLevel_e::NORMAL)
+    {
+    }
+
+    void FuelGauge::Update(int16_t voltageMv)
+    {
+        if (voltageMv <= 0)
+        {
+            return;
+        }
+
+        // mA * mOhm = uV
+        const int32_t dropMv = (EstimateLoadCurrentMa() * static_cast<int32_t>(BATTERY_INTERNAL_RESISTANCE_MOHM)) / 1000;
+        const int32_t ocvMv = voltageMv + dropMv;
+        const uint16_t socPermille = SocFromOcv(ocvMv);
+
+        if (!mIsInitialized)
+        {
+            // Start from the first estimate instead of ramping up from empty
+            mSocFiltered = static_cast<uint32_t>(socPermille) << SOC_FILTER_SHIFT;
+            mIsInitialized = true;
+        }
+        else
+        {
+            mSocFiltered = mSocFiltered - (mSocFiltered >> SOC_FILTER_SHIFT) + socPermille;
+        }
+
+        LOG_DEBUG("Fuel Gauge: %d mV, OCV %d mV, SoC %d permille, filtered %d permille\n",
+                  voltageMv, ocvMv, socPermille, GetSocPermille());
+
+        UpdateLevel();
+    }
+
+    void FuelGauge::SetCharging(bool isCharging)
+    {
+        mIsCharging = isCharging;
+    }
+
+    void FuelGauge::RecordSession(uint32_t transmittedEnergyMj, uint32_t durationS)
+    {
+        if ((durationS < MIN_SESSION_DURATION_S) || (transmittedEnergyMj < MIN_SESSION_ENERGY_MJ))
+        {
+            LOG_DEBUG("Fuel Gauge: session of %u s, %u mJ not learned\n", durationS, transmittedEnergyMj);
+            return;
+        }
+
+        // Exponential average, in unsigned arithmetic both ways
+        if (transmittedEnergyMj > mSessionEnergyMj)
+        {
+            mSessionEnergyMj += (transmittedEnergyMj - mSessionEnergyMj) >> SESSION_ENERGY_FILTER_SHIFT;
+        }
+        else
+        {
+            mSessionEnergyMj -= (mSessionEnergyMj - transmittedEnergyMj) >> SESSION_ENERGY_FILTER_SHIFT;
+        }
+
+        LOG_INFO("Fuel Gauge: session energy estimate %u mJ, %d sessions left\n", mSessionEnergyMj, GetRemainingSessions());
+    }
+
+    uint16_t FuelGauge::GetSocPermille() const
+    {
+        return static_cast<uint16_t>(mSocFiltered >> SOC_FILTER_SHIFT);
+    }
+
+    uint16_t FuelGauge::GetRemainingSessions() const
+    {
+        const uint64_t remainingMj = (static_cast<uint64_t>(BATTERY_CAPACITY_MJ) * GetSocPermille()) / 1000;
+
+        // A session never costs less than the floor, the estimate cannot run away to huge counts
+        const uint32_t sessionEnergyMj = (mSessionEnergyMj > MIN_SESSION_ENERGY_MJ) ? mSessionEnergyMj : MIN_SESSION_ENERGY_MJ;
+
+        return static_cast<uint16_t>(remainingMj / sessionEnergyMj);
+    }
+
+    BatteryLevel_e FuelGauge::GetLevel() const
+    {
+        return mLevel;
+    }
+
+    int32_t FuelGauge::EstimateLoadCurrentMa() const
+    {
+        if (mIsCharging)
+        {
+            return -static_cast<int32_t>(BATTERY_CHARGE_CURRENT_MA);
+        }
+
+        uint32_t loadMa = BASE_LOAD_MA;
+        const WptSession &session = WptSession::Instance();
+
+        if (session.IsRunning())
+        {
+            const uint32_t transmitterMa = session.GetInputCurrentMa();
+
+            // Before the first IMON sample the transmitter current is taken from the power level
+            loadMa += (transmitterMa != 0) ? transmitterMa : (WptManager::Instance().GetPowerLevel() * LOAD_MA_PER_POWER_LEVEL);
+        }
+
+        return static_cast<int32_t>(loadMa);
+    }
+
+    uint16_t FuelGauge::SocFromOcv(int32_t ocvMv)
+    {
+        if (ocvMv <= OCV_TABLE[0].voltageMv)
+        {
+            return OCV_TABLE[0].socPermille;
+        }
+
+        for (uint8_t i = 1; i < OCV_TABLE_SIZE; i++)
+        {
+            if (ocvMv < OCV_TABLE[i].voltageMv)
+            {
+                const int32_t spanMv = OCV_TABLE[i].voltageMv - OCV_TABLE[i - 1].voltageMv;
+                const int32_t spanPermille = OCV_TABLE[i].socPermille - OCV_TABLE[i - 1].socPermille;
+
+                return static_cast<uint16_t>(OCV_TABLE[i - 1].socPermille +
+                                             ((ocvMv - OCV_TABLE[i - 1].voltageMv) * spanPermille) / spanMv);
+            }
+        }
+
+        return OCV_TABLE[OCV_TABLE_SIZE - 1].socPermille;
+    }
+
+    void FuelGauge::UpdateLevel()
+    {
+        const uint16_t socPermille = GetSocPermille();
+        BatteryLevel_e level = mLevel;
+
+        // Going down is immediate, going up needs the hysteresis margin
+        if (socPermille <= BATTERY_CRITICAL_SOC_PERMILLE)
+        {
+            level = BatteryLevel_e::CRITICAL;
+        }
+        else if (socPermille <= BATTERY_LOW_SOC_PERMILLE)
+        {
+            if ((mLevel != BatteryLevel_e::CRITICAL) ||
+                (socPermille > BATTERY_CRITICAL_SOC_PERMILLE + BATTERY_SOC_HYSTERESIS_PERMILLE))
+            {
+                level = BatteryLevel_e::LOW;
+            }
+        }
+        else if ((mLevel == BatteryLevel_e::NORMAL) ||
+                 (socPermille > BATTERY_LOW_SOC_PERMILLE + BATTERY_SOC_HYSTERESIS_PERMILLE))
+        {
+            level = BatteryLevel_e::NORMAL;
+        }
+        else
+        {
+            // Back above the low threshold, within its hysteresis band
+            level = BatteryLevel_e::LOW;
+        }
+
+        if (level == mLevel)
+        {
+            return;
+        }
+
+        mLevel = level;
+
+        LOG_INFO("Fuel Gauge: battery level %d, SoC %d permille, %d sessions left\n",
+                 static_cast<uint8_t>(level), socPermille, GetRemainingSessions());
+
+        // The optional data is the SoC in permille
+        switch (level)
+        {
+        case BatteryLevel_e::CRITICAL:
+            PmcPort::SendEvent(PmcPort::Event_e::PMC_BATTERY_CRITICAL, socPermille);
+            break;
+        case BatteryLevel_e::LOW:
+            PmcPort::SendEvent(PmcPort::Event_e::PMC_BATTERY_LOW, socPermille);
+            break;
+        default:
+            PmcPort::SendEvent(PmcPort::Event_e::PMC_BATTERY_NORMAL, socPermille);
+            break;
+        }
+    }
+}
@@ -0,0 +1,120 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_pmc_fuel_gauge.h
+ * @brief Charger battery state of charge estimator
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SVC_PMC_FUEL_GAUGE_H
+#define SVC_PMC_FUEL_GAUGE_H
+
+#include <cstdint>
+
+namespace svc
+{
+    /// State of charge thresholds, a PMC event is sent when the filtered SoC crosses one
+    static constexpr uint16_t BATTERY_LOW_SOC_PERMILLE = 200;      // 20 % (adjust as needed)
+    static constexpr uint16_t BATTERY_CRITICAL_SOC_PERMILLE = 50;  // 5 % (adjust as needed)
+    static constexpr uint16_t BATTERY_SOC_HYSTERESIS_PERMILLE = 20; // Rise needed to leave a level
+
+    /// Battery level reported with the PMC battery events
+    enum class BatteryLevel_e : uint8_t
+    {
+        NORMAL,
+        LOW,
+        CRITICAL
+    };
+
+    class FuelGauge
+    {
+    public:
+        /// Returns the fuel gauge instance.
+        static FuelGauge &Instance();
+
+        /// Feeds a battery voltage measurement, compensated for the present load.
+        ///
+        /// The SoC filter weighs each call the same, it must be called at a fixed period from a single task.
+        ///
+        /// @param voltageMv Battery terminal voltage
+        void Update(int16_t voltageMv);
+
+        /// Tells whether the battery charger is running, the terminal voltage is then above the OCV.
+        ///
+        /// @param isCharging true while the charger IC is enabled
+        void SetCharging(bool isCharging);
+
+        /// Accounts the energy of a finished charge session in the session energy estimate.
+        ///
+        /// Sessions shorter than MIN_SESSION_DURATION_S, or below MIN_SESSION_ENERGY_MJ, are interrupted
+        /// placements rather than charges and are not learned from.
+        ///
+        /// @param transmittedEnergyMj Energy drawn by the transmitter over the session
+        /// @param durationS Duration of the session
+        void RecordSession(uint32_t transmittedEnergyMj, uint32_t durationS);
+
+        /// Returns the filtered state of charge, in permille.
+        uint16_t GetSocPermille() const;
+
+        /// Returns the number of full charge sessions the remaining energy allows.
+        uint16_t GetRemainingSessions() const;
+
+        /// Returns the battery level last reported.
+        BatteryLevel_e GetLevel() const;
+
+    private:
+        // Li-ion cell model
+        static constexpr uint32_t BATTERY_CAPACITY_MJ = 26640000;         // 2000 mAh at 3.7 V
+        static constexpr uint32_t BATTERY_INTERNAL_RESISTANCE_MOHM = 150; // Cell and protection circuit
+        static constexpr uint32_t BATTERY_CHARGE_CURRENT_MA = 500;        // Charger IC current set by ISET
+
+        // Load of the charger, the transmitter input current is added on top
+        static constexpr uint32_t BASE_LOAD_MA = 15;             // MCU, radio and regulators
+        static constexpr uint32_t LOAD_MA_PER_POWER_LEVEL = 40;  // Transmitter current per power level, when IMON is not sampled yet
+
+        static constexpr uint8_t SOC_FILTER_SHIFT = 3; // Weight of a new estimate: 1/8
+
+        // Session energy estimate, learned from the finished sessions
+        static constexpr uint32_t DEFAULT_SESSION_ENERGY_MJ = 4000000; // About one hour at 1.1 W
+        static constexpr uint32_t MIN_SESSION_DURATION_S = 300;        // Shorter sessions are not representative
+        static constexpr uint32_t MIN_SESSION_ENERGY_MJ = 500000;      // Floor of the estimate, an eighth of the default session
+        static constexpr uint8_t SESSION_ENERGY_FILTER_SHIFT = 2;      // Weight of a new session: 1/4
+
+        struct OcvPoint_t
+        {
+            uint16_t voltageMv;
+            uint16_t socPermille;
+        };
+
+        static constexpr uint8_t OCV_TABLE_SIZE = 13;
+
+        static const OcvPoint_t OCV_TABLE[OCV_TABLE_SIZE];
+
+        /// Construct FuelGauge
+        FuelGauge();
+
+        /// Estimates the battery current, positive when discharging.
+        int32_t EstimateLoadCurrentMa() const;
+
+        /// Interpolates the OCV curve.
+        ///
+        /// @param ocvMv Open circuit voltage
+        /// @return State of charge in permille
+        static uint16_t SocFromOcv(int32_t ocvMv);
+
+        /// Sends a PMC event when the filtered SoC crosses a threshold.
+        void UpdateLevel();
+
+        bool mIsInitialized;
+        bool mIsCharging;
+
+        uint32_t mSocFiltered; // Permille, scaled by 2^SOC_FILTER_SHIFT
+
+        uint32_t mSessionEnergyMj;
+
+        BatteryLevel_e mLevel;
+    };
+}
+
+#endif // SVC_PMC_FUEL_GAUGE_H
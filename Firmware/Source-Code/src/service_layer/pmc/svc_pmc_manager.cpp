@@ -8,6 +8,7 @@
  */
 
 #include "svc_pmc_manager.h"
+#include "svc_pmc_fuel_gauge.h"
 
 #include "eda_manager_log_config.h"
 
@@ -28,6 +29,10 @@ namespace svc
     void PmcManager::ConfigureGpios()
     {  
         LOG_DEBUG("PMC Manager: ConfigGpios\n");
+
+        // Both enables are latched inactive before they become outputs, so neither glitches on
+        EnablePins::Write((ENABLE_INACTIVE_LEVEL != 0) ? EnablePins::ALL_PINS : 0);
+
         hal::Gpio::gpio_config_t vccEnablePinConfig = {
             .pin_number = mVccEnablePin,
             .direction = hal::Gpio::gpio_pin_dir_t::NRF_GPIO_PIN_DIR_OUTPUT,
@@ -37,7 +42,6 @@ namespace svc
             .sense = hal::Gpio::gpio_pin_sense_t::NRF_GPIO_PIN_NOSENSE};
 
         hal::Gpio::ConfigurePin(vccEnablePinConfig);
-        hal::Gpio::Write(mVccEnablePin, ENABLE_INACTIVE_LEVEL);
 
         hal::Gpio::gpio_config_t ChgEnablePinConfig = {
             .pin_number = mChgEnablePin,
@@ -48,7 +52,6 @@ namespace svc
             .sense = hal::Gpio::gpio_pin_sense_t::NRF_GPIO_PIN_NOSENSE};
 
         hal::Gpio::ConfigurePin(ChgEnablePinConfig);
-        hal::Gpio::Write(mChgEnablePin, ENABLE_INACTIVE_LEVEL);
 
         nrf_drv_gpiote_in_config_t ChgPresentIndicatorPinConfig = NRFX_GPIOTE_CONFIG_IN_SENSE_TOGGLE(true);
         ChgPresentIndicatorPinConfig.pull = NRF_GPIO_PIN_PULLUP;
@@ -74,6 +77,29 @@ namespace svc
                                 ChgFastChargeIndicatorPinConfig,
                                 StaticReadBatteryFastChargeIndicator);
 
+        // The indicators are open-drain outputs, their edges are debounced before any PMC event is sent.
+        // Channels are added once the pull-ups are in place, so they start from the real level, and
+        // edges seen before that are ignored by the filter.
+        EdgeFilter &edgeFilter = EdgeFilter::Instance();
+
+        mChrPwrPresentIndicatorChannel = edgeFilter.AddChannel(mChrPwrPresentIndicatorPin,
+                                                               INDICATOR_DEBOUNCE_MS,
+                                                               0,
+                                                               StaticIndicatorChanged);
+        mChgChargeIndicatorChannel = edgeFilter.AddChannel(mChgChargeIndicatorPin,
+                                                           INDICATOR_DEBOUNCE_MS,
+                                                           CHARGE_INDICATOR_PULSE_WINDOW_MS,
+                                                           StaticIndicatorChanged);
+        mChgFastChargeIndicatorChannel = edgeFilter.AddChannel(mChgFastChargeIndicatorPin,
+                                                               INDICATOR_DEBOUNCE_MS,
+                                                               0,
+                                                               StaticIndicatorChanged);
+
+        // The filter only reports changes, the level found at start up is published once here
+        ReadBatteryChargerPresentIndicator();
+        ReadBatteryChargeIndicator();
+        ReadBatteryFastChargeIndicator();
+
         hal::Gpio::gpio_config_t mChrCurrentSettingsPinConfig = {
             .pin_number = mChrCurrentSettingsPin,
             .direction = hal::Gpio::gpio_pin_dir_t::NRF_GPIO_PIN_DIR_INPUT,
@@ -121,9 +147,42 @@ namespace svc
         LOG_DEBUG("PMC Manager: GetBatteryVoltage\n");
     }
 
+    void PmcManager::UpdateFuelGauge()
+    {
+        GetBatteryVoltage();
+        FuelGauge::Instance().Update(mBatteryVoltage);
+    }
+
     void PmcManager::StaticReadBatteryChargerPresentIndicator()
     {
-        Instance().ReadBatteryChargerPresentIndicator();
+        EdgeFilter::Instance().OnEdgeFromISR(Instance().mChrPwrPresentIndicatorChannel);
+    }
+
+    void PmcManager::StaticIndicatorChanged(uint8_t channel, EdgeFilter::PinState_e state)
+    {
+        PmcManager &pmcManager = Instance();
+
+        if (channel == pmcManager.mChrPwrPresentIndicatorChannel)
+        {
+            pmcManager.ReadBatteryChargerPresentIndicator();
+        }
+        else if (channel == pmcManager.mChgChargeIndicatorChannel)
+        {
+            if (state == EdgeFilter::PinState_e::PULSING)
+            {
+                // A blinking charge indicator reports a charger fault
+                LOG_WARNING("PMC Manager: charge indicator pulsing\n");
+                PmcPort::SendEvent(PmcPort::Event_e::PMC_FAULT_CONDITION, NULL);
+            }
+            else
+            {
+                pmcManager.ReadBatteryChargeIndicator();
+            }
+        }
+        else if (channel == pmcManager.mChgFastChargeIndicatorChannel)
+        {
+            pmcManager.ReadBatteryFastChargeIndicator();
+        }
     }
 
     void PmcManager::ReadBatteryChargerPresentIndicator()
@@ -140,7 +199,7 @@ namespace svc
 
     void PmcManager::StaticReadBatteryChargeIndicator()
     {
-        Instance().ReadBatteryChargeIndicator();
+        EdgeFilter::Instance().OnEdgeFromISR(Instance().mChgChargeIndicatorChannel);
     }
 
     void PmcManager::ReadBatteryChargeIndicator()
@@ -161,7 +220,7 @@ namespace svc
 
     void PmcManager::StaticReadBatteryFastChargeIndicator()
     {
-        Instance().ReadBatteryFastChargeIndicator();
+        EdgeFilter::Instance().OnEdgeFromISR(Instance().mChgFastChargeIndicatorChannel);
     }
 
     void PmcManager::ReadBatteryFastChargeIndicator()
@@ -176,6 +235,13 @@ namespace svc
         }
     }
 
+    bool PmcManager::IsChargerPowerPresent() const
+    {
+        const EdgeFilter::PinState_e activeState = (READ_ACTIVE_LEVEL != 0) ? EdgeFilter::PinState_e::HIGH : EdgeFilter::PinState_e::LOW;
+
+        return EdgeFilter::Instance().GetState(mChrPwrPresentIndicatorChannel) == activeState;
+    }
+
     void PmcManager::ReadBatteryCurrentSettings()
     {
         uint8_t mIset = 0;
@@ -10,6 +10,7 @@
 #ifndef SVC_PMC_MANAGER_H
 #define SVC_PMC_MANAGER_H
 
+#include "svc_pmc_edge_filter.h"
 #include "svc_pmc_port.h"
 
 #include "hal_battery.h"
@@ -41,6 +42,11 @@ namespace svc
         /// This method gets the battery voltage level.
         void GetBatteryVoltage();
 
+        /// Measures the battery voltage and feeds it to the fuel gauge.
+        ///
+        /// The gauge filter assumes a fixed sample rate, so this is only called from the heartbeat.
+        void UpdateFuelGauge();
+
         /// This method disables the Battery Charge IC.
         void DisableBatteryCharger();
 
@@ -68,6 +74,9 @@ namespace svc
 
         void ReadBatteryCurrentSettings();
 
+        /// Returns true while the charger IC reports an input supply, from the debounced indicator.
+        bool IsChargerPowerPresent() const;
+
         int16_t mBatteryVoltage;
 
     private:
@@ -79,10 +88,24 @@ namespace svc
         static constexpr uint32_t READ_INACTIVE_LEVEL = 0;
         static constexpr uint32_t READ_ACTIVE_LEVEL = 1;
 
+        // Regulator and charger enables, driven together in a single port store
+        using EnablePins = hal::PinGroup<PIN_PMC_VCC_EN, PIN_CHG_EN>;
+
+        // Indicator pin filtering
+        static constexpr uint32_t INDICATOR_DEBOUNCE_MS = 20;
+        static constexpr uint32_t CHARGE_INDICATOR_PULSE_WINDOW_MS = 1500; // Longer than the blink period of a charger fault
+
+        // GPIOTE interrupt handlers, the edges are handed to the edge filter
         static void StaticReadBatteryChargerPresentIndicator();
         static void StaticReadBatteryChargeIndicator();
         static void StaticReadBatteryFastChargeIndicator();
 
+        /// Called from the timer task with the filtered state of an indicator pin.
+        ///
+        /// @param channel Edge filter channel of the pin
+        /// @param state Decoded pin state
+        static void StaticIndicatorChanged(uint8_t channel, EdgeFilter::PinState_e state);
+
         uint32_t mVccEnablePin = PIN_PMC_VCC_EN;
         uint32_t mChgEnablePin = PIN_CHG_EN;
         uint32_t mChrPwrPresentIndicatorPin = PIN_CHG_PPR;
@@ -90,6 +113,10 @@ namespace svc
         uint32_t mChgFastChargeIndicatorPin = PIN_CHG_FAST;
         uint32_t mChrCurrentSettingsPin = PIN_CHG_ISET;
 
+        uint8_t mChrPwrPresentIndicatorChannel = EdgeFilter::INVALID_CHANNEL;
+        uint8_t mChgChargeIndicatorChannel = EdgeFilter::INVALID_CHANNEL;
+        uint8_t mChgFastChargeIndicatorChannel = EdgeFilter::INVALID_CHANNEL;
+
         hal::Battery BatteryHalInstance;
     };
 }
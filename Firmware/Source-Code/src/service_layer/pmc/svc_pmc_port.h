@@ -36,6 +36,9 @@ namespace svc
             PMC_READ_CHARGER_PRESENT_INDICATOR = 0x0B,
             PMC_READ_ISET = 0x0C,
             PMC_FAULT_CONDITION = 0x0D,
+            PMC_BATTERY_LOW = 0x0E,
+            PMC_BATTERY_CRITICAL = 0x0F,
+            PMC_BATTERY_NORMAL = 0x10,
         };
 
         PmcPort();
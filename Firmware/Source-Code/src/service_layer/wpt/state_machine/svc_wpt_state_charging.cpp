@@ -74,6 +74,23 @@ namespace svc
         {
             /** @TODO: Handle the WPT fault conditions */
             LOG_DEBUG("WPT State Machine SlowCharge state: WPT Fault Condition\n");
+            if (optDataAddress != static_cast<uint32_t>(hal::LimitFault_e::NONE))
+            {
+                LOG_ERROR("WPT State Machine: Hardware limit tripped, fault %d\n", optDataAddress);
+            }
+            WptPort::SendEvent(WptPort::Event_e::WPT_POWER_OFF, NULL);
+            break;
+        }
+        case WptPort::Event_e::WPT_LINK_FAULT:
+        {
+            LOG_ERROR("WPT State Machine: Link fault, %s\n",
+                      WptLinkMonitor::GetStateName(static_cast<WptLinkState_e>(optDataAddress)));
+            WptPort::SendEvent(WptPort::Event_e::WPT_POWER_OFF, NULL);
+            break;
+        }
+        case WptPort::Event_e::WPT_POWER_BUDGET_EXHAUSTED:
+        {
+            LOG_ERROR("WPT State Machine: Charger battery exhausted at power cap %d\n", optDataAddress);
             WptPort::SendEvent(WptPort::Event_e::WPT_POWER_OFF, NULL);
             break;
         }
@@ -100,6 +117,18 @@ namespace svc
             mWptManager.AdjustWptPowerTransfer(static_cast<uint8_t>(optDataAddress));
             break;
         }
+        case WptPort::Event_e::WPT_STAT_ASSERTED:
+        {
+            LOG_DEBUG("WPT State Machine: WPT Stat Asserted\n");
+            mWptManager.ProcessStatTransition(0, optDataAddress);
+            break;
+        }
+        case WptPort::Event_e::WPT_STAT_RELEASED:
+        {
+            LOG_DEBUG("WPT State Machine: WPT Stat Released\n");
+            mWptManager.ProcessStatTransition(1, optDataAddress);
+            break;
+        }
         default:
         {
             break;
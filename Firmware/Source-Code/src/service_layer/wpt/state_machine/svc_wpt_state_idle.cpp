@@ -11,6 +11,7 @@
 #include "eda_manager_log_config.h"
 #include "svc_wpt_state_machine.h"
 #include "svc_wpt_port.h"
+#include "svc_wpt_sweep.h"
 
 namespace svc
 {
@@ -60,6 +61,19 @@ namespace svc
             stateMachine->ChangeState(states->pStateSlowCharge);
             break;
         }
+        case WptPort::Event_e::WPT_START_SWEEP:
+        {
+            LOG_DEBUG("WPT State Machine: Start Sweep\n");
+            WptSweep::Instance().Configure(optDataAddress);
+            stateMachine->ChangeState(states->pStateTest);
+            break;
+        }
+        case WptPort::Event_e::WPT_STAT_ASSERTED:
+        case WptPort::Event_e::WPT_STAT_RELEASED:
+        {
+            LOG_DEBUG("WPT State Machine: WPT Stat changed while not charging\n");
+            break;
+        }
         default:
         {
             break;
@@ -79,9 +79,38 @@ namespace svc
         {
             /** @TODO: Handle the WPT fault conditions */
             LOG_DEBUG("WPT State Machine SlowCharge state: WPT Fault Condition\n");
+            if (optDataAddress != static_cast<uint32_t>(hal::LimitFault_e::NONE))
+            {
+                LOG_ERROR("WPT State Machine: Hardware limit tripped, fault %d\n", optDataAddress);
+            }
             WptPort::SendEvent(WptPort::Event_e::WPT_POWER_OFF, NULL);
             break;
         }
+        case WptPort::Event_e::WPT_LINK_FAULT:
+        {
+            LOG_ERROR("WPT State Machine SlowCharge state: Link fault, %s\n",
+                      WptLinkMonitor::GetStateName(static_cast<WptLinkState_e>(optDataAddress)));
+            WptPort::SendEvent(WptPort::Event_e::WPT_POWER_OFF, NULL);
+            break;
+        }
+        case WptPort::Event_e::WPT_POWER_BUDGET_EXHAUSTED:
+        {
+            LOG_ERROR("WPT State Machine SlowCharge state: Charger battery exhausted at power cap %d\n", optDataAddress);
+            WptPort::SendEvent(WptPort::Event_e::WPT_POWER_OFF, NULL);
+            break;
+        }
+        case WptPort::Event_e::WPT_STAT_ASSERTED:
+        {
+            LOG_DEBUG("WPT State Machine SlowCharge state: WPT Stat Asserted\n");
+            mWptManager.ProcessStatTransition(0, optDataAddress);
+            break;
+        }
+        case WptPort::Event_e::WPT_STAT_RELEASED:
+        {
+            LOG_DEBUG("WPT State Machine SlowCharge state: WPT Stat Released\n");
+            mWptManager.ProcessStatTransition(1, optDataAddress);
+            break;
+        }
         default:
         {
             //ASSERT(false);
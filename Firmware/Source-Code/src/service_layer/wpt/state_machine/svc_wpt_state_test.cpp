@@ -24,6 +24,10 @@ namespace svc
     void StateTest::Entry()
     {
         LOG_DEBUG("WPT State Machine: Test Entry\n");
+        mWptManager.EnableWpt();
+        // The sweep runs for many dwell times, the receiver may never load the coil meanwhile
+        mWptManager.StopStatusTimeoutTimer();
+        mWptSweep.Start();
     }
 
     void StateTest::DispatchEvent(uint32_t eventId, uint32_t optDataAddress)
@@ -64,11 +68,37 @@ namespace svc
         case WptPort::Event_e::WPT_POWER_OFF:
         {
             LOG_DEBUG("WPT State Machine: WPT Power Off\n");
+            mWptSweep.Abort();
+            mWptManager.DisableWpt();
+            stateMachine->ChangeState(states->pStateIdle);
             break;
         }
         case WptPort::Event_e::WPT_FAULT_CONDITION:
         {
             LOG_DEBUG("WPT State Machine: WPT Fault Condition\n");
+            WptPort::SendEvent(WptPort::Event_e::WPT_POWER_OFF, NULL);
+            break;
+        }
+        case WptPort::Event_e::WPT_SCAN_TIMEOUT:
+        {
+            LOG_DEBUG("WPT State Machine: WPT Scan Timeout\n");
+            WptPort::SendEvent(WptPort::Event_e::WPT_POWER_OFF, NULL);
+            break;
+        }
+        case WptPort::Event_e::WPT_SWEEP_STEP:
+        {
+            LOG_DEBUG("WPT State Machine: WPT Sweep Step\n");
+            if (mWptSweep.Step())
+            {
+                // Sweep completed and streamed
+                WptPort::SendEvent(WptPort::Event_e::WPT_POWER_OFF, NULL);
+            }
+            break;
+        }
+        case WptPort::Event_e::WPT_STAT_ASSERTED:
+        case WptPort::Event_e::WPT_STAT_RELEASED:
+        {
+            LOG_DEBUG("WPT State Machine: WPT Stat changed while not charging\n");
             break;
         }
         default:
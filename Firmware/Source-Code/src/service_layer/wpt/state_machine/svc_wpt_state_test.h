@@ -12,10 +12,13 @@
 #include "eda_state_machine.h"
 
 #include "svc_wpt_manager.h"
+#include "svc_wpt_sweep.h"
 
 namespace svc
 {
-    /// This state is used for triggering events with testing purposes
+    /// This state is used for triggering events with testing purposes.
+    /// It runs the power sweep characterization: every pulse width level is held for the
+    /// configured dwell time, recorded, and the table is streamed once the sweep completes.
     class StateTest : public eda::State
     {
     public:
@@ -31,6 +34,9 @@ namespace svc
         void Exit();
 
     private:
+        WptManager &mWptManager = WptManager::Instance();
+
+        WptSweep &mWptSweep = WptSweep::Instance();
     };
 } // namespace svc
 
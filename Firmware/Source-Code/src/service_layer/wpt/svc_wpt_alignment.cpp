@@ -0,0 +1,44 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_wpt_alignment.cpp
+ * @brief WptAlignment class implementation
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "svc_wpt_alignment.h"
+
+namespace svc
+{
+    uint8_t WptAlignment::ComputeScore(const WptAlignmentSample_t &sample)
+    {
+        uint8_t score = 0;
+
+        // RSSI: linear between the far and near limits
+        if (sample.rssi >= RSSI_NEAR_DBM)
+        {
+            score += RSSI_WEIGHT;
+        }
+        else if (sample.rssi > RSSI_FAR_DBM)
+        {
+            score += static_cast<uint8_t>((static_cast<int16_t>(sample.rssi - RSSI_FAR_DBM) * RSSI_WEIGHT) /
+                                          (RSSI_NEAR_DBM - RSSI_FAR_DBM));
+        }
+
+        if (sample.vrectDetected)
+        {
+            score += VRECT_WEIGHT;
+        }
+
+        // PGOOD: the lower the power level it needs, the better the coupling
+        if (sample.pgood)
+        {
+            uint8_t headroom = (sample.powerLevel < sample.maxPowerLevel) ? (sample.maxPowerLevel - sample.powerLevel) : 0;
+
+            score += static_cast<uint8_t>((static_cast<uint16_t>(headroom + 1) * PGOOD_WEIGHT) / (sample.maxPowerLevel + 1));
+        }
+
+        return score;
+    }
+}
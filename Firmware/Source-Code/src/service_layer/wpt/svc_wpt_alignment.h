@@ -0,0 +1,56 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_wpt_alignment.h
+ * @brief WptAlignment class implementation
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SVC_WPT_ALIGNMENT_H
+#define SVC_WPT_ALIGNMENT_H
+
+#include <cstdint>
+
+namespace svc
+{
+    /// Inputs of the alignment score, all taken from a single IPG advertisement
+    struct WptAlignmentSample_t
+    {
+        int8_t rssi;           // RSSI of the advertisement, dBm
+        bool vrectDetected;    // IPG rectifier voltage detected
+        bool pgood;            // IPG VCHG rail power good
+        uint8_t powerLevel;    // Transmitter pulse width step when the advertisement was received
+        uint8_t maxPowerLevel; // Highest pulse width step
+    };
+
+    class WptAlignment
+    {
+    public:
+        static constexpr uint8_t MAX_SCORE = 100;
+
+        /// Computes the coil alignment score of one advertisement.
+        ///
+        /// No averaging is done so the guidance follows the user's hand within one advertisement interval.
+        /// The RSSI gives the coarse distance, VRECT_DET tells the IPG coil picks up the field, and
+        /// PGOOD reached at a low probe level tells the coupling is good enough to charge.
+        ///
+        /// @param sample Measurements of the advertisement
+        /// @return Score from 0 (IPG out of reach) to MAX_SCORE (coils aligned)
+        static uint8_t ComputeScore(const WptAlignmentSample_t &sample);
+
+    private:
+        // RSSI range mapped onto the RSSI part of the score
+        static constexpr int8_t RSSI_FAR_DBM = -90;  // -90 dBm, IPG barely in range (adjust as needed)
+        static constexpr int8_t RSSI_NEAR_DBM = -45; // -45 dBm, charger on the skin above the IPG (adjust as needed)
+
+        // Weight of each input, the sum is MAX_SCORE
+        static constexpr uint8_t RSSI_WEIGHT = 40;
+        static constexpr uint8_t VRECT_WEIGHT = 20;
+        static constexpr uint8_t PGOOD_WEIGHT = 40;
+
+        static_assert(RSSI_WEIGHT + VRECT_WEIGHT + PGOOD_WEIGHT == MAX_SCORE, "Alignment weights must add up to MAX_SCORE");
+    };
+}
+
+#endif // SVC_WPT_ALIGNMENT_H
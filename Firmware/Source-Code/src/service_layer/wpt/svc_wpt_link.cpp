@@ -0,0 +1,126 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_wpt_link.cpp
+ * @brief WptLinkMonitor class implementation
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "svc_wpt_link.h"
+
+#include "eda_manager_log_config.h"
+
+namespace svc
+{
+    WptLinkMonitor::WptLinkMonitor() : mState(WptLinkState_e::SEARCHING),
+                                       mHasBaseline(false),
+                                       mVrectSeen(false),
+                                       mBaselineImonMv(0),
+                                       mBaselineCoilTemperature(0),
+                                       mBaselineTimestampMs(0)
+    {
+    }
+
+    void WptLinkMonitor::Reset()
+    {
+        mState = WptLinkState_e::SEARCHING;
+        mHasBaseline = false;
+        mVrectSeen = false;
+    }
+
+    WptLinkState_e WptLinkMonitor::Update(const WptLinkSample_t &sample)
+    {
+        if (!mHasBaseline)
+        {
+            // The first step of the ramp is the reference for the IMON rise and the coil heating
+            mBaselineImonMv = sample.imonVoltageMv;
+            mBaselineCoilTemperature = sample.coilTemperature;
+            mBaselineTimestampMs = sample.timestampMs;
+            mHasBaseline = true;
+        }
+
+        mVrectSeen |= sample.vrectDetected;
+
+        const int16_t imonRiseMv = sample.imonVoltageMv - mBaselineImonMv;
+        const int32_t coilSlope = GetCoilSlope(sample);
+
+        LOG_DEBUG("WPT Link: level %d imon rise %d mV coil slope %d dC/min vrect %d\n",
+                  sample.powerLevel, imonRiseMv, coilSlope, mVrectSeen);
+
+        if (sample.pgood)
+        {
+            mState = WptLinkState_e::ALIGNED;
+        }
+        else if (coilSlope >= FOREIGN_OBJECT_SLOPE_DECI_C_PER_MIN)
+        {
+            // The coil heats up while the IPG receives nothing useful
+            mState = WptLinkState_e::FOREIGN_OBJECT;
+        }
+        else if (!mVrectSeen && (imonRiseMv >= FOREIGN_OBJECT_IMON_RISE_MV))
+        {
+            // The transmitter draws more power but the IPG rectifier does not see it
+            mState = WptLinkState_e::FOREIGN_OBJECT;
+        }
+        else if (sample.isMaxPowerLevel)
+        {
+            // Whole ramp done without PGOOD, decide from what the ramp showed
+            if (mVrectSeen)
+            {
+                mState = WptLinkState_e::MISALIGNED;
+            }
+            else if (imonRiseMv < NO_RECEIVER_IMON_RISE_MV)
+            {
+                mState = WptLinkState_e::NO_RECEIVER;
+            }
+            else
+            {
+                mState = WptLinkState_e::MISALIGNED;
+            }
+        }
+        else
+        {
+            mState = WptLinkState_e::SEARCHING;
+        }
+
+        return mState;
+    }
+
+    WptLinkState_e WptLinkMonitor::GetState() const
+    {
+        return mState;
+    }
+
+    const char *WptLinkMonitor::GetStateName(WptLinkState_e state)
+    {
+        switch (state)
+        {
+        case WptLinkState_e::SEARCHING:
+            return "searching";
+        case WptLinkState_e::ALIGNED:
+            return "aligned";
+        case WptLinkState_e::MISALIGNED:
+            return "misaligned";
+        case WptLinkState_e::NO_RECEIVER:
+            return "no receiver";
+        case WptLinkState_e::FOREIGN_OBJECT:
+            return "foreign object";
+        default:
+            return "unknown";
+        }
+    }
+
+    int32_t WptLinkMonitor::GetCoilSlope(const WptLinkSample_t &sample) const
+    {
+        const uint32_t elapsedMs = sample.timestampMs - mBaselineTimestampMs;
+
+        if (elapsedMs < SLOPE_MIN_WINDOW_MS)
+        {
+            return 0;
+        }
+
+        const int32_t riseDeciC = (static_cast<int32_t>(sample.coilTemperature) - mBaselineCoilTemperature) * 10;
+
+        return (riseDeciC * 60000) / static_cast<int32_t>(elapsedMs);
+    }
+}
@@ -0,0 +1,90 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_wpt_link.h
+ * @brief WptLinkMonitor class implementation
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SVC_WPT_LINK_H
+#define SVC_WPT_LINK_H
+
+#include <cstdint>
+
+namespace svc
+{
+    /// Classification of the inductive link between the charger coil and the IPG
+    enum class WptLinkState_e : uint8_t
+    {
+        SEARCHING = 0x00,      // Ramp in progress, not enough evidence yet
+        ALIGNED = 0x01,        // IPG reports PGOOD
+        MISALIGNED = 0x02,     // IPG rectifier sees the field but never reaches PGOOD
+        NO_RECEIVER = 0x03,    // Transmitter draw does not change with power, nothing is coupled
+        FOREIGN_OBJECT = 0x04  // Power is absorbed (IMON rise or coil heating) without reaching the IPG
+    };
+
+    /// Measurements taken at one step of the power ramp
+    struct WptLinkSample_t
+    {
+        uint8_t powerLevel;      // Pulse width threshold step
+        bool isMaxPowerLevel;    // True when powerLevel is the highest step
+        bool pgood;              // IPG VCHG rail power good
+        bool vrectDetected;      // IPG rectifier voltage detected
+        int16_t imonVoltageMv;   // Transmitter IMON voltage
+        int16_t coilTemperature; // Charger coil NTC temperature, degrees Celsius
+        uint32_t timestampMs;    // Time of the sample
+    };
+
+    class WptLinkMonitor
+    {
+    public:
+        /// Construct WptLinkMonitor
+        WptLinkMonitor();
+
+        /// Clears the ramp history, to be called when the ramp restarts from the minimum level.
+        void Reset();
+
+        /// Adds the measurements of a ramp step and classifies the link.
+        ///
+        /// @param sample Measurements at the current power level
+        /// @return Link classification after this sample
+        WptLinkState_e Update(const WptLinkSample_t &sample);
+
+        /// Returns the last classification.
+        WptLinkState_e GetState() const;
+
+        /// Returns a printable name of a link state.
+        static const char *GetStateName(WptLinkState_e state);
+
+    private:
+        // IMON rise, relative to the first step of the ramp, above which power is being absorbed
+        static constexpr int16_t FOREIGN_OBJECT_IMON_RISE_MV = 400; // 400 Millivolts (adjust as needed)
+
+        // IMON rise at the highest step below which nothing is coupled to the coil
+        static constexpr int16_t NO_RECEIVER_IMON_RISE_MV = 50; // 50 Millivolts (adjust as needed)
+
+        // Coil heating rate, without PGOOD, that points to a foreign object
+        static constexpr int32_t FOREIGN_OBJECT_SLOPE_DECI_C_PER_MIN = 20; // 2.0 C/min (adjust as needed)
+
+        // Minimum window before the coil temperature slope is trusted, the NTC resolution is 1 C
+        static constexpr uint32_t SLOPE_MIN_WINDOW_MS = 10000; // 10000 Milliseconds
+
+        /// Returns the coil heating rate since the first sample, in 0.1 C per minute.
+        int32_t GetCoilSlope(const WptLinkSample_t &sample) const;
+
+        WptLinkState_e mState;
+
+        bool mHasBaseline;
+
+        bool mVrectSeen;
+
+        int16_t mBaselineImonMv;
+
+        int16_t mBaselineCoilTemperature;
+
+        uint32_t mBaselineTimestampMs;
+    };
+}
+
+#endif // SVC_WPT_LINK_H
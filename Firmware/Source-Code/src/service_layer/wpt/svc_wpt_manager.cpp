@@ -13,12 +13,29 @@
 #include "eda_manager_log_config.h"
 #include "hal_dac.h"
 #include "svc_ble_subsystem.h"
+#include "svc_wpt_power_budget.h"
+#include "svc_wpt_session.h"
 #include "svc_wpt_subsystem.h"
 
+#include "task.h"
+
 namespace svc
 {
+    // A scan profile must not leave the implant unheard long enough to trip the stale temperature fallback,
+    // and the scan timeout must leave that fallback time to hold the power down before the session ends
+    static_assert(BleManager::GetMaxAdvertisementGapMs(ScanProfile_e::DISCOVERY) < IPG_TEMPERATURE_DATA_MAX_AGE_MS, "DISCOVERY scan too sparse");
+    static_assert(BleManager::GetMaxAdvertisementGapMs(ScanProfile_e::MODERATE) < IPG_TEMPERATURE_DATA_MAX_AGE_MS, "MODERATE scan too sparse");
+    static_assert(BleManager::GetMaxAdvertisementGapMs(ScanProfile_e::KEEP_ALIVE) < IPG_TEMPERATURE_DATA_MAX_AGE_MS, "KEEP_ALIVE scan too sparse");
+    static_assert(SCAN_TIMEOUT_MS >= IPG_TEMPERATURE_DATA_MAX_AGE_MS, "Scan timeout shorter than the stale temperature age");
+
     bool WptManager::m_is_high_temperature_threshold_exceeded = false;
 
+    bool WptManager::m_is_ipg_temperature_stale = false;
+
+    uint8_t WptManager::m_fault_flags = 0;
+
+    uint8_t WptManager::m_power_cap = 0;
+
     uint8_t static m_max_power_level;
 
     WptManager::PgoodState WptManager::pgood_st_machine_current_state;
@@ -28,6 +45,9 @@ namespace svc
     uint8_t WptManager::pgood_st_machine_stability_counter;
     uint8_t WptManager::pgood_st_machine_fine_tune_attempts;
     bool WptManager::pgood_st_machine_last_pgood_status;
+    uint8_t WptManager::pgood_st_machine_misaligned_ramps;
+
+    WptLinkMonitor WptManager::mLinkMonitor;
 
     WptManager &WptManager::Instance()
     {
@@ -39,8 +59,6 @@ namespace svc
     {
     }
 
-    eda::Timer WptManager::mStatusTimer("WptStatusTimer", 500, 1, StatusMonitoring);
-
     eda::Timer WptManager::mStatusTimeoutTimer("WptStatusTimeoutTimer", 5000, 0, StatusTimeoutMonitoring);
 
     eda::Timer WptManager::mTempPgoodTimer("WptStatusTempPgood", TEMP_PGODD_MONITOR_PERIOD_MS, 1, StatusTempPgoodMonitoring);
@@ -73,6 +91,10 @@ namespace svc
         hal::Gpio::ConfigurePin(gpioWptEnConfig);
         hal::Gpio::Write(PIN_WPT_EN, 1);
 
+        // From here on the enable pin is driven through GPIOTE tasks so that the hardware
+        // limits can de-assert it without CPU intervention
+        WptHalInstance.ConfigureEnablePin();
+
         // The following code is commented out because the CTD pin is not implemented in the prototype
 
         // Configure WPT CTD Pin
@@ -97,20 +119,30 @@ namespace svc
             .sense = hal::Gpio::gpio_pin_sense_t::NRF_GPIO_PIN_NOSENSE};
 
         hal::Gpio::ConfigurePin(gpioStatConfig);
+
+        // STAT edges are reported by GPIOTE instead of being polled
+        hal::Wpt_LTC4125::EnableStatInterrupt(StatChanged);
     }
 
     void WptManager::EnableWpt()
     {
+        // Arm the coil protection before any power is transferred
+        m_fault_flags = 0;
+        WptHalInstance.StartHardwareLimits(HardwareLimitTripped);
         WptHalInstance.Enable();
+        mIsWptEnabled = true;
         StartStatusTimeoutTimer();
-        StartStatusMonitoring();
+        WptSession::Instance().Start();
         LOG_DEBUG("WPT Manager: EnableWpt\n");
     }
 
     void WptManager::DisableWpt()
     {
         WptHalInstance.Disable();
-        StopStatusMonitoring();
+        WptHalInstance.StopHardwareLimits();
+        mIsWptEnabled = false;
+        StopStatusTimeoutTimer();
+        WptSession::Instance().Stop();
         ResetPgoodMonitoringStateMachine();
         StopIpgTemperaturePgoodMonitoringTimer();
         LOG_DEBUG("WPT Manager: DisableWpt\n");
@@ -134,12 +166,6 @@ namespace svc
         LOG_DEBUG("WPT Manager: GetTemperature\n");
     }
 
-    void WptManager::GetChargeStatus(uint32_t *status)
-    {
-        *status = hal::Wpt_LTC4125::GetStat();
-        LOG_DEBUG("WPT Manager: GetChargeStatus\n");
-    }
-
     void WptManager::StartStatusTimeoutTimer()
     {
         LOG_DEBUG("WPT Manager: StartStatusTimeoutTimer\n");
@@ -161,23 +187,64 @@ namespace svc
         }
     }
 
-    void WptManager::StartStatusMonitoring()
+    void WptManager::HardwareLimitTripped(const hal::LimitFault_e fault)
     {
-        LOG_DEBUG("WPT Manager: StartStatusMonitoring\n");
-        mStatusTimer.Start();
+        // SAADC interrupt context: the power transfer is already stopped, let the WPT task clean up
+        if (fault == hal::LimitFault_e::COIL_OVER_TEMPERATURE)
+        {
+            m_fault_flags |= static_cast<uint8_t>(WptFault_e::COIL_OVER_TEMPERATURE);
+        }
+        else if (fault == hal::LimitFault_e::OVERCURRENT)
+        {
+            m_fault_flags |= static_cast<uint8_t>(WptFault_e::OVERCURRENT);
+        }
+
+        WptPort::SendEventFromISR(WptPort::Event_e::WPT_FAULT_CONDITION, static_cast<uint32_t>(fault));
     }
 
-    void WptManager::StopStatusMonitoring()
+    uint32_t WptManager::TicksToMs(uint32_t ticks)
     {
-        LOG_DEBUG("WPT Manager: StopStatusMonitoring\n");
-        mStatusTimer.Stop();
+        return static_cast<uint32_t>((static_cast<uint64_t>(ticks) * 1000U) / configTICK_RATE_HZ);
     }
 
-    void WptManager::StatusMonitoring(TimerHandle_t xTimer)
+    void WptManager::StatChanged(const uint8_t level)
     {
-        static uint32_t status = 0;
-        GetChargeStatus(&status);
-        LOG_DEBUG("WPT Manager: Status pin value: %d \n", status);
+        // GPIOTE interrupt context: timestamp the edge and defer the processing to the WPT task
+        uint32_t timestampTicks = static_cast<uint32_t>(xTaskGetTickCountFromISR());
+
+        if (level == 0)
+        {
+            WptPort::SendEventFromISR(WptPort::Event_e::WPT_STAT_ASSERTED, timestampTicks);
+        }
+        else
+        {
+            WptPort::SendEventFromISR(WptPort::Event_e::WPT_STAT_RELEASED, timestampTicks);
+        }
+    }
+
+    void WptManager::ProcessStatTransition(uint8_t level, uint32_t timestampTicks)
+    {
+        uint32_t elapsedMs = TicksToMs(timestampTicks - mLastStatTransitionTicks);
+        mLastStatTransitionTicks = timestampTicks;
+
+        LOG_INFO("WPT Manager: STAT %s at tick %u, previous level lasted %u ms\n",
+                 (level == 0) ? "asserted" : "released", timestampTicks, elapsedMs);
+
+        if (!mIsWptEnabled)
+        {
+            return;
+        }
+
+        if (level == 0)
+        {
+            // Receiver load detected, the disconnection timeout is no longer needed
+            StopStatusTimeoutTimer();
+        }
+        else
+        {
+            // Power transfer dropped, give the receiver the timeout window to come back
+            StartStatusTimeoutTimer();
+        }
     }
 
     void WptManager::StartIpgTemperaturePgoodMonitoringTimer()
@@ -250,7 +317,36 @@ namespace svc
         app::System *pSystem = &app::System::GetInstance();
         WptSubsystem &pWptSubsystem = svc::WptSubsystem::Instance();
 
-        const svc::AdvertisementData_t &advData = svc::BleManager::GetAdvertisementData();
+        svc::AdvertisementData_t advData;
+
+        if (!svc::BleManager::GetFreshAdvertisementData(advData, IPG_TEMPERATURE_DATA_MAX_AGE_MS))
+        {
+            // Without thermal supervision only the minimum power is safe. The ramp starts over once the
+            // implant is heard again, and the scan timeout ends the session if it stays silent.
+            if (!m_is_ipg_temperature_stale)
+            {
+                LOG_WARNING("WPT Manager: No IPG temperature in the last %d ms, power held at minimum level", IPG_TEMPERATURE_DATA_MAX_AGE_MS);
+                m_is_ipg_temperature_stale = true;
+
+                if (pgood_st_machine_current_state == PgoodState::STABLE)
+                {
+                    BlePort::SendEventFromISR(BlePort::Event_e::SET_SCAN_PROFILE, static_cast<uint32_t>(ScanProfile_e::MODERATE));
+                }
+
+                // The PGOOD power control holds the level while the IPG data is stale
+                pgood_st_machine_current_state = PgoodState::INIT;
+                pgood_st_machine_current_power_level = MIN_POWER_LEVEL;
+                SetPowerLevel(MIN_POWER_LEVEL);
+            }
+            return;
+        }
+
+        if (m_is_ipg_temperature_stale)
+        {
+            LOG_INFO("WPT Manager: IPG temperature received again, power ramp resumed");
+            m_is_ipg_temperature_stale = false;
+        }
+
         svc::ChargingStatusParameters_t ChargingStatusParameters = advData.chargingStatusParameters;
 
         float ipg_temperature = CalculateTemperatureFromBle(ChargingStatusParameters.GET_THERM_REF, ChargingStatusParameters.GET_THERM_OUT, ChargingStatusParameters.GET_THERM_OFST);
@@ -316,6 +412,55 @@ namespace svc
         WptHalInstance.SetPulseWidthThresholdStep(step);
     }
 
+    uint8_t WptManager::GetMaxPowerLevel()
+    {
+        return m_max_power_level;
+    }
+
+    uint8_t WptManager::GetPowerLevel()
+    {
+        return pgood_st_machine_current_power_level;
+    }
+
+    uint8_t WptManager::GetPowerCap()
+    {
+        return PowerBudget::Instance().GetPowerCap(m_max_power_level);
+    }
+
+    uint8_t WptManager::GetPowerCapFlags()
+    {
+        return PowerBudget::Instance().GetCapFlags();
+    }
+
+    uint8_t WptManager::GetPgoodState()
+    {
+        return static_cast<uint8_t>(pgood_st_machine_current_state);
+    }
+
+    uint8_t WptManager::GetFaultFlags()
+    {
+        uint8_t flags = m_fault_flags;
+
+        if (m_is_high_temperature_threshold_exceeded)
+        {
+            flags |= static_cast<uint8_t>(WptFault_e::IPG_OVER_TEMPERATURE);
+        }
+
+        if (m_is_ipg_temperature_stale)
+        {
+            flags |= static_cast<uint8_t>(WptFault_e::IPG_TEMPERATURE_STALE);
+        }
+
+        return flags;
+    }
+
+    int16_t WptManager::GetIpgTemperature()
+    {
+        const svc::ChargingStatusParameters_t parameters = svc::BleManager::GetAdvertisementData().chargingStatusParameters;
+
+        return static_cast<int16_t>(CalculateTemperatureFromBle(parameters.GET_THERM_REF, parameters.GET_THERM_OUT, parameters.GET_THERM_OFST));
+    }
+
     void WptManager::ResetPgoodMonitoringStateMachine()
     {
         // Reset all state machine variables to their initial values
@@ -326,6 +471,11 @@ namespace svc
         pgood_st_machine_stability_counter = 0;
         pgood_st_machine_fine_tune_attempts = 0;
         pgood_st_machine_last_pgood_status = false;
+        pgood_st_machine_misaligned_ramps = 0;
+        mLinkMonitor.Reset();
+        PowerBudget::Instance().Reset();
+        m_power_cap = m_max_power_level;
+        m_is_ipg_temperature_stale = false;
 
         LOG_INFO("WPT Manager: PGOOD state machine variables initialized");
     }
@@ -346,13 +496,39 @@ namespace svc
         // 5. STABLE: Maintains stable operation while monitoring for changes
 
         // Get current PGOOD status from BLE advertisement data
-        const svc::AdvertisementData_t &advData = svc::BleManager::GetAdvertisementData();
+        svc::AdvertisementData_t advData;
+
+        if (!svc::BleManager::GetFreshAdvertisementData(advData, IPG_PGOOD_DATA_MAX_AGE_MS))
+        {
+            // Acting on an old PGOOD would ramp against a stale picture, hold the power level instead
+            LOG_WARNING("WPT Manager: No IPG status in the last %d ms, power level %d held",
+                        IPG_PGOOD_DATA_MAX_AGE_MS, pgood_st_machine_current_power_level);
+            return;
+        }
+
         svc::ChargingStatusParameters_t ChargingStatusParameters = advData.chargingStatusParameters;
         bool pgood_status = ChargingStatusParameters.GET_VCHG_RAIL_SUPPLY_CIRCUIT_POWER_GOOD;
+        bool vrect_detected = ChargingStatusParameters.GET_VRECT_DET;
+        PgoodState previous_state = pgood_st_machine_current_state;
 
         LOG_INFO("WPT Manager: PGOOD status: %d, State: %d, Power level: %d",
                  pgood_status, static_cast<uint8_t>(pgood_st_machine_current_state), pgood_st_machine_current_power_level);
 
+        // A low charger battery caps the ramp instead of stopping the session
+        const uint8_t power_cap = ApplyPowerCap();
+
+        if (PowerBudget::Instance().IsExhausted())
+        {
+            // Only a battery that sags with the full back-off applied stops the session
+            if ((m_fault_flags & static_cast<uint8_t>(WptFault_e::POWER_BUDGET_EXHAUSTED)) == 0)
+            {
+                LOG_ERROR("WPT Manager: Charger battery cannot carry power level %d, power transfer stopped", pgood_st_machine_current_power_level);
+                m_fault_flags |= static_cast<uint8_t>(WptFault_e::POWER_BUDGET_EXHAUSTED);
+                WptPort::SendEventFromISR(WptPort::Event_e::WPT_POWER_BUDGET_EXHAUSTED, static_cast<uint32_t>(power_cap));
+            }
+            return;
+        }
+
         // State machine implementation
         switch (pgood_st_machine_current_state)
         {
@@ -362,6 +538,7 @@ namespace svc
         //
         // Actions:
         // - Set power to minimum level
+        // - Restart the link classification
         // - Log initialization
         // - Transition to INCREASING_POWER state
         //
@@ -371,6 +548,7 @@ namespace svc
             // Initialize to minimum power
             pgood_st_machine_current_power_level = MIN_POWER_LEVEL;
             SetPowerLevel(pgood_st_machine_current_power_level);
+            mLinkMonitor.Reset();
             LOG_INFO("WPT Manager: Initializing power at minimum level %d", pgood_st_machine_current_power_level);
             pgood_st_machine_current_state = PgoodState::INCREASING_POWER;
             break;
@@ -382,13 +560,21 @@ namespace svc
         // Actions:
         // - If PGOOD=1: Save current power level as stable and move to STABILIZING
         // - If PGOOD=0 and below max power: Increase power by one step
+        // - If PGOOD=0 and at the power cap: Hold the power level
         // - If PGOOD=0 and at max power: Reset to minimum and try again
+        // - If the link classifier finds the ramp hopeless: Abort the power transfer
         //
         // Next States:
         // - STABILIZING: When PGOOD=1 is detected
         // - INIT: When max power is reached without finding PGOOD=1
         // - Remains in INCREASING_POWER: While increasing power and PGOOD=0
         case PgoodState::INCREASING_POWER:
+            if (ClassifyRampStep(pgood_status, vrect_detected))
+            {
+                // WPT_LINK_FAULT sent, the WPT state machine powers off
+                break;
+            }
+
             if (pgood_status)
             {
                 // We found PGOOD=1, now stabilize at this power level
@@ -397,20 +583,26 @@ namespace svc
                 pgood_st_machine_stability_counter = 0;
                 pgood_st_machine_current_state = PgoodState::STABILIZING;
             }
-            else if (pgood_st_machine_current_power_level < m_max_power_level)
+            else if (pgood_st_machine_current_power_level < power_cap)
             {
                 // Increase power by one step since PGOOD is still 0
                 pgood_st_machine_current_power_level++;
                 SetPowerLevel(pgood_st_machine_current_power_level);
                 LOG_INFO("WPT Manager: Increasing power to level %d", pgood_st_machine_current_power_level);
             }
+            else if (power_cap < m_max_power_level)
+            {
+                // The battery limits the power, the ramp waits at the cap for PGOOD or for the cap to rise
+                LOG_DEBUG("WPT Manager: Power level held at the cap %d without PGOOD=1", power_cap);
+            }
             else
             {
                 // We've reached max power but still no PGOOD=1
-                LOG_WARNING("WPT Manager: Reached maximum power level without PGOOD=1");
+                LOG_WARNING("WPT Manager: Reached maximum power level %d of %d without PGOOD=1", power_cap, m_max_power_level);
                 // Reset to minimum and try again
                 pgood_st_machine_current_power_level = MIN_POWER_LEVEL;
                 SetPowerLevel(pgood_st_machine_current_power_level);
+                mLinkMonitor.Reset();
                 LOG_INFO("WPT Manager: Resetting to minimum power level %d", pgood_st_machine_current_power_level);
             }
             break;
@@ -440,7 +632,7 @@ namespace svc
                 if (pgood_st_machine_stability_counter >= STABILITY_THRESHOLD)
                 {
                     // We have stable PGOOD for sufficient cycles
-                    if (pgood_st_machine_current_power_level < m_max_power_level)
+                    if (pgood_st_machine_current_power_level < power_cap)
                     {
                         // Try fine-tuning with a bit more power
                         LOG_INFO("WPT Manager: Stable PGOOD achieved, attempting fine-tuning");
@@ -494,9 +686,9 @@ namespace svc
                         pgood_st_machine_fine_tune_attempts++;
                         pgood_st_machine_current_power_level++;
 
-                        if (pgood_st_machine_current_power_level > m_max_power_level)
+                        if (pgood_st_machine_current_power_level > power_cap)
                         {
-                            pgood_st_machine_current_power_level = m_max_power_level;
+                            pgood_st_machine_current_power_level = power_cap;
                         }
 
                         SetPowerLevel(pgood_st_machine_current_power_level);
@@ -570,10 +762,100 @@ namespace svc
             break;
         }
 
+        // While the transfer is stable the IPG data is only needed for supervision, scan less often
+        if ((previous_state != PgoodState::STABLE) && (pgood_st_machine_current_state == PgoodState::STABLE))
+        {
+            BlePort::SendEventFromISR(BlePort::Event_e::SET_SCAN_PROFILE, static_cast<uint32_t>(ScanProfile_e::KEEP_ALIVE));
+        }
+        else if ((previous_state == PgoodState::STABLE) && (pgood_st_machine_current_state != PgoodState::STABLE))
+        {
+            BlePort::SendEventFromISR(BlePort::Event_e::SET_SCAN_PROFILE, static_cast<uint32_t>(ScanProfile_e::MODERATE));
+        }
+
         // Save current PGOOD status for next iteration
         pgood_st_machine_last_pgood_status = pgood_status;
     }
 
+    bool WptManager::ClassifyRampStep(bool pgood_status, bool vrect_detected)
+    {
+        WptManager &wptManager = Instance();
+
+        // Both readings are blocking and refresh the manager fields
+        wptManager.GetCurrent(nullptr);
+        wptManager.GetTemperature();
+
+        const WptLinkSample_t sample = {
+            .powerLevel = pgood_st_machine_current_power_level,
+            .isMaxPowerLevel = (pgood_st_machine_current_power_level >= m_max_power_level),
+            .pgood = pgood_status,
+            .vrectDetected = vrect_detected,
+            .imonVoltageMv = wptManager.mWptImonVoltage,
+            .coilTemperature = wptManager.mWptNtcTemperature,
+            .timestampMs = TicksToMs(static_cast<uint32_t>(xTaskGetTickCount()))};
+
+        const WptLinkState_e linkState = mLinkMonitor.Update(sample);
+
+        switch (linkState)
+        {
+        case WptLinkState_e::FOREIGN_OBJECT:
+        case WptLinkState_e::NO_RECEIVER:
+            // Raising the power again cannot help and, with a foreign object, only heats it
+            break;
+
+        case WptLinkState_e::MISALIGNED:
+            pgood_st_machine_misaligned_ramps++;
+            LOG_WARNING("WPT Manager: Coil misaligned, ramp %d of %d", pgood_st_machine_misaligned_ramps, MAX_MISALIGNED_RAMPS);
+            if (pgood_st_machine_misaligned_ramps < MAX_MISALIGNED_RAMPS)
+            {
+                // Let the ramp restart, the coil may be repositioned meanwhile
+                return false;
+            }
+            break;
+
+        case WptLinkState_e::ALIGNED:
+            pgood_st_machine_misaligned_ramps = 0;
+            return false;
+
+        default:
+            return false;
+        }
+
+        LOG_ERROR("WPT Manager: Power ramp aborted, link %s at power level %d",
+                  WptLinkMonitor::GetStateName(linkState), pgood_st_machine_current_power_level);
+        m_fault_flags |= static_cast<uint8_t>(WptFault_e::LINK_FAULT);
+        WptPort::SendEventFromISR(WptPort::Event_e::WPT_LINK_FAULT, static_cast<uint32_t>(linkState));
+        return true;
+    }
+
+    uint8_t WptManager::ApplyPowerCap()
+    {
+        // The back-off moves by one level per ramp tick at most, the voltage is sampled faster
+        PowerBudget::Instance().Step();
+
+        const uint8_t power_cap = GetPowerCap();
+
+        if (power_cap != m_power_cap)
+        {
+            LOG_INFO("WPT Manager: Power cap %d of %d, flags 0x%02x", power_cap, m_max_power_level, GetPowerCapFlags());
+            m_power_cap = power_cap;
+        }
+
+        if (pgood_st_machine_stable_power_level > power_cap)
+        {
+            pgood_st_machine_stable_power_level = power_cap;
+        }
+
+        if (pgood_st_machine_current_power_level > power_cap)
+        {
+            // Step down at once, PGOOD then tells whether the capped level is enough
+            LOG_WARNING("WPT Manager: Power level %d above the cap, reduced to %d", pgood_st_machine_current_power_level, power_cap);
+            pgood_st_machine_current_power_level = power_cap;
+            SetPowerLevel(pgood_st_machine_current_power_level);
+        }
+
+        return power_cap;
+    }
+
     void WptManager::SetPowerLevel(uint8_t level)
     {
         // Send event to adjust power level
@@ -10,6 +10,7 @@
 #ifndef SVC_WPT_MANAGER_H
 #define SVC_WPT_MANAGER_H
 
+#include "svc_wpt_link.h"
 #include "svc_wpt_port.h"
 
 #include "hal_gpio.h"
@@ -23,6 +24,21 @@ namespace svc
     // Define the time to wait for temperature and pgood signal
     static constexpr uint32_t TEMP_PGODD_MONITOR_PERIOD_MS = 2000; // 2000 Milliseconds (adjust as needed)
 
+    // Oldest IPG status the monitoring acts on, older data is treated as missing
+    static constexpr uint32_t IPG_PGOOD_DATA_MAX_AGE_MS = 3000;        // About one monitoring period plus one IPG advertisement
+    static constexpr uint32_t IPG_TEMPERATURE_DATA_MAX_AGE_MS = 10000; // Temperature changes slowly
+
+    /// Fault flags returned by WptManager::GetFaultFlags, latched until the next EnableWpt
+    enum class WptFault_e : uint8_t
+    {
+        IPG_OVER_TEMPERATURE = 0x01,  // IPG above its temperature thresholds (not latched)
+        COIL_OVER_TEMPERATURE = 0x02, // Coil NTC hardware limit tripped
+        OVERCURRENT = 0x04,           // IMON hardware limit tripped
+        LINK_FAULT = 0x08,            // Power ramp aborted on a foreign object, missing or misaligned receiver
+        IPG_TEMPERATURE_STALE = 0x10, // No recent IPG temperature, power held at the minimum level (not latched)
+        POWER_BUDGET_EXHAUSTED = 0x20 // Charger battery sagged with the full power cap back-off applied
+    };
+
     class WptManager
     {
     public:
@@ -50,11 +66,11 @@ namespace svc
         ///
         void GetTemperature();
 
-        /// Periodically retrieves the charge status.
-        void StartStatusMonitoring();
-
-        /// Stops the status monitoring.
-        void StopStatusMonitoring();
+        /// Processes a STAT pin transition delivered through the WPT port.
+        ///
+        /// @param level New STAT level (0 = pulled low by the LTC4125)
+        /// @param timestampTicks Tick count captured on the edge
+        void ProcessStatTransition(uint8_t level, uint32_t timestampTicks);
 
         /// Starts the status timeout timer for handling disconnection events.
         void StartStatusTimeoutTimer();
@@ -71,6 +87,27 @@ namespace svc
         /// Set Wpt power Transfer pulse width
         void AdjustWptPowerTransfer(uint8_t step);
 
+        /// Returns the highest pulse width step accepted by AdjustWptPowerTransfer.
+        uint8_t GetMaxPowerLevel();
+
+        /// Returns the pulse width step currently applied by the PGOOD power control.
+        uint8_t GetPowerLevel();
+
+        /// Returns the highest pulse width step the charger battery allows, see PowerBudget.
+        static uint8_t GetPowerCap();
+
+        /// Returns the PowerCapReason_e flags of the power cap.
+        static uint8_t GetPowerCapFlags();
+
+        /// Returns the IPG temperature computed from the last advertisement, in degrees Celsius.
+        static int16_t GetIpgTemperature();
+
+        /// Returns the state of the PGOOD power control, from INIT (0) to STABLE (4).
+        static uint8_t GetPgoodState();
+
+        /// Returns the WptFault_e flags of the current (or last) power transfer.
+        static uint8_t GetFaultFlags();
+
         int16_t mWptImonVoltage;
 
         int16_t mWptNtcVoltage;
@@ -124,17 +161,27 @@ namespace svc
         static constexpr uint8_t STABILITY_THRESHOLD = 10; // Number of consecutive stable readings
         static constexpr uint8_t MAX_FINE_TUNE_STEPS = 2;  // Maximum additional steps for fine tuning
         static constexpr uint8_t MAX_COUNT_TOGGLING = 3;   // Maximum toggle counting after stable PGOOG
+        static constexpr uint8_t MAX_MISALIGNED_RAMPS = 3; // Full ramps without PGOOD before giving up on a misaligned coil
 
         /// Construct WptManager
         WptManager();
 
-        /// Retrieves the status from the Stat pin.
-        static void GetChargeStatus(uint32_t *status);
+        /// Called from the SAADC interrupt when a coil NTC or IMON hardware limit trips.
+        ///
+        /// @param fault Limit that de-asserted the WPT enable pin
+        static void HardwareLimitTripped(const hal::LimitFault_e fault);
+
+        /// Convert a tick count to milliseconds. The tick rate is not a divisor of 1000, so
+        /// portTICK_PERIOD_MS is 0 and cannot be used.
+        ///
+        /// @param ticks Tick count or duration in ticks
+        /// @return Same time in milliseconds
+        static uint32_t TicksToMs(uint32_t ticks);
 
-        /// Callback function for the status timer
+        /// Called from the GPIOTE interrupt when the STAT pin changes.
         ///
-        /// @param xTimer Handle to the timer
-        static void StatusMonitoring(TimerHandle_t xTimer);
+        /// @param level New STAT level
+        static void StatChanged(const uint8_t level);
 
         /// Callback function for the status timeout timer
         ///
@@ -168,13 +215,23 @@ namespace svc
         /// Reset all PGOOD state machine variables to their default values
         static void ResetPgoodMonitoringStateMachine();
 
+        /// Measures the current ramp step and classifies the link.
+        ///
+        /// @param pgood_status PGOOD reported by the IPG
+        /// @param vrect_detected VRECT_DET reported by the IPG
+        /// @return true when the ramp is hopeless and was aborted
+        static bool ClassifyRampStep(bool pgood_status, bool vrect_detected);
+
+        /// Lowers the power levels of the PGOOD power control to the battery power cap.
+        ///
+        /// @return Highest power level the ramp may use
+        static uint8_t ApplyPowerCap();
+
         // Sets the power level for wireless power transmission
         //
         // @param level The power level to set (0 to MAXIMUM)
         static void SetPowerLevel(uint8_t level);
 
-        static eda::Timer mStatusTimer;
-
         static eda::Timer mStatusTimeoutTimer;
 
         static eda::Timer mTempPgoodTimer;
@@ -185,6 +242,13 @@ namespace svc
 
         bool static m_is_high_temperature_threshold_exceeded;
 
+        // Set while the IPG temperature is too old to supervise the charge, the power is held at the minimum
+        static bool m_is_ipg_temperature_stale;
+
+        bool mIsWptEnabled = false;
+
+        uint32_t mLastStatTransitionTicks = 0;
+
         static PgoodState pgood_st_machine_current_state;
         static uint8_t pgood_st_machine_current_power_level;
         static uint8_t pgood_st_machine_stable_power_level;
@@ -192,6 +256,13 @@ namespace svc
         static uint8_t pgood_st_machine_stability_counter;
         static uint8_t pgood_st_machine_fine_tune_attempts;
         static bool pgood_st_machine_last_pgood_status;
+        static uint8_t pgood_st_machine_misaligned_ramps;
+
+        static WptLinkMonitor mLinkMonitor;
+
+        static uint8_t m_fault_flags;
+
+        static uint8_t m_power_cap; // Last cap applied to the ramp, to log its changes
     };
 }
 
@@ -37,7 +37,13 @@ namespace svc
             WPT_BATTERY_CHARGED = 0x0B,
             WPT_SLOW_CHARGE = 0x0C,
             WPT_SCAN_TIMEOUT = 0x0D,
-            WPT_ADJUST_POWER = 0x0E
+            WPT_ADJUST_POWER = 0x0E,
+            WPT_STAT_ASSERTED = 0x0F, // STAT pulled low, optional data is the edge tick count
+            WPT_STAT_RELEASED = 0x10, // STAT released, optional data is the edge tick count
+            WPT_START_SWEEP = 0x11,   // Power sweep characterization, optional data is the dwell time in ms (0 for default)
+            WPT_SWEEP_STEP = 0x12,    // Power sweep dwell time elapsed
+            WPT_LINK_FAULT = 0x13,    // Power ramp aborted, optional data is the WptLinkState_e
+            WPT_POWER_BUDGET_EXHAUSTED = 0x14 // Charger battery cannot carry the transfer, even at the lowest power cap
         };
 
         WptPort();
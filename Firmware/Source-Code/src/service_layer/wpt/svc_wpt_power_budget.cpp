@@ -0,0 +1,164 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_wpt_power_budget.cpp
+ * @brief Transmitter power cap from the charger battery state
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "svc_wpt_power_budget.h"
+
+#include "eda_manager_log_config.h"
+#include "svc_pmc_fuel_gauge.h"
+#include "svc_pmc_manager.h"
+
+namespace svc
+{
+    PowerBudget &PowerBudget::Instance()
+    {
+        static PowerBudget instance;
+        return instance;
+    }
+
+    PowerBudget::PowerBudget() : mSagBackoff(0), mRecoverySamples(0), mIsSagged(false), mSagVoltageMv(0), mIsExhausted(false)
+    {
+    }
+
+    void PowerBudget::Update(int16_t voltageMv)
+    {
+        if (voltageMv <= 0)
+        {
+            return;
+        }
+
+        if (voltageMv < SAG_LIMIT_MV)
+        {
+            mRecoverySamples = 0;
+
+            // The lowest voltage since the last step is kept for the log
+            if (!mIsSagged || (voltageMv < mSagVoltageMv))
+            {
+                mSagVoltageMv = voltageMv;
+            }
+            mIsSagged = true;
+        }
+        else if (voltageMv > SAG_RECOVERY_MV)
+        {
+            if (mRecoverySamples < SAG_RECOVERY_SAMPLES)
+            {
+                mRecoverySamples++;
+            }
+        }
+        else
+        {
+            mRecoverySamples = 0;
+        }
+    }
+
+    void PowerBudget::Step()
+    {
+        if (mIsSagged)
+        {
+            mIsSagged = false;
+
+            if (mSagBackoff < MAX_SAG_BACKOFF)
+            {
+                mSagBackoff++;
+                LOG_WARNING("Power Budget: battery sagged to %d mV, power cap lowered by %d levels\n", mSagVoltageMv, mSagBackoff);
+            }
+            else if (!mIsExhausted)
+            {
+                mIsExhausted = true;
+                LOG_ERROR("Power Budget: battery sagged to %d mV with the power cap lowered by %d levels\n", mSagVoltageMv, mSagBackoff);
+            }
+        }
+        else if ((mSagBackoff > 0) && (mRecoverySamples >= SAG_RECOVERY_SAMPLES))
+        {
+            mRecoverySamples = 0;
+            mSagBackoff--;
+            LOG_INFO("Power Budget: battery recovered, power cap lowered by %d levels\n", mSagBackoff);
+        }
+    }
+
+    bool PowerBudget::IsExhausted() const
+    {
+        return mIsExhausted;
+    }
+
+    void PowerBudget::Reset()
+    {
+        mSagBackoff = 0;
+        mRecoverySamples = 0;
+        mIsSagged = false;
+        mIsExhausted = false;
+    }
+
+    uint8_t PowerBudget::GetPowerCap(uint8_t maxPowerLevel) const
+    {
+        // An external supply feeds the transmitter, the battery is not the limit
+        if (PmcManager::Instance().IsChargerPowerPresent())
+        {
+            return maxPowerLevel;
+        }
+
+        uint8_t cap = static_cast<uint8_t>((static_cast<uint32_t>(maxPowerLevel) * GetSocCapPermille()) / 1000);
+        const uint8_t backoff = mSagBackoff;
+
+        cap = (cap > backoff) ? (cap - backoff) : 0;
+
+        if (cap < MIN_POWER_CAP)
+        {
+            cap = (maxPowerLevel < MIN_POWER_CAP) ? maxPowerLevel : MIN_POWER_CAP;
+        }
+
+        return cap;
+    }
+
+    uint8_t PowerBudget::GetCapFlags() const
+    {
+        uint8_t flags = static_cast<uint8_t>(PowerCapReason_e::NONE);
+
+        if (PmcManager::Instance().IsChargerPowerPresent())
+        {
+            return flags;
+        }
+
+        const uint16_t socPermille = FuelGauge::Instance().GetSocPermille();
+
+        if (socPermille <= BATTERY_CRITICAL_SOC_PERMILLE)
+        {
+            flags |= static_cast<uint8_t>(PowerCapReason_e::BATTERY_CRITICAL);
+        }
+        else if (socPermille < BATTERY_LOW_SOC_PERMILLE)
+        {
+            flags |= static_cast<uint8_t>(PowerCapReason_e::BATTERY_LOW);
+        }
+
+        if (mSagBackoff > 0)
+        {
+            flags |= static_cast<uint8_t>(PowerCapReason_e::VOLTAGE_SAG);
+        }
+
+        return flags;
+    }
+
+    uint16_t PowerBudget::GetSocCapPermille() const
+    {
+        const uint16_t socPermille = FuelGauge::Instance().GetSocPermille();
+
+        if (socPermille >= BATTERY_LOW_SOC_PERMILLE)
+        {
+            return 1000;
+        }
+
+        if (socPermille <= BATTERY_CRITICAL_SOC_PERMILLE)
+        {
+            return CRITICAL_CAP_PERMILLE;
+        }
+
+        return static_cast<uint16_t>(CRITICAL_CAP_PERMILLE +
+                                     (static_cast<uint32_t>(socPermille - BATTERY_CRITICAL_SOC_PERMILLE) * (1000 - CRITICAL_CAP_PERMILLE)) /
+                                         (BATTERY_LOW_SOC_PERMILLE - BATTERY_CRITICAL_SOC_PERMILLE));
+    }
+}
@@ -0,0 +1,89 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_wpt_power_budget.h
+ * @brief Transmitter power cap from the charger battery state
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SVC_WPT_POWER_BUDGET_H
+#define SVC_WPT_POWER_BUDGET_H
+
+#include <cstdint>
+
+namespace svc
+{
+    /// Reasons of the power cap, reported in the telemetry
+    enum class PowerCapReason_e : uint8_t
+    {
+        NONE = 0x00,
+        BATTERY_LOW = 0x01,      // SoC below the low threshold, the cap scales with the SoC
+        BATTERY_CRITICAL = 0x02, // SoC below the critical threshold, cap at its floor
+        VOLTAGE_SAG = 0x04,      // Battery voltage sagged under the transmitter load
+    };
+
+    class PowerBudget
+    {
+    public:
+        /// Returns the power budget instance.
+        static PowerBudget &Instance();
+
+        /// Feeds a battery voltage measured under the transmitter load. The sag is only recorded,
+        /// the cap moves in Step.
+        ///
+        /// @param voltageMv Battery terminal voltage
+        void Update(int16_t voltageMv);
+
+        /// Applies at most one back-off step from the voltages fed since the previous call.
+        /// Called once per power ramp tick, so each step is seen by PGOOD before the next one.
+        void Step();
+
+        /// Returns true once the battery sagged with the full back-off applied, the power transfer must stop.
+        bool IsExhausted() const;
+
+        /// Clears the voltage sag back-off, for a new session.
+        void Reset();
+
+        /// Returns the highest power level the battery allows.
+        ///
+        /// @param maxPowerLevel Highest power level of the transmitter
+        uint8_t GetPowerCap(uint8_t maxPowerLevel) const;
+
+        /// Returns the PowerCapReason_e flags of the current cap.
+        uint8_t GetCapFlags() const;
+
+    private:
+        // Cap against the SoC: full power above the low threshold, then a linear
+        // decrease down to the floor at the critical threshold (adjust as needed)
+        static constexpr uint16_t CRITICAL_CAP_PERMILLE = 400;
+
+        // Voltage sag back-off: one level less each time the battery drops below the limit,
+        // one level back after the voltage held above the recovery level (adjust as needed)
+        static constexpr int16_t SAG_LIMIT_MV = 3450;
+        static constexpr int16_t SAG_RECOVERY_MV = 3600;
+        static constexpr uint8_t SAG_RECOVERY_SAMPLES = 10;
+        static constexpr uint8_t MAX_SAG_BACKOFF = 8;
+
+        // Lowest cap, above the minimum power level so the ramp always has a step to take
+        static constexpr uint8_t MIN_POWER_CAP = 1;
+
+        /// Construct PowerBudget
+        PowerBudget();
+
+        /// Returns the cap from the SoC alone, in permille of the highest power level.
+        uint16_t GetSocCapPermille() const;
+
+        volatile uint8_t mSagBackoff;
+
+        uint8_t mRecoverySamples;
+
+        bool mIsSagged;
+
+        int16_t mSagVoltageMv;
+
+        volatile bool mIsExhausted;
+    };
+}
+
+#endif // SVC_WPT_POWER_BUDGET_H
@@ -0,0 +1,185 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_wpt_session.cpp
+ * @brief WptSession class implementation
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "svc_wpt_session.h"
+
+#include "eda_manager_log_config.h"
+#include "svc_ble_manager.h"
+#include "svc_pmc_fuel_gauge.h"
+#include "svc_pmc_manager.h"
+#include "svc_wpt_power_budget.h"
+#include "svc_wpt_manager.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+namespace svc
+{
+    eda::Timer WptSession::mSampleTimer("WptSessionTimer", WPT_SESSION_SAMPLE_PERIOD_MS, 1, SampleTimerCallback);
+
+    WptSession &WptSession::Instance()
+    {
+        static WptSession instance;
+        return instance;
+    }
+
+    WptSession::WptSession() : mIsRunning(false),
+                               mSampleCount(0),
+                               mTransmittedEnergyUj(0),
+                               mIpgStartVoltageMv(0),
+                               mIpgLastVoltageMv(0),
+                               mIpgStartSampleCount(0)
+    {
+    }
+
+    void WptSession::Start()
+    {
+        LOG_DEBUG("WPT Session: Start\n");
+
+        taskENTER_CRITICAL();
+        mSampleCount = 0;
+        mTransmittedEnergyUj = 0;
+        mIpgStartVoltageMv = 0;
+        mIpgLastVoltageMv = 0;
+        mIpgStartSampleCount = 0;
+        taskEXIT_CRITICAL();
+        mIsRunning = true;
+
+        mSampleTimer.Start();
+    }
+
+    void WptSession::Stop()
+    {
+        if (!mIsRunning)
+        {
+            return;
+        }
+
+        mSampleTimer.Stop();
+        mIsRunning = false;
+
+        WptSessionReport_t report;
+        GetReport(report);
+
+        LOG_INFO("WPT Session: %u s, transmitted %u mJ, delivered %u mJ, efficiency %u.%u %%\n",
+                 report.durationS,
+                 report.transmittedEnergyMj,
+                 report.deliveredEnergyMj,
+                 report.efficiencyPermille / 10,
+                 report.efficiencyPermille % 10);
+
+        FuelGauge::Instance().RecordSession(report.transmittedEnergyMj, report.durationS);
+    }
+
+    bool WptSession::IsRunning() const
+    {
+        return mIsRunning;
+    }
+
+    uint32_t WptSession::GetInputCurrentMa() const
+    {
+        const int32_t imonVoltageMv = WptManager::Instance().mWptImonVoltage;
+
+        return (imonVoltageMv > 0) ? (static_cast<uint32_t>(imonVoltageMv) * IMON_CURRENT_GAIN_MA_PER_V / 1000) : 0;
+    }
+
+    void WptSession::SampleTimerCallback(TimerHandle_t xTimer)
+    {
+        Instance().Sample();
+    }
+
+    void WptSession::Sample()
+    {
+        WptManager &wptManager = WptManager::Instance();
+        PmcManager &pmcManager = PmcManager::Instance();
+
+        // Both readings are blocking and refresh the manager fields
+        wptManager.GetCurrent(nullptr);
+        pmcManager.GetBatteryVoltage();
+
+        const int32_t supplyVoltageMv = (pmcManager.mBatteryVoltage > 0) ? pmcManager.mBatteryVoltage : 0;
+
+        // The battery is measured under the transmitter load, the power budget watches its sag
+        PowerBudget::Instance().Update(pmcManager.mBatteryVoltage);
+
+        // P[mW] = V[mV] * I[mA] / 1000, integrated over the period as mW * ms = uJ
+        const uint32_t currentMa = GetInputCurrentMa();
+        const uint32_t powerMw = static_cast<uint32_t>(supplyVoltageMv) * currentMa / 1000;
+
+        // IPG battery voltage reported in the advertisements, 0 means not received yet
+        const uint32_t ipgVoltageMv = BleManager::GetAdvertisementData().chargingStatusParameters.BATTERY_VOLTAGE_MEASURED;
+
+        // The accumulators change together, GetReport reads them from other tasks
+        taskENTER_CRITICAL();
+        mTransmittedEnergyUj += static_cast<uint64_t>(powerMw) * WPT_SESSION_SAMPLE_PERIOD_MS;
+        mSampleCount++;
+
+        if (ipgVoltageMv != 0)
+        {
+            if (mIpgStartVoltageMv == 0)
+            {
+                mIpgStartVoltageMv = ipgVoltageMv;
+                mIpgStartSampleCount = mSampleCount;
+            }
+            mIpgLastVoltageMv = ipgVoltageMv;
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    void WptSession::GetReport(WptSessionReport_t &report) const
+    {
+        // The 64-bit energy takes two loads, the timer task must not update it in between
+        taskENTER_CRITICAL();
+        const uint32_t sampleCount = mSampleCount;
+        const uint64_t transmittedEnergyUj = mTransmittedEnergyUj;
+        const uint32_t ipgStartVoltageMv = mIpgStartVoltageMv;
+        const uint32_t ipgLastVoltageMv = mIpgLastVoltageMv;
+        const uint32_t ipgStartSampleCount = mIpgStartSampleCount;
+        taskEXIT_CRITICAL();
+
+        const uint32_t durationMs = sampleCount * WPT_SESSION_SAMPLE_PERIOD_MS;
+
+        report.durationS = durationMs / 1000;
+        report.transmittedEnergyMj = static_cast<uint32_t>(transmittedEnergyUj / 1000);
+        report.averagePowerMw = (durationMs != 0) ? static_cast<uint16_t>(transmittedEnergyUj / durationMs) : 0;
+        report.deliveredEnergyMj = 0;
+        report.efficiencyPermille = 0;
+        report.timeToFullS = TIME_TO_FULL_UNKNOWN;
+
+        if ((ipgStartVoltageMv == 0) || (ipgLastVoltageMv <= ipgStartVoltageMv))
+        {
+            // No IPG battery rise observed yet
+            return;
+        }
+
+        const uint32_t riseMv = ipgLastVoltageMv - ipgStartVoltageMv;
+        const uint64_t deliveredEnergyUj = static_cast<uint64_t>(riseMv) * IPG_BATTERY_ENERGY_UJ_PER_MV;
+
+        report.deliveredEnergyMj = static_cast<uint32_t>(deliveredEnergyUj / 1000);
+
+        if (transmittedEnergyUj != 0)
+        {
+            uint64_t efficiency = (deliveredEnergyUj * 1000) / transmittedEnergyUj;
+            report.efficiencyPermille = static_cast<uint16_t>((efficiency > 1000) ? 1000 : efficiency);
+        }
+
+        // Extrapolate the observed rise rate to the full voltage
+        if (ipgLastVoltageMv >= IPG_BATTERY_FULL_MV)
+        {
+            report.timeToFullS = 0;
+        }
+        else
+        {
+            const uint32_t riseDurationS = ((sampleCount - ipgStartSampleCount) * WPT_SESSION_SAMPLE_PERIOD_MS) / 1000;
+            const uint32_t remainingMv = IPG_BATTERY_FULL_MV - ipgLastVoltageMv;
+
+            report.timeToFullS = static_cast<uint32_t>((static_cast<uint64_t>(remainingMv) * riseDurationS) / riseMv);
+        }
+    }
+}
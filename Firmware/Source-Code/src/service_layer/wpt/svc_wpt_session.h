@@ -0,0 +1,97 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_wpt_session.h
+ * @brief WptSession class implementation
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SVC_WPT_SESSION_H
+#define SVC_WPT_SESSION_H
+
+#include "eda_timer.h"
+
+#include <cstdint>
+
+namespace svc
+{
+    // Period used to integrate the transmitter power
+    static constexpr uint32_t WPT_SESSION_SAMPLE_PERIOD_MS = 1000; // 1000 Milliseconds
+
+    /// Summary of the running (or last) charge session
+    struct WptSessionReport_t
+    {
+        uint32_t durationS;           // Time since the session started
+        uint32_t transmittedEnergyMj; // Energy drawn by the transmitter
+        uint32_t deliveredEnergyMj;   // Energy stored in the IPG battery, from its voltage rise
+        uint16_t averagePowerMw;      // Average transmitter power
+        uint16_t efficiencyPermille;  // Delivered / transmitted energy
+        uint32_t timeToFullS;         // Estimated time until the IPG battery is full, TIME_TO_FULL_UNKNOWN if not known
+    };
+
+    class WptSession
+    {
+    public:
+        /// Returns the WPT session instance.
+        static WptSession &Instance();
+
+        /// Starts a new charge session, clearing the previous accumulators.
+        void Start();
+
+        /// Stops the session and logs its summary.
+        void Stop();
+
+        /// Returns true while a session is running.
+        bool IsRunning() const;
+
+        /// Computes the report of the running (or last) session.
+        ///
+        /// @param report Structure filled with the session figures
+        void GetReport(WptSessionReport_t &report) const;
+
+        /// Returns the transmitter input current from the last IMON reading.
+        uint32_t GetInputCurrentMa() const;
+
+        static constexpr uint32_t TIME_TO_FULL_UNKNOWN = UINT32_MAX;
+
+    private:
+        // IMON to transmitter input current conversion: V_IMON = I_IN * R_SENSE * amplifier gain
+        static constexpr uint32_t IMON_SENSE_RESISTOR_MOHM = 50; // 50 mOhm input current sense resistor
+        static constexpr uint32_t IMON_AMPLIFIER_GAIN = 20;      // 20 V/V sense amplifier, 1 V per A
+        static constexpr uint32_t IMON_CURRENT_GAIN_MA_PER_V = 1000000 / (IMON_SENSE_RESISTOR_MOHM * IMON_AMPLIFIER_GAIN);
+
+        // IPG battery model: the stored energy is taken as linear with the cell voltage between empty and full
+        static constexpr uint32_t IPG_BATTERY_CAPACITY_MAH = 100; // 100 mAh Li-ion cell
+        static constexpr uint32_t IPG_BATTERY_NOMINAL_MV = 3700;  // Nominal cell voltage
+        static constexpr uint32_t IPG_BATTERY_EMPTY_MV = 3000;    // Cell voltage considered empty
+        static constexpr uint32_t IPG_BATTERY_FULL_MV = 4100;     // Cell voltage considered full
+
+        // 1 mAh at 1 mV is 3600 uJ, 100 mAh at 3.7 V over 1100 mV gives about 1.2 J per mV
+        static constexpr uint32_t IPG_BATTERY_ENERGY_UJ_PER_MV = static_cast<uint32_t>(
+            (static_cast<uint64_t>(IPG_BATTERY_CAPACITY_MAH) * IPG_BATTERY_NOMINAL_MV * 3600) / (IPG_BATTERY_FULL_MV - IPG_BATTERY_EMPTY_MV));
+
+        /// Construct WptSession
+        WptSession();
+
+        /// Callback function for the sampling timer
+        ///
+        /// @param xTimer Handle to the timer
+        static void SampleTimerCallback(TimerHandle_t xTimer);
+
+        /// Integrates one IMON sample and updates the IPG battery voltage.
+        void Sample();
+
+        static eda::Timer mSampleTimer;
+
+        bool mIsRunning;
+
+        uint32_t mSampleCount;           // Number of integrated samples, i.e. session duration in periods
+        uint64_t mTransmittedEnergyUj;   // Integral of the transmitter power, in uJ (mW * ms)
+        uint32_t mIpgStartVoltageMv;     // First IPG battery voltage seen in this session, 0 if none yet
+        uint32_t mIpgLastVoltageMv;      // Last IPG battery voltage seen in this session
+        uint32_t mIpgStartSampleCount;   // Sample count when mIpgStartVoltageMv was captured
+    };
+}
+
+#endif // SVC_WPT_SESSION_H
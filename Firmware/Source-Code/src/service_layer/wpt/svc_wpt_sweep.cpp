@@ -0,0 +1,154 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_wpt_sweep.cpp
+ * @brief WptSweep class implementation
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "svc_wpt_sweep.h"
+
+#include "eda_manager_log_config.h"
+#include "svc_ble_manager.h"
+#include "svc_wpt_manager.h"
+#include "svc_wpt_port.h"
+
+#include "SEGGER_RTT.h"
+
+namespace svc
+{
+    eda::Timer WptSweep::mDwellTimer("WptSweepTimer", WPT_SWEEP_DEFAULT_DWELL_MS, 0, DwellTimerCallback);
+
+    WptSweep &WptSweep::Instance()
+    {
+        static WptSweep instance;
+        return instance;
+    }
+
+    WptSweep::WptSweep() : mTable(),
+                           mRecordCount(0),
+                           mCurrentLevel(0),
+                           mLastLevel(0),
+                           mDwellMs(WPT_SWEEP_DEFAULT_DWELL_MS),
+                           mIsRunning(false)
+    {
+    }
+
+    void WptSweep::Configure(uint32_t dwellMs)
+    {
+        mDwellMs = (dwellMs != 0) ? dwellMs : WPT_SWEEP_DEFAULT_DWELL_MS;
+    }
+
+    void WptSweep::Start()
+    {
+        WptManager &wptManager = WptManager::Instance();
+
+        mRecordCount = 0;
+        mCurrentLevel = 0;
+        mLastLevel = wptManager.GetMaxPowerLevel();
+
+        if (mLastLevel >= MAX_SWEEP_RECORDS)
+        {
+            mLastLevel = MAX_SWEEP_RECORDS - 1;
+        }
+
+        LOG_INFO("WPT Sweep: Start, levels 0-%d, dwell %d ms\n", mLastLevel, mDwellMs);
+
+        mIsRunning = true;
+
+        wptManager.AdjustWptPowerTransfer(mCurrentLevel);
+        mDwellTimer.Start(mDwellMs);
+    }
+
+    bool WptSweep::Step()
+    {
+        if (!mIsRunning)
+        {
+            return false;
+        }
+
+        Record(mTable[mRecordCount]);
+        mRecordCount++;
+
+        if (mCurrentLevel >= mLastLevel)
+        {
+            mIsRunning = false;
+            Stream();
+            return true;
+        }
+
+        mCurrentLevel++;
+        WptManager::Instance().AdjustWptPowerTransfer(mCurrentLevel);
+        mDwellTimer.Start(mDwellMs);
+
+        return false;
+    }
+
+    void WptSweep::Abort()
+    {
+        if (!mIsRunning)
+        {
+            return;
+        }
+
+        mIsRunning = false;
+        mDwellTimer.Stop();
+        LOG_WARNING("WPT Sweep: Aborted at level %d\n", mCurrentLevel);
+        mRecordCount = 0;
+    }
+
+    bool WptSweep::IsRunning() const
+    {
+        return mIsRunning;
+    }
+
+    void WptSweep::DwellTimerCallback(TimerHandle_t xTimer)
+    {
+        // Measurements are blocking, take them from the WPT task rather than the timer task
+        WptPort::SendEvent(WptPort::Event_e::WPT_SWEEP_STEP, NULL);
+    }
+
+    void WptSweep::Record(WptSweepRecord_t &record)
+    {
+        WptManager &wptManager = WptManager::Instance();
+        const AdvertisementData_t &advData = BleManager::GetAdvertisementData();
+        const ChargingStatusParameters_t &parameters = advData.chargingStatusParameters;
+
+        wptManager.GetCurrent(nullptr);
+        wptManager.GetTemperature();
+
+        record.powerLevel = mCurrentLevel;
+        record.flags = (parameters.GET_VCHG_RAIL_SUPPLY_CIRCUIT_POWER_GOOD ? SWEEP_FLAG_PGOOD : 0) |
+                       (parameters.GET_VRECT_DET ? SWEEP_FLAG_VRECT_DET : 0) |
+                       (parameters.GET_VRECT_OVP ? SWEEP_FLAG_VRECT_OVP : 0);
+        record.rssi = advData.rssi;
+        record.ipgTemperature = static_cast<int8_t>(WptManager::GetIpgTemperature());
+        record.coilTemperature = wptManager.mWptNtcTemperature;
+        record.coilNtcVoltageMv = wptManager.mWptNtcVoltage;
+        record.imonVoltageMv = wptManager.mWptImonVoltage;
+
+        LOG_INFO("WPT Sweep: level %d flags 0x%02x rssi %d imon %d mV\n",
+                 record.powerLevel, record.flags, record.rssi, record.imonVoltageMv);
+    }
+
+    void WptSweep::Stream()
+    {
+        // RTT keeps one byte free in its ring buffer
+        static char rttBuffer[sizeof(WptSweepHeader_t) + sizeof(mTable) + 1];
+
+        const WptSweepHeader_t header = {
+            .magic = {'W', 'P', 'S'},
+            .version = SWEEP_FORMAT_VERSION,
+            .recordCount = mRecordCount,
+            .recordSize = sizeof(WptSweepRecord_t),
+            .dwellMs = static_cast<uint16_t>(mDwellMs)};
+
+        // The whole table fits in the channel buffer, so nothing is dropped if the host is slow
+        SEGGER_RTT_ConfigUpBuffer(RTT_CHANNEL, "WptSweep", rttBuffer, sizeof(rttBuffer), SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+        SEGGER_RTT_Write(RTT_CHANNEL, &header, sizeof(header));
+        SEGGER_RTT_Write(RTT_CHANNEL, mTable, mRecordCount * sizeof(WptSweepRecord_t));
+
+        LOG_INFO("WPT Sweep: %d records streamed on RTT channel %d\n", mRecordCount, RTT_CHANNEL);
+    }
+}
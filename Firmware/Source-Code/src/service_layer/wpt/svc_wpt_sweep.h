@@ -0,0 +1,108 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file svc_wpt_sweep.h
+ * @brief WptSweep class implementation
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SVC_WPT_SWEEP_H
+#define SVC_WPT_SWEEP_H
+
+#include "eda_timer.h"
+
+#include <cstdint>
+
+namespace svc
+{
+    // Default time spent at each power level before recording it
+    static constexpr uint32_t WPT_SWEEP_DEFAULT_DWELL_MS = 2000; // 2000 Milliseconds
+
+    /// One row of the power sweep table, streamed as is (little endian, packed)
+    struct __attribute__((packed)) WptSweepRecord_t
+    {
+        uint8_t powerLevel;         // Pulse width threshold step
+        uint8_t flags;              // IPG receiver status, see SWEEP_FLAG_*
+        int8_t rssi;                // RSSI of the last IPG advertisement, dBm
+        int8_t ipgTemperature;      // IPG temperature, degrees Celsius
+        int16_t coilTemperature;    // Charger coil NTC temperature, degrees Celsius
+        int16_t coilNtcVoltageMv;   // Charger coil NTC voltage
+        int16_t imonVoltageMv;      // Transmitter IMON voltage
+    };
+
+    /// Header sent before the sweep records
+    struct __attribute__((packed)) WptSweepHeader_t
+    {
+        uint8_t magic[3];  // "WPS"
+        uint8_t version;   // Format version, bumped when WptSweepRecord_t changes
+        uint8_t recordCount;
+        uint8_t recordSize;
+        uint16_t dwellMs;
+    };
+
+    class WptSweep
+    {
+    public:
+        static constexpr uint8_t SWEEP_FLAG_PGOOD = 0x01;
+        static constexpr uint8_t SWEEP_FLAG_VRECT_DET = 0x02;
+        static constexpr uint8_t SWEEP_FLAG_VRECT_OVP = 0x04;
+
+        /// Returns the WPT sweep instance.
+        static WptSweep &Instance();
+
+        /// Sets the dwell time used by the next sweep.
+        ///
+        /// @param dwellMs Time spent at each power level, 0 selects the default
+        void Configure(uint32_t dwellMs);
+
+        /// Starts the sweep at the minimum power level. WPT must already be enabled.
+        void Start();
+
+        /// Records the current level and moves to the next one.
+        ///
+        /// @return true when the last level was recorded and the table was streamed
+        bool Step();
+
+        /// Aborts a running sweep, the table recorded so far is discarded.
+        void Abort();
+
+        /// Returns true while the sweep is running.
+        bool IsRunning() const;
+
+    private:
+        static constexpr uint8_t MAX_SWEEP_RECORDS = 16;
+        static constexpr uint8_t SWEEP_FORMAT_VERSION = 1;
+        static constexpr unsigned RTT_CHANNEL = 1; // Channel 0 is used by the log backend
+
+        /// Construct WptSweep
+        WptSweep();
+
+        /// Callback function for the dwell timer
+        ///
+        /// @param xTimer Handle to the timer
+        static void DwellTimerCallback(TimerHandle_t xTimer);
+
+        /// Fills a record for the current power level.
+        void Record(WptSweepRecord_t &record);
+
+        /// Sends the header and the table through the RTT sweep channel.
+        void Stream();
+
+        static eda::Timer mDwellTimer;
+
+        WptSweepRecord_t mTable[MAX_SWEEP_RECORDS];
+
+        uint8_t mRecordCount;
+
+        uint8_t mCurrentLevel;
+
+        uint8_t mLastLevel;
+
+        uint32_t mDwellMs;
+
+        bool mIsRunning;
+    };
+}
+
+#endif // SVC_WPT_SWEEP_H
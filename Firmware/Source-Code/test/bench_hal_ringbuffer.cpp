@@ -0,0 +1,147 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file bench_hal_ringbuffer.cpp
+ * @brief Host benchmark of the ring buffer against the nrf_ringbuf based implementation it replaced
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "hal_ringbuffer.h"
+
+#include "bench_timer.h"
+
+#include "nrf_ringbuf.h"
+
+#include <cstdio>
+
+namespace
+{
+    constexpr uint32_t ITERATIONS = 2000000;
+
+    /// Same layout as hal::Uart::Packet_t
+    struct Packet_t
+    {
+        uint8_t data[250];
+        uint32_t length = 0;
+    };
+
+    /// Previous hal::RingBuffer, byte copies through nrf_ringbuf and a separate item count
+    template <typename Item>
+    class LegacyRingBuffer
+    {
+    public:
+        static constexpr size_t BUFFER_LENGTH = 512;
+        static constexpr size_t MAX_NUMBER_ITEMS = BUFFER_LENGTH / sizeof(Item);
+
+        LegacyRingBuffer()
+        {
+            nrf_ringbuf_init(&mRingBuffer);
+        }
+
+        bool Get(Item &item)
+        {
+            if (mItemCount == 0)
+            {
+                return false;
+            }
+
+            size_t lengthOut = sizeof(Item);
+            ret_code_t errCode = nrf_ringbuf_cpy_get(&mRingBuffer, reinterpret_cast<uint8_t *>(&item), &lengthOut);
+            if (errCode != NRF_SUCCESS || lengthOut != sizeof(Item))
+            {
+                return false;
+            }
+
+            --mItemCount;
+            return true;
+        }
+
+        bool Put(const Item &item)
+        {
+            if (mItemCount >= MAX_NUMBER_ITEMS)
+            {
+                return false;
+            }
+
+            size_t lengthIn = sizeof(Item);
+            ret_code_t errCode = nrf_ringbuf_cpy_put(&mRingBuffer, reinterpret_cast<const uint8_t *>(&item), &lengthIn);
+            if (errCode != NRF_SUCCESS || lengthIn != sizeof(Item))
+            {
+                return false;
+            }
+
+            ++mItemCount;
+            return true;
+        }
+
+    private:
+        uint8_t mBuffer[BUFFER_LENGTH];
+        nrf_ringbuf_cb_t mControlBlock;
+        const nrf_ringbuf_t mRingBuffer = {
+            .p_buffer = mBuffer,
+            .bufsize_mask = BUFFER_LENGTH - 1,
+            .p_cb = &mControlBlock};
+
+        size_t mItemCount = 0;
+    };
+
+    /// Put then get each item, the buffer never holds more than one item
+    template <typename Ring, typename Item>
+    double PutGetNs(Ring &ring, uint32_t &checksum)
+    {
+        Item in = {};
+        Item out = {};
+
+        bench::Timer timer;
+        for (uint32_t i = 0; i < ITERATIONS; i++)
+        {
+            reinterpret_cast<volatile uint8_t *>(&in)[0] = static_cast<uint8_t>(i);
+            ring.Put(in);
+            ring.Get(out);
+            checksum += reinterpret_cast<volatile uint8_t *>(&out)[0];
+        }
+        return timer.ElapsedNs() / ITERATIONS;
+    }
+
+    /// Packet built and read in place, as hal::Uart does with the received frames
+    double ReserveCommitPacketNs(hal::RingBuffer<Packet_t, 4> &ring, uint32_t &checksum)
+    {
+        bench::Timer timer;
+        for (uint32_t i = 0; i < ITERATIONS; i++)
+        {
+            Packet_t *p_slot = ring.Reserve();
+            p_slot->data[0] = static_cast<uint8_t>(i);
+            p_slot->length = 1;
+            ring.Commit();
+
+            const Packet_t *p_packet = ring.Peek();
+            checksum += p_packet->data[0] + p_packet->length;
+            ring.Release();
+        }
+        return timer.ElapsedNs() / ITERATIONS;
+    }
+}
+
+int main()
+{
+    uint32_t checksum = 0;
+
+    static LegacyRingBuffer<uint32_t> legacyWords;
+    static hal::RingBuffer<uint32_t, LegacyRingBuffer<uint32_t>::MAX_NUMBER_ITEMS> words;
+    const double legacyWordNs = PutGetNs<LegacyRingBuffer<uint32_t>, uint32_t>(legacyWords, checksum);
+    const double wordNs = PutGetNs<hal::RingBuffer<uint32_t, LegacyRingBuffer<uint32_t>::MAX_NUMBER_ITEMS>, uint32_t>(words, checksum);
+
+    static LegacyRingBuffer<Packet_t> legacyPackets;
+    static hal::RingBuffer<Packet_t, 4> packets;
+    const double legacyPacketNs = PutGetNs<LegacyRingBuffer<Packet_t>, Packet_t>(legacyPackets, checksum);
+    const double packetNs = PutGetNs<hal::RingBuffer<Packet_t, 4>, Packet_t>(packets, checksum);
+    const double inPlacePacketNs = ReserveCommitPacketNs(packets, checksum);
+
+    std::printf("Ring buffer put + get, uint32_t: nrf_ringbuf %.2f ns, lock-free %.2f ns\n", legacyWordNs, wordNs);
+    std::printf("Ring buffer put + get, %zu byte packet: nrf_ringbuf %.2f ns, lock-free %.2f ns, in place %.2f ns\n",
+                sizeof(Packet_t), legacyPacketNs, packetNs, inPlacePacketNs);
+    std::printf("(checksum %u)\n", checksum);
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file bench_svc_ble_messages.cpp
+ * @brief Host benchmark of the IPG advertisement decoder
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "svc_ble_messages.h"
+
+#include "bench_timer.h"
+
+#include <cstdio>
+
+using svc::ChargingStatusParameters_t;
+using svc::IpgAdvertisementDecoder;
+
+namespace
+{
+    constexpr uint32_t ITERATIONS = 10000000;
+
+    /// Fixed offset parsing, as done before the declarative layout
+    void DecodeFixedOffsets(const uint8_t *p_data, ChargingStatusParameters_t &parameters)
+    {
+        parameters.GET_VRECT_DET = p_data[0];
+        parameters.GET_VRECT_OVP = p_data[1];
+        parameters.GET_VCHG_RAIL_SUPPLY_CIRCUIT_POWER_GOOD = p_data[2];
+        parameters.GET_CHG1_STATUS = p_data[3];
+        parameters.GET_CHG1_OVP_ERR = p_data[4];
+        parameters.GET_CHG2_STATUS = p_data[5];
+        parameters.GET_CHG2_OVP_ERR = p_data[6];
+        parameters.GET_THERM_REF = static_cast<uint16_t>(p_data[7] | (p_data[8] << 8));
+        parameters.GET_THERM_OUT = static_cast<uint16_t>(p_data[9] | (p_data[10] << 8));
+        parameters.GET_THERM_OFST = static_cast<uint16_t>(p_data[11] | (p_data[12] << 8));
+        parameters.BATTERY_VOLTAGE_MEASURED = p_data[13] | (p_data[14] << 8) | (p_data[15] << 16) | (static_cast<uint32_t>(p_data[16]) << 24);
+        parameters.GET_TEST_INFO = p_data[17] | (p_data[18] << 8) | (p_data[19] << 16) | (static_cast<uint32_t>(p_data[20]) << 24);
+    }
+}
+
+int main()
+{
+    static volatile uint8_t payload[IpgAdvertisementDecoder::PAYLOAD_LENGTH];
+    for (uint8_t i = 0; i < sizeof(payload); i++)
+    {
+        payload[i] = i;
+    }
+
+    ChargingStatusParameters_t parameters;
+    uint32_t checksum = 0;
+
+    bench::Timer timer;
+    for (uint32_t i = 0; i < ITERATIONS; i++)
+    {
+        payload[0] = static_cast<uint8_t>(i);
+        IpgAdvertisementDecoder::Decode(const_cast<const uint8_t *>(payload), sizeof(payload), parameters);
+        checksum += parameters.GET_VRECT_DET + parameters.GET_TEST_INFO;
+    }
+    const double decoderNs = timer.ElapsedNs() / ITERATIONS;
+
+    timer.Restart();
+    for (uint32_t i = 0; i < ITERATIONS; i++)
+    {
+        payload[0] = static_cast<uint8_t>(i);
+        DecodeFixedOffsets(const_cast<const uint8_t *>(payload), parameters);
+        checksum += parameters.GET_VRECT_DET + parameters.GET_TEST_INFO;
+    }
+    const double fixedOffsetsNs = timer.ElapsedNs() / ITERATIONS;
+
+    std::printf("IPG advertisement decode: layout decoder %.2f ns, fixed offsets %.2f ns (checksum %u)\n",
+                decoderNs, fixedOffsetsNs, checksum);
+
+    return 0;
+}
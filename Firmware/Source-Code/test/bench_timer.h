@@ -0,0 +1,41 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file bench_timer.h
+ * @brief Wall clock timer for the host benchmarks
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef BENCH_TIMER_H
+#define BENCH_TIMER_H
+
+#include <chrono>
+
+namespace bench
+{
+    class Timer
+    {
+    public:
+        Timer() : mStart(std::chrono::steady_clock::now())
+        {
+        }
+
+        /// Start counting again from now
+        void Restart()
+        {
+            mStart = std::chrono::steady_clock::now();
+        }
+
+        /// Time elapsed since the construction or the last restart, in nanoseconds
+        double ElapsedNs() const
+        {
+            return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - mStart).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point mStart;
+    };
+}
+
+#endif // BENCH_TIMER_H
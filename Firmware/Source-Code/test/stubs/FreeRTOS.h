@@ -0,0 +1,21 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file FreeRTOS.h
+ * @brief Host stub of the FreeRTOS tick definitions, same tick rate as the firmware
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+
+#define configTICK_RATE_HZ 1024
+
+#define pdMS_TO_TICKS(xTimeInMs) ((TickType_t)(((TickType_t)(xTimeInMs) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000))
+
+#endif // INC_FREERTOS_H
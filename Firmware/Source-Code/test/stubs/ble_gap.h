@@ -0,0 +1,27 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file ble_gap.h
+ * @brief Host stub of the SoftDevice GAP definitions, only the address type
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef BLE_GAP_H__
+#define BLE_GAP_H__
+
+#include <stdint.h>
+
+#define BLE_GAP_ADDR_TYPE_PUBLIC 0x00
+#define BLE_GAP_ADDR_TYPE_RANDOM_STATIC 0x01
+
+#define BLE_GAP_ADDR_LEN (6)
+
+typedef struct
+{
+    uint8_t addr_id_peer : 1;
+    uint8_t addr_type : 7;
+    uint8_t addr[BLE_GAP_ADDR_LEN];
+} ble_gap_addr_t;
+
+#endif // BLE_GAP_H__
@@ -0,0 +1,21 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file eda_manager_log_config.h
+ * @brief Host stub of the log configuration, the logs are compiled out
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef LOG_CONFIG_H
+#define LOG_CONFIG_H
+
+#define LOG_ENABLED 0
+
+#define LOG_ERROR(...)
+#define LOG_WARNING(...)
+#define LOG_INFO(...)
+#define LOG_DEBUG(...)
+#define LOG_FLUSH()
+
+#endif // LOG_CONFIG_H
@@ -0,0 +1,15 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file app_util_platform.h
+ * @brief Host stub of the nRF5 SDK platform utilities, the atomics use the compiler builtins
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_UTIL_PLATFORM_H__
+#define APP_UTIL_PLATFORM_H__
+
+#include "sdk_common.h"
+
+#endif // APP_UTIL_PLATFORM_H__
@@ -0,0 +1,17 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file nrf_assert.h
+ * @brief Host stub of the nRF5 SDK assertions
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef NRF_ASSERT_H_
+#define NRF_ASSERT_H_
+
+#include <assert.h>
+
+#define ASSERT(expr) assert(expr)
+
+#endif // NRF_ASSERT_H_
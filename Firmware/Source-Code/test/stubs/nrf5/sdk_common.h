@@ -0,0 +1,23 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file sdk_common.h
+ * @brief Host stub of the nRF5 SDK common header, for the SDK modules built by the benchmarks
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SDK_COMMON_H__
+#define SDK_COMMON_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sdk_errors.h"
+
+#define UNUSED_PARAMETER(X) ((void)(X))
+#define UNUSED_RETURN_VALUE(X) ((void)(X))
+
+#endif // SDK_COMMON_H__
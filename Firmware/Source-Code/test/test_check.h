@@ -0,0 +1,48 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file test_check.h
+ * @brief Minimal checks for the host tests
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <cstdio>
+
+namespace test
+{
+    /// Number of failed checks, the test exits with it
+    inline int &FailureCount()
+    {
+        static int count = 0;
+        return count;
+    }
+}
+
+/// Check a condition, a failure is reported and the test goes on
+#define CHECK(condition)                                                          \
+    do                                                                            \
+    {                                                                             \
+        if (!(condition))                                                         \
+        {                                                                         \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            test::FailureCount()++;                                               \
+        }                                                                         \
+    } while (0)
+
+/// Run a test function and report its name
+#define RUN_TEST(function)                      \
+    do                                          \
+    {                                           \
+        const int failures = test::FailureCount(); \
+        function();                             \
+        std::printf("%s %s\n", (test::FailureCount() == failures) ? "PASS" : "FAIL", #function); \
+    } while (0)
+
+/// Exit code of the test
+#define TEST_RESULT() ((test::FailureCount() == 0) ? 0 : 1)
+
+#endif // TEST_CHECK_H
@@ -0,0 +1,181 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file test_hal_button_gesture.cpp
+ * @brief Host test of the button debounce and gesture recognition
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "hal_button_gesture.h"
+
+#include "test_check.h"
+
+#include <cstddef>
+#include <vector>
+
+using hal::ButtonGesture_e;
+using hal::ButtonGestureRecognizer;
+using hal::ButtonTimings_t;
+
+namespace
+{
+    constexpr uint32_t TICK_RATE_HZ = 1000;    // One tick per millisecond, the traces are in ms
+    constexpr uint32_t FILTER_PERIOD_MS = 10;  // Same as hal::Button::FILTER_PERIOD_MS
+
+    constexpr ButtonTimings_t DEFAULT_TIMINGS = {30, 1500, 300}; // Same as hal::Button::DEFAULT_TIMINGS
+    constexpr ButtonTimings_t DFU_TIMINGS = {30, 5000, 0};       // Same as the DFU button
+
+    /// Level change of the button pin
+    struct Edge_t
+    {
+        uint32_t ms;
+        bool isPressed;
+    };
+
+    /// Gesture given by the recognizer
+    struct Gesture_t
+    {
+        ButtonGesture_e gesture;
+        uint32_t ms;
+    };
+
+    uint32_t gNowMs = 0;
+    std::vector<Gesture_t> gGestures;
+
+    void RecordGesture(ButtonGesture_e gesture)
+    {
+        gGestures.push_back({gesture, gNowMs});
+    }
+
+    /// Plays a trace through the recognizer, the timer is armed by an edge and evaluates every
+    /// FILTER_PERIOD_MS until the recognizer is idle, like hal::Button
+    void Play(const std::vector<Edge_t> &trace, const ButtonTimings_t &timings, uint32_t endMs, bool isPressedAtStart = false)
+    {
+        ButtonGestureRecognizer recognizer(0, RecordGesture, timings, TICK_RATE_HZ);
+        bool isPressed = isPressedAtStart;
+        bool isTimerArmed = false;
+        uint32_t timerExpiryMs = 0;
+        size_t next = 0;
+
+        recognizer.Reset(isPressedAtStart);
+        gGestures.clear();
+
+        for (gNowMs = 0; gNowMs <= endMs; gNowMs++)
+        {
+            for (; (next < trace.size()) && (trace[next].ms == gNowMs); next++)
+            {
+                isPressed = trace[next].isPressed;
+                recognizer.OnEdge(gNowMs);
+
+                if (!isTimerArmed)
+                {
+                    isTimerArmed = true;
+                    timerExpiryMs = gNowMs + FILTER_PERIOD_MS;
+                }
+            }
+
+            if (isTimerArmed && (gNowMs == timerExpiryMs))
+            {
+                const ButtonGestureRecognizer::Debounce_e debounce = recognizer.Debounce(gNowMs);
+                const bool isActive = recognizer.Process(gNowMs, debounce, isPressed) || recognizer.IsEdgePending();
+
+                isTimerArmed = isActive;
+                timerExpiryMs = gNowMs + FILTER_PERIOD_MS;
+            }
+        }
+    }
+
+    // Bounce traces of a tactile switch, edges in ms
+    const std::vector<Edge_t> SHORT_PRESS = {
+        {100, true}, {101, false}, {103, true}, {104, false}, {107, true},
+        {250, false}, {251, true}, {252, false}, {256, true}, {258, false}};
+
+    const std::vector<Edge_t> LONG_PRESS = {
+        {100, true}, {102, false}, {103, true}, {109, false}, {110, true},
+        {2100, false}, {2101, true}, {2103, false}};
+
+    const std::vector<Edge_t> DOUBLE_PRESS = {
+        {100, true}, {101, false}, {104, true},
+        {220, false}, {222, true}, {223, false},
+        {400, true}, {402, false}, {403, true},
+        {520, false}, {521, true}, {524, false}};
+
+    // Glitches shorter than the debounce time, the first one spans an evaluation of the timer
+    const std::vector<Edge_t> GLITCHES = {
+        {100, true}, {112, false}, {500, true}, {501, false}, {502, true}, {505, false}};
+
+    void ShortPressWithBounce()
+    {
+        Play(SHORT_PRESS, DEFAULT_TIMINGS, 2000);
+
+        CHECK(gGestures.size() == 1);
+        CHECK(!gGestures.empty() && (gGestures[0].gesture == ButtonGesture_e::PRESS));
+        // Given once the double press window after the settled release is over
+        CHECK(!gGestures.empty() && (gGestures[0].ms > 258 + DEFAULT_TIMINGS.double_press_ms));
+        CHECK(!gGestures.empty() && (gGestures[0].ms <= 258 + DEFAULT_TIMINGS.debounce_ms + DEFAULT_TIMINGS.double_press_ms + 2 * FILTER_PERIOD_MS));
+    }
+
+    void LongPressThenRelease()
+    {
+        Play(LONG_PRESS, DEFAULT_TIMINGS, 3000);
+
+        CHECK(gGestures.size() == 2);
+        if (gGestures.size() == 2)
+        {
+            CHECK(gGestures[0].gesture == ButtonGesture_e::LONG_PRESS);
+            CHECK(gGestures[1].gesture == ButtonGesture_e::RELEASE);
+            // The hold time runs from the last bounce of the press
+            CHECK(gGestures[0].ms >= 110 + DEFAULT_TIMINGS.long_press_ms);
+            CHECK(gGestures[0].ms <= 110 + DEFAULT_TIMINGS.long_press_ms + 2 * FILTER_PERIOD_MS);
+            CHECK(gGestures[1].ms > 2103);
+        }
+    }
+
+    void DoublePressGivesNoPress()
+    {
+        Play(DOUBLE_PRESS, DEFAULT_TIMINGS, 2000);
+
+        CHECK(gGestures.size() == 1);
+        CHECK(!gGestures.empty() && (gGestures[0].gesture == ButtonGesture_e::DOUBLE_PRESS));
+        CHECK(!gGestures.empty() && (gGestures[0].ms < 520));
+    }
+
+    void GlitchesAreIgnored()
+    {
+        Play(GLITCHES, DEFAULT_TIMINGS, 2000);
+
+        CHECK(gGestures.empty());
+    }
+
+    void PressOnReleaseWithoutDoublePress()
+    {
+        Play(SHORT_PRESS, DFU_TIMINGS, 2000);
+
+        CHECK(gGestures.size() == 1);
+        CHECK(!gGestures.empty() && (gGestures[0].gesture == ButtonGesture_e::PRESS));
+        // No double press window to wait for
+        CHECK(!gGestures.empty() && (gGestures[0].ms <= 258 + DFU_TIMINGS.debounce_ms + 2 * FILTER_PERIOD_MS));
+    }
+
+    void HeldAtStartUpGivesNothing()
+    {
+        const std::vector<Edge_t> release = {{300, false}, {301, true}, {303, false}};
+
+        Play(release, DEFAULT_TIMINGS, 2000, true);
+
+        CHECK(gGestures.empty());
+    }
+}
+
+int main()
+{
+    RUN_TEST(ShortPressWithBounce);
+    RUN_TEST(LongPressThenRelease);
+    RUN_TEST(DoublePressGivesNoPress);
+    RUN_TEST(GlitchesAreIgnored);
+    RUN_TEST(PressOnReleaseWithoutDoublePress);
+    RUN_TEST(HeldAtStartUpGivesNothing);
+
+    return TEST_RESULT();
+}
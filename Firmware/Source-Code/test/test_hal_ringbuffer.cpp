@@ -0,0 +1,191 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file test_hal_ringbuffer.cpp
+ * @brief Host test of the single producer, single consumer ring buffer
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "hal_ringbuffer.h"
+
+#include "test_check.h"
+
+#include <thread>
+
+namespace
+{
+    constexpr uint32_t STRESS_ITEMS = 2000000;
+    constexpr size_t PAYLOAD_WORDS = 15; // Item of 64 bytes, several stores per item
+
+    /// Item whose payload is derived from its sequence number, a torn item shows up as a mismatch
+    struct Item_t
+    {
+        uint32_t sequence;
+        uint32_t payload[PAYLOAD_WORDS];
+    };
+
+    using Ring = hal::RingBuffer<Item_t, 8>;
+
+    void Fill(Item_t &item, uint32_t sequence)
+    {
+        item.sequence = sequence;
+        for (size_t i = 0; i < PAYLOAD_WORDS; i++)
+        {
+            item.payload[i] = sequence * 2654435761U + static_cast<uint32_t>(i);
+        }
+    }
+
+    bool IsConsistent(const Item_t &item, uint32_t expectedSequence)
+    {
+        if (item.sequence != expectedSequence)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < PAYLOAD_WORDS; i++)
+        {
+            if (item.payload[i] != expectedSequence * 2654435761U + static_cast<uint32_t>(i))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void EmptyAndFull()
+    {
+        Ring ring;
+        Item_t item;
+
+        CHECK(ring.IsEmpty());
+        CHECK(ring.Peek() == nullptr);
+        CHECK(ring.Get(item) == Ring::ErrorCode_e::EMPTY);
+
+        for (uint32_t i = 0; i < Ring::MAX_NUMBER_ITEMS; i++)
+        {
+            Fill(item, i);
+            CHECK(ring.Put(item) == Ring::ErrorCode_e::SUCCESS);
+        }
+
+        CHECK(ring.IsFull());
+        CHECK(ring.GetItemCount() == Ring::MAX_NUMBER_ITEMS);
+        CHECK(ring.Reserve() == nullptr);
+        CHECK(ring.Put(item) == Ring::ErrorCode_e::FULL);
+
+        for (uint32_t i = 0; i < Ring::MAX_NUMBER_ITEMS; i++)
+        {
+            CHECK(ring.Get(item) == Ring::ErrorCode_e::SUCCESS);
+            CHECK(IsConsistent(item, i));
+        }
+
+        CHECK(ring.IsEmpty());
+    }
+
+    void ReserveIsHiddenUntilCommit()
+    {
+        Ring ring;
+
+        Item_t *p_slot = ring.Reserve();
+        CHECK(p_slot != nullptr);
+        Fill(*p_slot, 7);
+
+        // Reserving again gives the same slot, the consumer does not see it yet
+        CHECK(ring.Reserve() == p_slot);
+        CHECK(ring.Peek() == nullptr);
+
+        ring.Commit();
+
+        const Item_t *p_item = ring.Peek();
+        CHECK((p_item != nullptr) && IsConsistent(*p_item, 7));
+        // Peeking again gives the same item until it is released
+        CHECK(ring.Peek() == p_item);
+
+        ring.Release();
+        CHECK(ring.IsEmpty());
+    }
+
+    /// Producer and consumer on two threads, each side alternates the copying and the in-place calls
+    void ProducerConsumerStress()
+    {
+        static Ring ring;
+        uint32_t errors = 0;
+
+        std::thread producer([]() {
+            for (uint32_t sequence = 0; sequence < STRESS_ITEMS;)
+            {
+                if ((sequence & 1) == 0)
+                {
+                    Item_t item;
+                    Fill(item, sequence);
+                    if (ring.Put(item) == Ring::ErrorCode_e::SUCCESS)
+                    {
+                        sequence++;
+                        continue;
+                    }
+                }
+                else
+                {
+                    Item_t *p_slot = ring.Reserve();
+                    if (p_slot != nullptr)
+                    {
+                        Fill(*p_slot, sequence);
+                        ring.Commit();
+                        sequence++;
+                        continue;
+                    }
+                }
+
+                // Full, let the consumer run on a single core host
+                std::this_thread::yield();
+            }
+        });
+
+        std::thread consumer([&errors]() {
+            for (uint32_t sequence = 0; sequence < STRESS_ITEMS;)
+            {
+                // The count seen by the consumer never exceeds the capacity
+                errors += (ring.GetItemCount() <= Ring::MAX_NUMBER_ITEMS) ? 0 : 1;
+
+                if ((sequence % 3) == 0)
+                {
+                    Item_t item;
+                    if (ring.Get(item) == Ring::ErrorCode_e::SUCCESS)
+                    {
+                        errors += IsConsistent(item, sequence) ? 0 : 1;
+                        sequence++;
+                        continue;
+                    }
+                }
+                else
+                {
+                    const Item_t *p_item = ring.Peek();
+                    if (p_item != nullptr)
+                    {
+                        errors += IsConsistent(*p_item, sequence) ? 0 : 1;
+                        ring.Release();
+                        sequence++;
+                        continue;
+                    }
+                }
+
+                // Empty, let the producer run on a single core host
+                std::this_thread::yield();
+            }
+        });
+
+        producer.join();
+        consumer.join();
+
+        CHECK(errors == 0);
+        CHECK(ring.IsEmpty());
+    }
+}
+
+int main()
+{
+    RUN_TEST(EmptyAndFull);
+    RUN_TEST(ReserveIsHiddenUntilCommit);
+    RUN_TEST(ProducerConsumerStress);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,174 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file test_svc_ble_implant_table.cpp
+ * @brief Host test of the table of the implants in range
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "svc_ble_implant_table.h"
+
+#include "test_check.h"
+
+#include "FreeRTOS.h"
+
+using svc::ImplantTable;
+
+namespace
+{
+    constexpr uint32_t STALE_TICKS = pdMS_TO_TICKS(ImplantTable::IMPLANT_STALE_MS);
+
+    const svc::ChargingStatusParameters_t STATUS = {};
+
+    ble_gap_addr_t Address(uint8_t id)
+    {
+        ble_gap_addr_t address = {};
+        address.addr_type = BLE_GAP_ADDR_TYPE_RANDOM_STATIC;
+        address.addr[0] = id;
+        address.addr[5] = 0xC0;
+        return address;
+    }
+
+    bool IsPresent(const ImplantTable &table, uint8_t id)
+    {
+        int8_t rssi;
+        return table.GetRssiAverage(Address(id), rssi);
+    }
+
+    void InsertAndLookup()
+    {
+        ImplantTable table;
+        int8_t rssi = 0;
+
+        for (uint8_t id = 0; id < ImplantTable::MAX_IMPLANTS; id++)
+        {
+            table.Update(Address(id), STATUS, static_cast<int8_t>(-50 - id), id);
+        }
+
+        for (uint8_t id = 0; id < ImplantTable::MAX_IMPLANTS; id++)
+        {
+            CHECK(table.GetRssiAverage(Address(id), rssi));
+            CHECK(rssi == -50 - id);
+        }
+
+        CHECK(!IsPresent(table, ImplantTable::MAX_IMPLANTS));
+
+        // Same bytes, other address type
+        ble_gap_addr_t publicAddress = Address(0);
+        publicAddress.addr_type = BLE_GAP_ADDR_TYPE_PUBLIC;
+        CHECK(!table.GetRssiAverage(publicAddress, rssi));
+    }
+
+    void ReplaceKeepsOneEntry()
+    {
+        ImplantTable table;
+        int8_t rssi = 0;
+
+        table.Update(Address(1), STATUS, -60, 0);
+        table.Update(Address(1), STATUS, -40, 1);
+
+        // Smoothed with a weight of 1/4 for the new sample
+        CHECK(table.GetRssiAverage(Address(1), rssi));
+        CHECK(rssi == -55);
+
+        // The repeated address used a single entry, the others still fit without eviction
+        for (uint8_t id = 2; id <= ImplantTable::MAX_IMPLANTS; id++)
+        {
+            table.Update(Address(id), STATUS, -70, id);
+        }
+        CHECK(IsPresent(table, 1));
+    }
+
+    void FullTableEvictsLeastRecentlySeen()
+    {
+        ImplantTable table;
+
+        for (uint8_t id = 0; id < ImplantTable::MAX_IMPLANTS; id++)
+        {
+            table.Update(Address(id), STATUS, -60, 10 + id);
+        }
+
+        // Implant 0 is seen again, implant 1 becomes the oldest
+        table.Update(Address(0), STATUS, -60, 20);
+        table.Update(Address(ImplantTable::MAX_IMPLANTS), STATUS, -60, 21);
+
+        CHECK(!IsPresent(table, 1));
+        CHECK(IsPresent(table, 0));
+        for (uint8_t id = 2; id <= ImplantTable::MAX_IMPLANTS; id++)
+        {
+            CHECK(IsPresent(table, id));
+        }
+    }
+
+    void StaleEntriesAreFreed()
+    {
+        ImplantTable table;
+
+        table.Update(Address(1), STATUS, -60, 0);
+        table.Update(Address(2), STATUS, -60, STALE_TICKS);
+        CHECK(IsPresent(table, 1));
+
+        table.Update(Address(2), STATUS, -60, STALE_TICKS + 1);
+        CHECK(!IsPresent(table, 1));
+        CHECK(IsPresent(table, 2));
+    }
+
+    /// Many addresses through the table, the index must follow every insertion and eviction
+    void LookupAfterChurn()
+    {
+        ImplantTable table;
+        uint32_t errors = 0;
+
+        for (uint32_t n = 0; n < 1000; n++)
+        {
+            const uint8_t id = static_cast<uint8_t>(n * 37);
+            table.Update(Address(id), STATUS, -60, n);
+
+            // The last MAX_IMPLANTS addresses are present, the one before was evicted
+            for (uint32_t back = 0; back < ImplantTable::MAX_IMPLANTS && back <= n; back++)
+            {
+                errors += IsPresent(table, static_cast<uint8_t>((n - back) * 37)) ? 0 : 1;
+            }
+            if (n >= ImplantTable::MAX_IMPLANTS)
+            {
+                errors += IsPresent(table, static_cast<uint8_t>((n - ImplantTable::MAX_IMPLANTS) * 37)) ? 1 : 0;
+            }
+        }
+
+        CHECK(errors == 0);
+    }
+
+    void SelectionAndBinding()
+    {
+        ImplantTable table;
+
+        CHECK(table.Update(Address(1), STATUS, -70, 0));
+        // Stronger, but within the hysteresis
+        CHECK(!table.Update(Address(2), STATUS, -70 + ImplantTable::SELECTION_HYSTERESIS_DB - 1, 1));
+        // Clearly stronger
+        CHECK(table.Update(Address(3), STATUS, -40, 2));
+        CHECK(!table.Update(Address(1), STATUS, -70, 3));
+
+        table.Bind(Address(1));
+        CHECK(table.IsBound());
+        CHECK(table.Update(Address(1), STATUS, -70, 4));
+        CHECK(!table.Update(Address(3), STATUS, -40, 5));
+
+        table.Unbind();
+        CHECK(!table.IsBound());
+        CHECK(table.Update(Address(3), STATUS, -40, 6));
+    }
+}
+
+int main()
+{
+    RUN_TEST(InsertAndLookup);
+    RUN_TEST(ReplaceKeepsOneEntry);
+    RUN_TEST(FullTableEvictsLeastRecentlySeen);
+    RUN_TEST(StaleEntriesAreFreed);
+    RUN_TEST(LookupAfterChurn);
+    RUN_TEST(SelectionAndBinding);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,174 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file test_svc_ble_messages.cpp
+ * @brief Host fuzz test of the IPG advertisement decoder
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "svc_ble_messages.h"
+
+#include "test_check.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+using svc::ChargingStatusParameters_t;
+using svc::IpgAdvertisementDecoder;
+
+namespace
+{
+    constexpr uint32_t FUZZ_ITERATIONS = 200000;
+    constexpr uint16_t FUZZ_MAX_LENGTH = 64;
+
+    uint16_t Le16(const uint8_t *p_data)
+    {
+        return static_cast<uint16_t>(p_data[0] | (p_data[1] << 8));
+    }
+
+    uint32_t Le32(const uint8_t *p_data)
+    {
+        return static_cast<uint32_t>(Le16(p_data)) | (static_cast<uint32_t>(Le16(p_data + 2)) << 16);
+    }
+
+    uint32_t Le24(const uint8_t *p_data)
+    {
+        return static_cast<uint32_t>(Le16(p_data)) | (static_cast<uint32_t>(p_data[2]) << 16);
+    }
+
+    /// Field offsets written out by hand, independent of IPG_ADV_LAYOUT
+    bool MatchesLayout(const uint8_t *p_data, const ChargingStatusParameters_t &parameters, bool isLegacy)
+    {
+        const uint32_t testInfo = isLegacy ? Le24(&p_data[17]) : Le32(&p_data[17]);
+
+        return (parameters.GET_VRECT_DET == p_data[0]) &&
+               (parameters.GET_VRECT_OVP == p_data[1]) &&
+               (parameters.GET_VCHG_RAIL_SUPPLY_CIRCUIT_POWER_GOOD == p_data[2]) &&
+               (parameters.GET_CHG1_STATUS == p_data[3]) &&
+               (parameters.GET_CHG1_OVP_ERR == p_data[4]) &&
+               (parameters.GET_CHG2_STATUS == p_data[5]) &&
+               (parameters.GET_CHG2_OVP_ERR == p_data[6]) &&
+               (parameters.GET_THERM_REF == Le16(&p_data[7])) &&
+               (parameters.GET_THERM_OUT == Le16(&p_data[9])) &&
+               (parameters.GET_THERM_OFST == Le16(&p_data[11])) &&
+               (parameters.BATTERY_VOLTAGE_MEASURED == Le32(&p_data[13])) &&
+               (parameters.GET_TEST_INFO == testInfo);
+    }
+
+    /// Decode one payload and check the result against the layout
+    void CheckPayload(const uint8_t *p_data, uint16_t length)
+    {
+        ChargingStatusParameters_t parameters;
+        std::memset(&parameters, 0xA5, sizeof(parameters));
+        ChargingStatusParameters_t untouched = parameters;
+
+        const IpgAdvertisementDecoder::Result_e result = IpgAdvertisementDecoder::Decode(p_data, length, parameters);
+
+        if ((p_data == nullptr) || (length < IpgAdvertisementDecoder::LEGACY_PAYLOAD_LENGTH))
+        {
+            CHECK(result == IpgAdvertisementDecoder::Result_e::TOO_SHORT);
+            CHECK(std::memcmp(&parameters, &untouched, sizeof(parameters)) == 0);
+        }
+        else if (length == IpgAdvertisementDecoder::LEGACY_PAYLOAD_LENGTH)
+        {
+            CHECK(result == IpgAdvertisementDecoder::Result_e::LEGACY);
+            CHECK(MatchesLayout(p_data, parameters, true));
+        }
+        else if (length == IpgAdvertisementDecoder::PAYLOAD_LENGTH)
+        {
+            CHECK(result == IpgAdvertisementDecoder::Result_e::OK);
+            CHECK(MatchesLayout(p_data, parameters, false));
+        }
+        else
+        {
+            CHECK(result == IpgAdvertisementDecoder::Result_e::EXTENDED);
+            CHECK(MatchesLayout(p_data, parameters, false));
+        }
+    }
+
+    void LayoutLength()
+    {
+        CHECK(IpgAdvertisementDecoder::PAYLOAD_LENGTH == 21);
+        CHECK(IpgAdvertisementDecoder::LEGACY_PAYLOAD_LENGTH == 20);
+    }
+
+    void TestInfoKeepsAllBytes()
+    {
+        uint8_t payload[IpgAdvertisementDecoder::PAYLOAD_LENGTH] = {};
+        payload[17] = 0x11;
+        payload[18] = 0x22;
+        payload[19] = 0x33;
+        payload[20] = 0x44;
+
+        ChargingStatusParameters_t parameters = {};
+        CHECK(IpgAdvertisementDecoder::Decode(payload, sizeof(payload), parameters) == IpgAdvertisementDecoder::Result_e::OK);
+        CHECK(parameters.GET_TEST_INFO == 0x44332211U);
+    }
+
+    void LegacyPayload()
+    {
+        // Payload of the first IPG firmware, GET_TEST_INFO on 3 bytes
+        const uint8_t payload[IpgAdvertisementDecoder::LEGACY_PAYLOAD_LENGTH] = {
+            1, 0, 1, 2, 0, 3, 0, 0x34, 0x12, 0x78, 0x56, 0x10, 0x00, 0x68, 0x10, 0x00, 0x00, 0x11, 0x22, 0x33};
+
+        ChargingStatusParameters_t parameters = {};
+        CHECK(IpgAdvertisementDecoder::Decode(payload, sizeof(payload), parameters) == IpgAdvertisementDecoder::Result_e::LEGACY);
+        CHECK(parameters.GET_VRECT_DET == 1);
+        CHECK(parameters.GET_CHG2_STATUS == 3);
+        CHECK(parameters.GET_THERM_REF == 0x1234);
+        CHECK(parameters.GET_THERM_OUT == 0x5678);
+        CHECK(parameters.BATTERY_VOLTAGE_MEASURED == 0x1068);
+        CHECK(parameters.GET_TEST_INFO == 0x332211U);
+    }
+
+    void NullPayload()
+    {
+        CheckPayload(nullptr, 0);
+        CheckPayload(nullptr, IpgAdvertisementDecoder::PAYLOAD_LENGTH);
+    }
+
+    void EveryLength()
+    {
+        for (uint16_t length = 0; length <= FUZZ_MAX_LENGTH; length++)
+        {
+            // Exact size allocation, the sanitizers catch any read past the payload
+            std::vector<uint8_t> payload(length);
+            for (uint16_t i = 0; i < length; i++)
+            {
+                payload[i] = static_cast<uint8_t>(0xF0 ^ i);
+            }
+            CheckPayload(payload.data(), length);
+        }
+    }
+
+    void RandomPayloads()
+    {
+        std::mt19937 generator(0x4950);
+        std::uniform_int_distribution<uint16_t> lengthDistribution(0, FUZZ_MAX_LENGTH);
+        std::uniform_int_distribution<uint16_t> byteDistribution(0, 0xFF);
+
+        for (uint32_t iteration = 0; iteration < FUZZ_ITERATIONS; iteration++)
+        {
+            std::vector<uint8_t> payload(lengthDistribution(generator));
+            for (uint8_t &byte : payload)
+            {
+                byte = static_cast<uint8_t>(byteDistribution(generator));
+            }
+            CheckPayload(payload.data(), static_cast<uint16_t>(payload.size()));
+        }
+    }
+}
+
+int main()
+{
+    RUN_TEST(LayoutLength);
+    RUN_TEST(TestInfoKeepsAllBytes);
+    RUN_TEST(LegacyPayload);
+    RUN_TEST(NullPayload);
+    RUN_TEST(EveryLength);
+    RUN_TEST(RandomPayloads);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,122 @@
+/**
+ * @name Hornet / WPT Charger
+ * @file test_svc_wpt_link.cpp
+ * @brief Host test of the WPT link classification
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "svc_wpt_link.h"
+
+#include "test_check.h"
+
+using svc::WptLinkMonitor;
+using svc::WptLinkSample_t;
+using svc::WptLinkState_e;
+
+namespace
+{
+    constexpr uint32_t RAMP_STEP_MS = 2000; // Period of the PGOOD power control
+    constexpr uint8_t MAX_POWER_LEVEL = 12;
+
+    /// Ramp step without PGOOD nor VRECT and with a flat IMON
+    WptLinkSample_t Step(uint8_t level, int16_t coilTemperature)
+    {
+        WptLinkSample_t sample = {};
+        sample.powerLevel = level;
+        sample.isMaxPowerLevel = (level >= MAX_POWER_LEVEL);
+        sample.imonVoltageMv = 100;
+        sample.coilTemperature = coilTemperature;
+        sample.timestampMs = 5000 + level * RAMP_STEP_MS;
+        return sample;
+    }
+
+    void CoilHeatingIsForeignObject()
+    {
+        WptLinkMonitor monitor;
+        WptLinkState_e state = WptLinkState_e::SEARCHING;
+        uint8_t level = 0;
+
+        // 1 C every 4 s is 15 C/min, far above the threshold
+        for (; (level < MAX_POWER_LEVEL) && (state == WptLinkState_e::SEARCHING); level++)
+        {
+            state = monitor.Update(Step(level, 25 + level / 2));
+        }
+
+        CHECK(state == WptLinkState_e::FOREIGN_OBJECT);
+        // The slope is only trusted once the window is long enough
+        CHECK((level - 1) * RAMP_STEP_MS >= 10000);
+    }
+
+    void ShortWindowIsIgnored()
+    {
+        WptLinkMonitor monitor;
+        WptLinkState_e state = WptLinkState_e::SEARCHING;
+
+        // A 2 C step within the first 8 s can be NTC noise, the slope is not trusted yet
+        for (uint8_t level = 0; level < 5; level++)
+        {
+            state = monitor.Update(Step(level, (level < 2) ? 25 : 27));
+            CHECK(state == WptLinkState_e::SEARCHING);
+        }
+    }
+
+    void SlopeFollowsElapsedTime()
+    {
+        WptLinkMonitor monitor;
+
+        // Same 2 C rise, once over 60 s and once over 10 s
+        WptLinkSample_t sample = Step(0, 25);
+        monitor.Update(sample);
+        sample.coilTemperature = 27;
+        sample.timestampMs += 60000;
+        CHECK(monitor.Update(sample) == WptLinkState_e::FOREIGN_OBJECT);
+
+        monitor.Reset();
+        sample = Step(0, 25);
+        monitor.Update(sample);
+        sample.coilTemperature = 26;
+        sample.timestampMs += 60000;
+        CHECK(monitor.Update(sample) == WptLinkState_e::SEARCHING);
+    }
+
+    void StableCoilWithoutReceiver()
+    {
+        WptLinkMonitor monitor;
+        WptLinkState_e state = WptLinkState_e::SEARCHING;
+
+        for (uint8_t level = 0; level <= MAX_POWER_LEVEL; level++)
+        {
+            state = monitor.Update(Step(level, 25));
+        }
+
+        CHECK(state == WptLinkState_e::NO_RECEIVER);
+    }
+
+    void PgoodWinsOverHeating()
+    {
+        WptLinkMonitor monitor;
+        WptLinkState_e state = WptLinkState_e::SEARCHING;
+
+        for (uint8_t level = 0; level < MAX_POWER_LEVEL; level++)
+        {
+            WptLinkSample_t sample = Step(level, 25 + level);
+            sample.pgood = (level >= 6);
+            state = monitor.Update(sample);
+        }
+
+        CHECK(state == WptLinkState_e::ALIGNED);
+    }
+}
+
+int main()
+{
+    RUN_TEST(CoilHeatingIsForeignObject);
+    RUN_TEST(ShortWindowIsIgnored);
+    RUN_TEST(SlopeFollowsElapsedTime);
+    RUN_TEST(StableCoilWithoutReceiver);
+    RUN_TEST(PgoodWinsOverHeating);
+
+    return TEST_RESULT();
+}